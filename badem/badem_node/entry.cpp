@@ -1,3 +1,4 @@
+#include <badem/ledger_validator.hpp>
 #include <badem/node/node.hpp>
 #include <badem/node/testing.hpp>
 #include <badem/badem_node/daemon.hpp>
@@ -7,6 +8,30 @@
 #include <boost/lexical_cast.hpp>
 #include <boost/program_options.hpp>
 
+namespace
+{
+void print_store_stats (rai::block_store & store_a)
+{
+	MDB_stat environment;
+	auto status (mdb_env_stat (store_a.environment, &environment));
+	assert (status == 0);
+	MDB_envinfo info;
+	status = mdb_env_info (store_a.environment, &info);
+	assert (status == 0);
+	auto used (static_cast<uint64_t> (info.me_last_pgno + 1) * environment.ms_psize);
+	std::cout << boost::str (boost::format ("LMDB page size %1%, %2% pages in use (%3% MB) of a %4% MB map\n") % environment.ms_psize % (info.me_last_pgno + 1) % (used / (1024 * 1024)) % (info.me_mapsize / (1024 * 1024)));
+	rai::transaction transaction (store_a.environment, nullptr, false);
+	std::vector<std::pair<std::string, MDB_dbi>> tables ({ { "accounts", store_a.accounts }, { "send", store_a.send_blocks }, { "receive", store_a.receive_blocks }, { "open", store_a.open_blocks }, { "change", store_a.change_blocks }, { "state", store_a.state_blocks }, { "pending", store_a.pending }, { "blocks_info", store_a.blocks_info }, { "representation", store_a.representation }, { "frontiers", store_a.frontiers }, { "balances", store_a.balances } });
+	for (auto & i : tables)
+	{
+		MDB_stat stats;
+		status = mdb_stat (transaction, i.second, &stats);
+		assert (status == 0);
+		std::cout << boost::str (boost::format ("%1%: %2% entries, depth %3%, %4% branch, %5% leaf and %6% overflow pages\n") % i.first % stats.ms_entries % stats.ms_depth % stats.ms_branch_pages % stats.ms_leaf_pages % stats.ms_overflow_pages);
+	}
+}
+}
+
 int main (int argc, char * const * argv)
 {
 	boost::program_options::options_description description ("Command line options");
@@ -21,6 +46,9 @@ int main (int argc, char * const * argv)
 		("debug_bootstrap_generate", "Generate bootstrap sequence of blocks")
 		("debug_dump_representatives", "List representatives and weights")
 		("debug_account_count", "Display the number of accounts")
+		("debug_validate_ledger", "Check every account chain and table invariant, optionally using <threads> threads")
+		("debug_ledger_generate", "Write a deterministic synthetic ledger of <accounts> accounts with about <length> blocks each to <file>")
+		("debug_profile_replay", "Replay the synthetic ledger in <file> through the ledger in <batch> block transactions, then through the block processor")
 		("debug_mass_activity", "Generates fake debug activity")
 		("debug_profile_generate", "Profile work generation")
 		("debug_opencl", "OpenCL work generation")
@@ -30,7 +58,13 @@ int main (int argc, char * const * argv)
 		("debug_profile_sign", "Profile signature generation")
 		("platform", boost::program_options::value<std::string> (), "Defines the <platform> for OpenCL commands")
 		("device", boost::program_options::value<std::string> (), "Defines <device> for OpenCL command")
-		("threads", boost::program_options::value<std::string> (), "Defines <threads> count for OpenCL command");
+		("threads", boost::program_options::value<std::string> (), "Defines <threads> count for OpenCL and ledger validation commands")
+		("accounts", boost::program_options::value<std::string> (), "Defines the number of <accounts> for debug_ledger_generate, default 1000")
+		("length", boost::program_options::value<std::string> (), "Defines the chain <length> for debug_ledger_generate, default 10")
+		("receive_percent", boost::program_options::value<std::string> (), "Defines the chance an account receives rather than sends for debug_ledger_generate, default 50")
+		("state_percent", boost::program_options::value<std::string> (), "Defines the share of accounts using state blocks for debug_ledger_generate, default 50")
+		("seed", boost::program_options::value<std::string> (), "Defines the random <seed> for debug_ledger_generate, default 0")
+		("batch", boost::program_options::value<std::string> (), "Defines the blocks per write transaction for debug_profile_replay, default 1000");
 	// clang-format on
 
 	boost::program_options::variables_map vm;
@@ -139,6 +173,152 @@ int main (int argc, char * const * argv)
 		rai::transaction transaction (node.node->store.environment, nullptr, false);
 		std::cout << boost::str (boost::format ("Frontier count: %1%\n") % node.node->store.account_count (transaction));
 	}
+	else if (vm.count ("debug_validate_ledger"))
+	{
+		unsigned threads (0);
+		if (vm.count ("threads") == 1)
+		{
+			try
+			{
+				threads = boost::lexical_cast<unsigned> (vm["threads"].as<std::string> ());
+			}
+			catch (boost::bad_lexical_cast & e)
+			{
+				std::cerr << "Invalid threads count\n";
+				result = -1;
+			}
+		}
+		if (!result)
+		{
+			rai::inactive_node node (data_path);
+			rai::ledger_validator validator (node.node->ledger, threads);
+			std::cout << boost::str (boost::format ("Validating ledger with %1% threads, this may take a while...\n") % validator.threads);
+			auto begin (std::chrono::steady_clock::now ());
+			auto error (validator.validate ());
+			auto seconds (std::max (0.001, std::chrono::duration<double> (std::chrono::steady_clock::now () - begin).count ()));
+			for (auto & i : validator.errors)
+			{
+				std::cerr << i << '\n';
+			}
+			std::cout << boost::str (boost::format ("Validated %1% accounts, %2% blocks and %3% pending entries in %4$.1f seconds, %5$.0f blocks/s\n") % validator.accounts % validator.blocks % validator.pending % seconds % (validator.blocks / seconds));
+			std::cout << boost::str (boost::format ("Recomputed checksum: %1%\n") % validator.checksum.to_string ());
+			if (error)
+			{
+				std::cerr << boost::str (boost::format ("Ledger validation found %1% inconsistencies\n") % validator.failures);
+				result = -1;
+			}
+			else
+			{
+				std::cout << "Ledger is consistent\n";
+			}
+		}
+	}
+	else if (vm.count ("debug_ledger_generate") || vm.count ("debug_profile_replay"))
+	{
+		auto option ([&vm, &result](std::string const & name_a, uint64_t default_a) {
+			uint64_t value (default_a);
+			if (vm.count (name_a) == 1)
+			{
+				try
+				{
+					value = boost::lexical_cast<uint64_t> (vm[name_a].as<std::string> ());
+				}
+				catch (boost::bad_lexical_cast & e)
+				{
+					std::cerr << "Invalid " << name_a << '\n';
+					result = -1;
+				}
+			}
+			return value;
+		});
+		if (vm.count ("file") != 1)
+		{
+			std::cerr << "Synthetic ledger commands require one <file> option\n";
+			result = -1;
+		}
+		else if (vm.count ("debug_ledger_generate"))
+		{
+			rai::benchmark_ledger ledger (option ("seed", 0), option ("accounts", 1000), option ("length", 10), option ("receive_percent", 50), option ("state_percent", 50));
+			if (!result)
+			{
+				rai::work_pool work (std::numeric_limits<unsigned>::max (), nullptr);
+				auto begin (std::chrono::steady_clock::now ());
+				if (!ledger.generate (work))
+				{
+					std::ofstream stream (vm["file"].as<std::string> (), std::ios::binary | std::ios::trunc);
+					ledger.serialize (stream);
+					auto seconds (std::chrono::duration<double> (std::chrono::steady_clock::now () - begin).count ());
+					std::cout << boost::str (boost::format ("Generated %1% blocks in %2$.1f seconds\n") % ledger.blocks.size () % seconds);
+				}
+				else
+				{
+					std::cerr << "Synthetic ledgers need a test network build and at least one account, or two when length is above zero\n";
+					result = -1;
+				}
+			}
+		}
+		else
+		{
+			auto batch (std::max<uint64_t> (1, option ("batch", 1000)));
+			rai::benchmark_ledger ledger;
+			std::ifstream stream (vm["file"].as<std::string> (), std::ios::binary);
+			if (!result && !ledger.deserialize (stream))
+			{
+				auto & blocks (ledger.blocks);
+				std::cout << boost::str (boost::format ("Replaying %1% blocks for %2% accounts\n") % blocks.size () % ledger.accounts);
+				auto path1 (rai::unique_path ());
+				{
+					rai::inactive_node node (path1);
+					std::vector<double> durations;
+					uint64_t rejected (0);
+					auto begin (std::chrono::steady_clock::now ());
+					for (size_t i (0); i < blocks.size (); i += batch)
+					{
+						auto start (std::chrono::steady_clock::now ());
+						{
+							rai::transaction transaction (node.node->store.environment, nullptr, true);
+							for (size_t j (i), n (std::min<size_t> (blocks.size (), i + batch)); j < n; ++j)
+							{
+								if (node.node->ledger.process (transaction, *blocks[j]).code != rai::process_result::progress)
+								{
+									++rejected;
+								}
+							}
+						}
+						durations.push_back (std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start).count ());
+					}
+					auto seconds (std::max (0.001, std::chrono::duration<double> (std::chrono::steady_clock::now () - begin).count ()));
+					std::sort (durations.begin (), durations.end ());
+					std::cout << boost::str (boost::format ("ledger::process: %1$.0f blocks/s, %2% rejected\n") % (blocks.size () / seconds) % rejected);
+					if (!durations.empty ())
+					{
+						std::cout << boost::str (boost::format ("Write transactions of %1% blocks: %2% committed, min %3$.2f ms, median %4$.2f ms, 99th percentile %5$.2f ms, max %6$.2f ms\n") % batch % durations.size () % durations.front () % durations[durations.size () / 2] % durations[durations.size () * 99 / 100] % durations.back ());
+					}
+					print_store_stats (node.node->store);
+				}
+				boost::filesystem::remove_all (path1);
+				auto path2 (rai::unique_path ());
+				{
+					rai::inactive_node node (path2);
+					auto begin (std::chrono::steady_clock::now ());
+					// The block processor takes a chain newest first and processes it oldest first
+					node.node->block_processor.add (std::vector<std::shared_ptr<rai::block>> (blocks.rbegin (), blocks.rend ()));
+					node.node->block_processor.flush ();
+					auto seconds (std::max (0.001, std::chrono::duration<double> (std::chrono::steady_clock::now () - begin).count ()));
+					rai::transaction transaction (node.node->store.environment, nullptr, false);
+					// Genesis is already in the ledger
+					auto processed (node.node->store.block_count (transaction).sum () - 1);
+					std::cout << boost::str (boost::format ("block_processor: %1$.0f blocks/s, %2% of %3% blocks in the ledger\n") % (blocks.size () / seconds) % processed % blocks.size ());
+				}
+				boost::filesystem::remove_all (path2);
+			}
+			else
+			{
+				std::cerr << "Unable to read a synthetic ledger for this network from <file>\n";
+				result = -1;
+			}
+		}
+	}
 	else if (vm.count ("debug_mass_activity"))
 	{
 		rai::system system (24000, 1);
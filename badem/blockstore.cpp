@@ -54,6 +54,208 @@ public:
 };
 }
 
+rai::block_view::block_view () :
+type (rai::block_type::invalid),
+value ({ 0, nullptr })
+{
+}
+
+rai::block_view::block_view (rai::block_type type_a, MDB_val const & value_a) :
+type (type_a),
+value (value_a)
+{
+	assert (type == rai::block_type::invalid || value.mv_size == size () + sizeof (rai::block_hash));
+}
+
+rai::uint256_union rai::block_view::read (size_t offset_a) const
+{
+	rai::uint256_union result;
+	assert (offset_a + sizeof (result) <= value.mv_size);
+	std::copy_n (static_cast<uint8_t const *> (value.mv_data) + offset_a, sizeof (result), result.bytes.begin ());
+	return result;
+}
+
+rai::block_hash rai::block_view::previous () const
+{
+	rai::block_hash result (0);
+	switch (type)
+	{
+		case rai::block_type::send:
+		case rai::block_type::receive:
+		case rai::block_type::change:
+			result = read (0);
+			break;
+		case rai::block_type::state:
+			result = read (32);
+			break;
+		default:
+			break;
+	}
+	return result;
+}
+
+rai::block_hash rai::block_view::source () const
+{
+	rai::block_hash result (0);
+	switch (type)
+	{
+		case rai::block_type::receive:
+			result = read (32);
+			break;
+		case rai::block_type::open:
+			result = read (0);
+			break;
+		default:
+			break;
+	}
+	return result;
+}
+
+rai::block_hash rai::block_view::root () const
+{
+	auto result (previous ());
+	if (result.is_zero ())
+	{
+		result = account ();
+	}
+	return result;
+}
+
+rai::account rai::block_view::representative () const
+{
+	rai::account result (0);
+	switch (type)
+	{
+		case rai::block_type::open:
+		case rai::block_type::change:
+			result = read (32);
+			break;
+		case rai::block_type::state:
+			result = read (64);
+			break;
+		default:
+			break;
+	}
+	return result;
+}
+
+rai::account rai::block_view::account () const
+{
+	rai::account result (0);
+	switch (type)
+	{
+		case rai::block_type::open:
+			result = read (64);
+			break;
+		case rai::block_type::state:
+			result = read (0);
+			break;
+		default:
+			break;
+	}
+	return result;
+}
+
+rai::account rai::block_view::destination () const
+{
+	return type == rai::block_type::send ? read (32) : rai::account (0);
+}
+
+rai::amount rai::block_view::balance () const
+{
+	rai::amount result (0);
+	size_t offset (0);
+	switch (type)
+	{
+		case rai::block_type::send:
+			offset = 64;
+			break;
+		case rai::block_type::state:
+			offset = 96;
+			break;
+		default:
+			break;
+	}
+	if (offset != 0)
+	{
+		std::copy_n (static_cast<uint8_t const *> (value.mv_data) + offset, sizeof (result), result.bytes.begin ());
+	}
+	return result;
+}
+
+rai::uint256_union rai::block_view::link () const
+{
+	return type == rai::block_type::state ? read (112) : rai::uint256_union (0);
+}
+
+rai::block_hash rai::block_view::successor () const
+{
+	rai::block_hash result (0);
+	if (type != rai::block_type::invalid)
+	{
+		result = read (value.mv_size - sizeof (result));
+	}
+	return result;
+}
+
+/**
+ * Each block type's hashables are serialized first and in hashing order, so the hash is taken over the stored bytes in place
+ */
+rai::block_hash rai::block_view::hash () const
+{
+	rai::block_hash result;
+	size_t hashables (0);
+	blake2b_state hash_l;
+	auto status (blake2b_init (&hash_l, sizeof (result.bytes)));
+	assert (status == 0);
+	switch (type)
+	{
+		case rai::block_type::send:
+			hashables = sizeof (rai::block_hash) + sizeof (rai::account) + sizeof (rai::amount);
+			break;
+		case rai::block_type::receive:
+			hashables = sizeof (rai::block_hash) + sizeof (rai::block_hash);
+			break;
+		case rai::block_type::open:
+			hashables = sizeof (rai::block_hash) + sizeof (rai::account) + sizeof (rai::account);
+			break;
+		case rai::block_type::change:
+			hashables = sizeof (rai::block_hash) + sizeof (rai::account);
+			break;
+		case rai::block_type::state:
+		{
+			rai::uint256_union preamble (static_cast<uint64_t> (rai::block_type::state));
+			blake2b_update (&hash_l, preamble.bytes.data (), preamble.bytes.size ());
+			hashables = sizeof (rai::account) + sizeof (rai::block_hash) + sizeof (rai::account) + sizeof (rai::amount) + sizeof (rai::uint256_union);
+			break;
+		}
+		default:
+			assert (false);
+			break;
+	}
+	blake2b_update (&hash_l, value.mv_data, hashables);
+	status = blake2b_final (&hash_l, result.bytes.data (), sizeof (result.bytes));
+	assert (status == 0);
+	return result;
+}
+
+size_t rai::block_view::size () const
+{
+	return rai::block_size (type);
+}
+
+std::unique_ptr<rai::block> rai::block_view::block () const
+{
+	std::unique_ptr<rai::block> result;
+	if (type != rai::block_type::invalid)
+	{
+		rai::bufferstream stream (static_cast<uint8_t const *> (value.mv_data), value.mv_size);
+		result = rai::deserialize_block (stream, type);
+		assert (result != nullptr);
+	}
+	return result;
+}
+
 rai::store_entry::store_entry () :
 first (0, nullptr),
 second (0, nullptr)
@@ -239,41 +441,62 @@ rai::store_iterator rai::block_store::vote_end ()
 	return rai::store_iterator (nullptr);
 }
 
+rai::store_counters::store_counters () :
+send (0),
+receive (0),
+open (0),
+change (0),
+state (0),
+accounts (0),
+pending (0),
+unchecked (0)
+{
+}
+
 rai::block_store::block_store (bool & error_a, boost::filesystem::path const & path_a, int lmdb_max_dbs) :
+unchecked_cache_max (unchecked_cache_default),
 environment (error_a, path_a, lmdb_max_dbs),
 frontiers (0),
 accounts (0),
+balances (0),
 send_blocks (0),
 receive_blocks (0),
 open_blocks (0),
 change_blocks (0),
 pending (0),
+pending_totals (0),
 blocks_info (0),
 representation (0),
 unchecked (0),
-checksum (0)
+checksum (0),
+bootstrap_scores (0)
 {
 	if (!error_a)
 	{
 		rai::transaction transaction (environment, nullptr, true);
 		error_a |= mdb_dbi_open (transaction, "frontiers", MDB_CREATE, &frontiers) != 0;
 		error_a |= mdb_dbi_open (transaction, "accounts", MDB_CREATE, &accounts) != 0;
+		error_a |= mdb_dbi_open (transaction, "balances", MDB_CREATE, &balances) != 0;
 		error_a |= mdb_dbi_open (transaction, "send", MDB_CREATE, &send_blocks) != 0;
 		error_a |= mdb_dbi_open (transaction, "receive", MDB_CREATE, &receive_blocks) != 0;
 		error_a |= mdb_dbi_open (transaction, "open", MDB_CREATE, &open_blocks) != 0;
 		error_a |= mdb_dbi_open (transaction, "change", MDB_CREATE, &change_blocks) != 0;
 		error_a |= mdb_dbi_open (transaction, "state", MDB_CREATE, &state_blocks) != 0;
 		error_a |= mdb_dbi_open (transaction, "pending", MDB_CREATE, &pending) != 0;
+		error_a |= mdb_dbi_open (transaction, "pending_totals", MDB_CREATE, &pending_totals) != 0;
 		error_a |= mdb_dbi_open (transaction, "blocks_info", MDB_CREATE, &blocks_info) != 0;
 		error_a |= mdb_dbi_open (transaction, "representation", MDB_CREATE, &representation) != 0;
 		error_a |= mdb_dbi_open (transaction, "unchecked", MDB_CREATE | MDB_DUPSORT, &unchecked) != 0;
 		error_a |= mdb_dbi_open (transaction, "checksum", MDB_CREATE, &checksum) != 0;
+		error_a |= mdb_dbi_open (transaction, "bootstrap_scores", MDB_CREATE, &bootstrap_scores) != 0;
 		error_a |= mdb_dbi_open (transaction, "vote", MDB_CREATE, &vote) != 0;
 		error_a |= mdb_dbi_open (transaction, "meta", MDB_CREATE, &meta) != 0;
 		if (!error_a)
 		{
+			representation_load (transaction);
 			do_upgrades (transaction);
 			checksum_put (transaction, 0, 0, 0);
+			counters_load (transaction);
 		}
 	}
 }
@@ -330,6 +553,12 @@ void rai::block_store::do_upgrades (MDB_txn * transaction_a)
 		case 10:
 			upgrade_v10_to_v11 (transaction_a);
 		case 11:
+			upgrade_v11_to_v12 (transaction_a);
+		case 12:
+			upgrade_v12_to_v13 (transaction_a);
+		case 13:
+			upgrade_v13_to_v14 (transaction_a);
+		case 14:
 			break;
 		default:
 			assert (false);
@@ -374,6 +603,7 @@ void rai::block_store::upgrade_v2_to_v3 (MDB_txn * transaction_a)
 {
 	version_put (transaction_a, 3);
 	mdb_drop (transaction_a, representation, 0);
+	representation_load (transaction_a);
 	for (auto i (latest_begin (transaction_a)), n (latest_end ()); i != n; ++i)
 	{
 		rai::account account_l (i->first.uint256 ());
@@ -531,11 +761,77 @@ void rai::block_store::upgrade_v10_to_v11 (MDB_txn * transaction_a)
 	mdb_drop (transaction_a, unsynced, 1);
 }
 
+void rai::block_store::upgrade_v11_to_v12 (MDB_txn * transaction_a)
+{
+	version_put (transaction_a, 12);
+	mdb_drop (transaction_a, balances, 0);
+	for (auto i (latest_begin (transaction_a)), n (latest_end ()); i != n; ++i)
+	{
+		rai::account_info info (i->second);
+		balance_put (transaction_a, i->first.uint256 (), info.balance.number ());
+	}
+}
+
+void rai::block_store::upgrade_v12_to_v13 (MDB_txn * transaction_a)
+{
+	version_put (transaction_a, 13);
+	mdb_drop (transaction_a, pending_totals, 0);
+	rai::account current (0);
+	rai::pending_totals totals;
+	for (auto i (pending_begin (transaction_a)), n (pending_end ()); i != n; ++i)
+	{
+		rai::pending_key key (i->first);
+		if (key.account != current)
+		{
+			if (totals.count != 0)
+			{
+				auto status (mdb_put (transaction_a, pending_totals, rai::mdb_val (current), totals.val (), 0));
+				assert (status == 0);
+			}
+			current = key.account;
+			totals = rai::pending_totals ();
+		}
+		rai::pending_info info (i->second);
+		totals.sum = totals.sum.number () + info.amount.number ();
+		++totals.count;
+	}
+	if (totals.count != 0)
+	{
+		auto status (mdb_put (transaction_a, pending_totals, rai::mdb_val (current), totals.val (), 0));
+		assert (status == 0);
+	}
+}
+
 void rai::block_store::clear (MDB_dbi db_a)
 {
 	rai::transaction transaction (environment, nullptr, true);
 	auto status (mdb_drop (transaction, db_a, 0));
 	assert (status == 0);
+	counters_load (transaction);
+	representation_load (transaction);
+}
+
+void rai::block_store::counters_load (MDB_txn * transaction_a)
+{
+	counter_update (transaction_a, send_blocks, counters.send);
+	counter_update (transaction_a, receive_blocks, counters.receive);
+	counter_update (transaction_a, open_blocks, counters.open);
+	counter_update (transaction_a, change_blocks, counters.change);
+	counter_update (transaction_a, state_blocks, counters.state);
+	counter_update (transaction_a, accounts, counters.accounts);
+	counter_update (transaction_a, pending, counters.pending);
+	counter_update (transaction_a, unchecked, counters.unchecked);
+}
+
+/**
+ * The entry count is held in the transaction's copy of the table record, reading it doesn't walk the tree
+ */
+void rai::block_store::counter_update (MDB_txn * transaction_a, MDB_dbi db_a, std::atomic<uint64_t> & counter_a)
+{
+	MDB_stat stats;
+	auto status (mdb_stat (transaction_a, db_a, &stats));
+	assert (status == 0);
+	counter_a = stats.ms_entries;
 }
 
 rai::uint128_t rai::block_store::block_balance (MDB_txn * transaction_a, rai::block_hash const & hash_a)
@@ -583,8 +879,9 @@ MDB_dbi rai::block_store::block_database (rai::block_type type_a)
 
 void rai::block_store::block_put_raw (MDB_txn * transaction_a, MDB_dbi database_a, rai::block_hash const & hash_a, MDB_val value_a)
 {
-	auto status2 (mdb_put (transaction_a, database_a, rai::mdb_val (hash_a), &value_a, 0));
-	assert (status2 == 0);
+	auto status (mdb_put (transaction_a, database_a, rai::mdb_val (hash_a), &value_a, 0));
+	assert (status == 0);
+	counter_update (transaction_a, database_a, block_counter (database_a));
 }
 
 void rai::block_store::block_put (MDB_txn * transaction_a, rai::block_hash const & hash_a, rai::block const & block_a, rai::block_hash const & successor_a)
@@ -707,6 +1004,18 @@ std::unique_ptr<rai::block> rai::block_store::block_random (MDB_txn * transactio
 	return result;
 }
 
+rai::block_view rai::block_store::block_get_view (MDB_txn * transaction_a, rai::block_hash const & hash_a)
+{
+	rai::block_type type;
+	auto value (block_get_raw (transaction_a, hash_a, type));
+	rai::block_view result;
+	if (value.mv_size != 0)
+	{
+		result = rai::block_view (type, value);
+	}
+	return result;
+}
+
 rai::block_hash rai::block_store::block_successor (MDB_txn * transaction_a, rai::block_hash const & hash_a)
 {
 	rai::block_type type;
@@ -766,9 +1075,26 @@ void rai::block_store::block_del (MDB_txn * transaction_a, rai::block_hash const
 				{
 					auto status (mdb_del (transaction_a, change_blocks, rai::mdb_val (hash_a), nullptr));
 					assert (status == 0);
+					counter_update (transaction_a, change_blocks, counters.change);
 				}
+				else
+				{
+					counter_update (transaction_a, open_blocks, counters.open);
+				}
+			}
+			else
+			{
+				counter_update (transaction_a, receive_blocks, counters.receive);
 			}
 		}
+		else
+		{
+			counter_update (transaction_a, send_blocks, counters.send);
+		}
+	}
+	else
+	{
+		counter_update (transaction_a, state_blocks, counters.state);
 	}
 }
 
@@ -809,29 +1135,41 @@ bool rai::block_store::block_exists (MDB_txn * transaction_a, rai::block_hash co
 rai::block_counts rai::block_store::block_count (MDB_txn * transaction_a)
 {
 	rai::block_counts result;
-	MDB_stat send_stats;
-	auto status1 (mdb_stat (transaction_a, send_blocks, &send_stats));
-	assert (status1 == 0);
-	MDB_stat receive_stats;
-	auto status2 (mdb_stat (transaction_a, receive_blocks, &receive_stats));
-	assert (status2 == 0);
-	MDB_stat open_stats;
-	auto status3 (mdb_stat (transaction_a, open_blocks, &open_stats));
-	assert (status3 == 0);
-	MDB_stat change_stats;
-	auto status4 (mdb_stat (transaction_a, change_blocks, &change_stats));
-	assert (status4 == 0);
-	MDB_stat state_stats;
-	auto status5 (mdb_stat (transaction_a, state_blocks, &state_stats));
-	assert (status5 == 0);
-	result.send = send_stats.ms_entries;
-	result.receive = receive_stats.ms_entries;
-	result.open = open_stats.ms_entries;
-	result.change = change_stats.ms_entries;
-	result.state = state_stats.ms_entries;
+	result.send = counters.send;
+	result.receive = counters.receive;
+	result.open = counters.open;
+	result.change = counters.change;
+	result.state = counters.state;
 	return result;
 }
 
+std::atomic<uint64_t> & rai::block_store::block_counter (MDB_dbi database_a)
+{
+	std::atomic<uint64_t> * result;
+	if (database_a == send_blocks)
+	{
+		result = &counters.send;
+	}
+	else if (database_a == receive_blocks)
+	{
+		result = &counters.receive;
+	}
+	else if (database_a == open_blocks)
+	{
+		result = &counters.open;
+	}
+	else if (database_a == change_blocks)
+	{
+		result = &counters.change;
+	}
+	else
+	{
+		assert (database_a == state_blocks);
+		result = &counters.state;
+	}
+	return *result;
+}
+
 bool rai::block_store::root_exists (MDB_txn * transaction_a, rai::uint256_union const & root_a)
 {
 	return block_exists (transaction_a, root_a) || account_exists (transaction_a, root_a);
@@ -841,6 +1179,7 @@ void rai::block_store::account_del (MDB_txn * transaction_a, rai::account const
 {
 	auto status (mdb_del (transaction_a, accounts, rai::mdb_val (account_a), nullptr));
 	assert (status == 0);
+	counter_update (transaction_a, accounts, counters.accounts);
 }
 
 bool rai::block_store::account_exists (MDB_txn * transaction_a, rai::account const & account_a)
@@ -895,29 +1234,108 @@ void rai::block_store::frontier_del (MDB_txn * transaction_a, rai::block_hash co
 
 size_t rai::block_store::account_count (MDB_txn * transaction_a)
 {
-	MDB_stat frontier_stats;
-	auto status (mdb_stat (transaction_a, accounts, &frontier_stats));
-	assert (status == 0);
-	auto result (frontier_stats.ms_entries);
-	return result;
+	return counters.accounts;
 }
 
 void rai::block_store::account_put (MDB_txn * transaction_a, rai::account const & account_a, rai::account_info const & info_a)
 {
 	auto status (mdb_put (transaction_a, accounts, rai::mdb_val (account_a), info_a.val (), 0));
 	assert (status == 0);
+	counter_update (transaction_a, accounts, counters.accounts);
+}
+
+void rai::block_store::balance_put (MDB_txn * transaction_a, rai::account const & account_a, rai::uint128_t const & balance_a)
+{
+	auto status (mdb_put (transaction_a, balances, rai::balance_key (balance_a, account_a).val (), rai::mdb_val (0, nullptr), 0));
+	assert (status == 0);
+}
+
+void rai::block_store::balance_del (MDB_txn * transaction_a, rai::account const & account_a, rai::uint128_t const & balance_a)
+{
+	auto status (mdb_del (transaction_a, balances, rai::balance_key (balance_a, account_a).val (), nullptr));
+	assert (status == 0 || status == MDB_NOTFOUND);
+}
+
+rai::store_iterator rai::block_store::balance_begin (MDB_txn * transaction_a, rai::balance_key const & key_a)
+{
+	rai::store_iterator result (transaction_a, balances, key_a.val ());
+	return result;
+}
+
+rai::store_iterator rai::block_store::balance_begin (MDB_txn * transaction_a)
+{
+	rai::store_iterator result (transaction_a, balances);
+	return result;
+}
+
+rai::store_iterator rai::block_store::balance_end ()
+{
+	rai::store_iterator result (nullptr);
+	return result;
 }
 
 void rai::block_store::pending_put (MDB_txn * transaction_a, rai::pending_key const & key_a, rai::pending_info const & pending_a)
 {
+	rai::pending_info existing;
+	auto replaced (!pending_get (transaction_a, key_a, existing));
 	auto status (mdb_put (transaction_a, pending, key_a.val (), pending_a.val (), 0));
 	assert (status == 0);
+	auto totals (pending_totals_get (transaction_a, key_a.account));
+	if (replaced)
+	{
+		totals.sum = totals.sum.number () - existing.amount.number ();
+		--totals.count;
+	}
+	counter_update (transaction_a, pending, counters.pending);
+	totals.sum = totals.sum.number () + pending_a.amount.number ();
+	++totals.count;
+	auto status2 (mdb_put (transaction_a, pending_totals, rai::mdb_val (key_a.account), totals.val (), 0));
+	assert (status2 == 0);
 }
 
 void rai::block_store::pending_del (MDB_txn * transaction_a, rai::pending_key const & key_a)
 {
+	rai::pending_info existing;
+	auto error (pending_get (transaction_a, key_a, existing));
+	assert (!error);
 	auto status (mdb_del (transaction_a, pending, key_a.val (), nullptr));
 	assert (status == 0);
+	counter_update (transaction_a, pending, counters.pending);
+	if (!error)
+	{
+		auto totals (pending_totals_get (transaction_a, key_a.account));
+		assert (totals.count > 0);
+		totals.sum = totals.sum.number () - existing.amount.number ();
+		--totals.count;
+		if (totals.count == 0)
+		{
+			auto status2 (mdb_del (transaction_a, pending_totals, rai::mdb_val (key_a.account), nullptr));
+			assert (status2 == 0);
+		}
+		else
+		{
+			auto status2 (mdb_put (transaction_a, pending_totals, rai::mdb_val (key_a.account), totals.val (), 0));
+			assert (status2 == 0);
+		}
+	}
+}
+
+size_t rai::block_store::pending_count (MDB_txn * transaction_a)
+{
+	return counters.pending;
+}
+
+rai::pending_totals rai::block_store::pending_totals_get (MDB_txn * transaction_a, rai::account const & account_a)
+{
+	rai::pending_totals result;
+	rai::mdb_val value;
+	auto status (mdb_get (transaction_a, pending_totals, rai::mdb_val (account_a), value));
+	assert (status == 0 || status == MDB_NOTFOUND);
+	if (status == 0)
+	{
+		result = rai::pending_totals (value);
+	}
+	return result;
 }
 
 bool rai::block_store::pending_exists (MDB_txn * transaction_a, rai::pending_key const & key_a)
@@ -967,6 +1385,48 @@ rai::store_iterator rai::block_store::pending_end ()
 	return result;
 }
 
+rai::pending_iterator::pending_iterator (MDB_txn * transaction_a, rai::block_store & store_a, rai::account const & account_a, rai::uint128_t const & threshold_a, rai::block_hash const & start_a) :
+account (account_a),
+threshold (threshold_a),
+current (store_a.pending_begin (transaction_a, rai::pending_key (account_a, start_a)))
+{
+	skip ();
+}
+
+rai::pending_iterator & rai::pending_iterator::operator++ ()
+{
+	++current;
+	skip ();
+	return *this;
+}
+
+bool rai::pending_iterator::done () const
+{
+	auto & key (current.current.first);
+	return key.size () == 0 || std::memcmp (key.data (), account.bytes.data (), account.bytes.size ()) != 0;
+}
+
+rai::pending_key rai::pending_iterator::key () const
+{
+	assert (!done ());
+	return rai::pending_key (current.current.first);
+}
+
+rai::pending_info rai::pending_iterator::info () const
+{
+	assert (!done ());
+	return rai::pending_info (current.current.second);
+}
+
+void rai::pending_iterator::skip ()
+{
+	// The amount follows the source account in the stored value
+	while (!done () && std::memcmp (reinterpret_cast<uint8_t const *> (current.current.second.data ()) + sizeof (rai::account), threshold.bytes.data (), threshold.bytes.size ()) < 0)
+	{
+		++current;
+	}
+}
+
 void rai::block_store::block_info_put (MDB_txn * transaction_a, rai::block_hash const & hash_a, rai::block_info const & block_info_a)
 {
 	auto status (mdb_put (transaction_a, blocks_info, rai::mdb_val (hash_a), block_info_a.val (), 0));
@@ -1010,21 +1470,12 @@ bool rai::block_store::block_info_get (MDB_txn * transaction_a, rai::block_hash
 
 rai::uint128_t rai::block_store::representation_get (MDB_txn * transaction_a, rai::account const & account_a)
 {
-	rai::mdb_val value;
-	auto status (mdb_get (transaction_a, representation, rai::mdb_val (account_a), value));
-	assert (status == 0 || status == MDB_NOTFOUND);
-	rai::uint128_t result;
-	if (status == 0)
+	rai::uint128_t result (0);
+	std::lock_guard<std::mutex> lock (representation_mutex);
+	auto existing (representation_cache.find (account_a));
+	if (existing != representation_cache.end ())
 	{
-		rai::uint128_union rep;
-		rai::bufferstream stream (reinterpret_cast<uint8_t const *> (value.data ()), value.size ());
-		auto error (rai::read (stream, rep));
-		assert (!error);
-		result = rep.number ();
-	}
-	else
-	{
-		result = 0;
+		result = existing->second;
 	}
 	return result;
 }
@@ -1034,12 +1485,47 @@ void rai::block_store::representation_put (MDB_txn * transaction_a, rai::account
 	rai::uint128_union rep (representation_a);
 	auto status (mdb_put (transaction_a, representation, rai::mdb_val (account_a), rai::mdb_val (rep), 0));
 	assert (status == 0);
+	std::lock_guard<std::mutex> lock (representation_mutex);
+	if (representation_a != 0)
+	{
+		representation_cache[account_a] = representation_a;
+	}
+	else
+	{
+		representation_cache.erase (account_a);
+	}
+}
+
+void rai::block_store::representation_load (MDB_txn * transaction_a)
+{
+	std::unordered_map<rai::account, rai::uint128_t> weights;
+	for (auto i (representation_begin (transaction_a)), n (representation_end ()); i != n; ++i)
+	{
+		rai::uint128_union rep;
+		rai::bufferstream stream (reinterpret_cast<uint8_t const *> (i->second.data ()), i->second.size ());
+		auto error (rai::read (stream, rep));
+		assert (!error);
+		if (!rep.is_zero ())
+		{
+			weights[i->first.uint256 ()] = rep.number ();
+		}
+	}
+	std::lock_guard<std::mutex> lock (representation_mutex);
+	representation_cache.swap (weights);
+}
+
+void rai::block_store::upgrade_v13_to_v14 (MDB_txn * transaction_a)
+{
+	version_put (transaction_a, 14);
+	// Unchecked entries now carry their arrival time
+	mdb_drop (transaction_a, unchecked, 0);
 }
 
 void rai::block_store::unchecked_clear (MDB_txn * transaction_a)
 {
 	auto status (mdb_drop (transaction_a, unchecked, 0));
 	assert (status == 0);
+	counter_update (transaction_a, unchecked, counters.unchecked);
 }
 
 void rai::block_store::unchecked_put (MDB_txn * transaction_a, rai::block_hash const & hash_a, std::shared_ptr<rai::block> const & block_a)
@@ -1058,8 +1544,16 @@ void rai::block_store::unchecked_put (MDB_txn * transaction_a, rai::block_hash c
 	// Inserting block if it wasn't found in database
 	if (!exists)
 	{
-		std::lock_guard<std::mutex> lock (cache_mutex);
-		unchecked_cache.insert (std::make_pair (hash_a, block_a));
+		bool spill (false);
+		{
+			std::lock_guard<std::mutex> lock (cache_mutex);
+			unchecked_cache.insert (std::make_pair (hash_a, block_a));
+			spill = unchecked_cache.size () > unchecked_cache_max;
+		}
+		if (spill)
+		{
+			unchecked_flush (transaction_a);
+		}
 	}
 }
 
@@ -1087,10 +1581,14 @@ std::vector<std::shared_ptr<rai::block>> rai::block_store::unchecked_get (MDB_tx
 			result.push_back (i->second);
 		}
 	}
-	for (auto i (unchecked_begin (transaction_a, hash_a)), n (unchecked_end ()); i != n && rai::block_hash (i->first.uint256 ()) == hash_a; i.next_dup ())
+	// Nothing has been spilled to disk, skip the lookup
+	if (counters.unchecked != 0)
 	{
-		rai::bufferstream stream (reinterpret_cast<uint8_t const *> (i->second.data ()), i->second.size ());
-		result.push_back (rai::deserialize_block (stream));
+		for (auto i (unchecked_begin (transaction_a, hash_a)), n (unchecked_end ()); i != n && rai::block_hash (i->first.uint256 ()) == hash_a; i.next_dup ())
+		{
+			rai::bufferstream stream (reinterpret_cast<uint8_t const *> (i->second.data ()), i->second.size ());
+			result.push_back (rai::deserialize_block (stream));
+		}
 	}
 	return result;
 }
@@ -1111,22 +1609,68 @@ void rai::block_store::unchecked_del (MDB_txn * transaction_a, rai::block_hash c
 			}
 		}
 	}
-	std::vector<uint8_t> vector;
+	// Stored values are suffixed with their arrival time so the entry is found by comparing blocks
+	std::vector<uint8_t> value;
+	for (auto i (unchecked_begin (transaction_a, hash_a)), n (unchecked_end ()); value.empty () && i != n && rai::block_hash (i->first.uint256 ()) == hash_a; i.next_dup ())
 	{
-		rai::vectorstream stream (vector);
-		rai::serialize_block (stream, block_a);
+		rai::bufferstream stream (reinterpret_cast<uint8_t const *> (i->second.data ()), i->second.size ());
+		auto block (rai::deserialize_block (stream));
+		if (block != nullptr && *block == block_a)
+		{
+			value.assign (reinterpret_cast<uint8_t const *> (i->second.data ()), reinterpret_cast<uint8_t const *> (i->second.data ()) + i->second.size ());
+		}
+	}
+	if (!value.empty ())
+	{
+		auto status (mdb_del (transaction_a, unchecked, rai::mdb_val (hash_a), rai::mdb_val (value.size (), value.data ())));
+		assert (status == 0);
+		counter_update (transaction_a, unchecked, counters.unchecked);
 	}
-	auto status (mdb_del (transaction_a, unchecked, rai::mdb_val (hash_a), rai::mdb_val (vector.size (), vector.data ())));
-	assert (status == 0 || status == MDB_NOTFOUND);
 }
 
 size_t rai::block_store::unchecked_count (MDB_txn * transaction_a)
 {
-	MDB_stat unchecked_stats;
-	auto status (mdb_stat (transaction_a, unchecked, &unchecked_stats));
-	assert (status == 0);
-	auto result (unchecked_stats.ms_entries);
-	return result;
+	return counters.unchecked;
+}
+
+/**
+ * Evicts entries that arrived before the cutoff, examining at most max_a entries starting from the key in cursor_a.
+ * cursor_a is left on the first entry not examined, or zero once the end of the table is reached.
+ */
+size_t rai::block_store::unchecked_cleanup (MDB_txn * transaction_a, uint64_t cutoff_a, rai::block_hash & cursor_a, size_t max_a)
+{
+	std::vector<std::pair<rai::block_hash, std::vector<uint8_t>>> expired;
+	size_t examined (0);
+	auto i (unchecked_begin (transaction_a, cursor_a));
+	auto n (unchecked_end ());
+	while (i != n && examined < max_a)
+	{
+		// Values are the block type, the block and its arrival time so the time is found from the type's size without deserializing
+		auto data (reinterpret_cast<uint8_t const *> (i->second.data ()));
+		auto size (i->second.size ());
+		auto block_size (size > 0 ? rai::block_size (static_cast<rai::block_type> (data[0])) : 0);
+		uint64_t arrival (0);
+		auto error (block_size == 0 || size != 1 + block_size + sizeof (arrival));
+		if (!error)
+		{
+			rai::bufferstream stream (data + 1 + block_size, sizeof (arrival));
+			error = rai::read (stream, arrival);
+		}
+		if (error || arrival < cutoff_a)
+		{
+			expired.push_back (std::make_pair (rai::block_hash (i->first.uint256 ()), std::vector<uint8_t> (data, data + size)));
+		}
+		++examined;
+		++i;
+	}
+	cursor_a = i != n ? rai::block_hash (i->first.uint256 ()) : rai::block_hash (0);
+	for (auto & i : expired)
+	{
+		auto status (mdb_del (transaction_a, unchecked, rai::mdb_val (i.first), rai::mdb_val (i.second.size (), i.second.data ())));
+		assert (status == 0);
+	}
+	counter_update (transaction_a, unchecked, counters.unchecked);
+	return expired.size ();
 }
 
 void rai::block_store::checksum_put (MDB_txn * transaction_a, uint64_t prefix, uint8_t mask, rai::uint256_union const & hash_a)
@@ -1167,25 +1711,63 @@ void rai::block_store::checksum_del (MDB_txn * transaction_a, uint64_t prefix, u
 	assert (status == 0);
 }
 
-void rai::block_store::flush (MDB_txn * transaction_a)
+void rai::block_store::bootstrap_score_put (MDB_txn * transaction_a, rai::endpoint_key const & endpoint_a, rai::bootstrap_score const & score_a)
+{
+	std::vector<uint8_t> vector;
+	{
+		rai::vectorstream stream (vector);
+		score_a.serialize (stream);
+	}
+	auto status (mdb_put (transaction_a, bootstrap_scores, endpoint_a.val (), rai::mdb_val (vector.size (), vector.data ()), 0));
+	assert (status == 0);
+}
+
+void rai::block_store::bootstrap_score_del (MDB_txn * transaction_a, rai::endpoint_key const & endpoint_a)
+{
+	auto status (mdb_del (transaction_a, bootstrap_scores, endpoint_a.val (), nullptr));
+	assert (status == 0 || status == MDB_NOTFOUND);
+}
+
+rai::store_iterator rai::block_store::bootstrap_score_begin (MDB_txn * transaction_a)
+{
+	return rai::store_iterator (transaction_a, bootstrap_scores);
+}
+
+rai::store_iterator rai::block_store::bootstrap_score_end ()
+{
+	return rai::store_iterator (nullptr);
+}
+
+void rai::block_store::unchecked_flush (MDB_txn * transaction_a)
 {
-	std::unordered_map<rai::account, std::shared_ptr<rai::vote>> sequence_cache_l;
 	std::unordered_multimap<rai::block_hash, std::shared_ptr<rai::block>> unchecked_cache_l;
 	{
 		std::lock_guard<std::mutex> lock (cache_mutex);
-		sequence_cache_l.swap (vote_cache);
 		unchecked_cache_l.swap (unchecked_cache);
 	}
+	uint64_t arrival (std::chrono::duration_cast<std::chrono::seconds> (std::chrono::system_clock::now ().time_since_epoch ()).count ());
 	for (auto & i : unchecked_cache_l)
 	{
 		std::vector<uint8_t> vector;
 		{
 			rai::vectorstream stream (vector);
 			rai::serialize_block (stream, *i.second);
+			rai::write (stream, arrival);
 		}
-		auto status (mdb_put (transaction_a, unchecked, rai::mdb_val (i.first), rai::mdb_val (vector.size (), vector.data ()), 0));
-		assert (status == 0);
+		auto status (mdb_put (transaction_a, unchecked, rai::mdb_val (i.first), rai::mdb_val (vector.size (), vector.data ()), MDB_NODUPDATA));
+		assert (status == 0 || status == MDB_KEYEXIST);
+	}
+	counter_update (transaction_a, unchecked, counters.unchecked);
+}
+
+void rai::block_store::flush (MDB_txn * transaction_a)
+{
+	std::unordered_map<rai::account, std::shared_ptr<rai::vote>> sequence_cache_l;
+	{
+		std::lock_guard<std::mutex> lock (cache_mutex);
+		sequence_cache_l.swap (vote_cache);
 	}
+	unchecked_flush (transaction_a);
 	for (auto i (sequence_cache_l.begin ()), n (sequence_cache_l.end ()); i != n; ++i)
 	{
 		std::vector<uint8_t> vector;
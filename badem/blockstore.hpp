@@ -2,6 +2,8 @@
 
 #include <badem/common.hpp>
 
+#include <atomic>
+
 namespace rai
 {
 /**
@@ -40,6 +42,56 @@ public:
 	rai::store_entry current;
 };
 
+/**
+ * Entry counts of the counted tables, kept in step by the store's own writes so reading them never touches LMDB.
+ * Writes copy the count LMDB keeps in the transaction's table record rather than adding to it, so a counter can't drift from its table.
+ */
+class store_counters
+{
+public:
+	store_counters ();
+	std::atomic<uint64_t> send;
+	std::atomic<uint64_t> receive;
+	std::atomic<uint64_t> open;
+	std::atomic<uint64_t> change;
+	std::atomic<uint64_t> state;
+	std::atomic<uint64_t> accounts;
+	std::atomic<uint64_t> pending;
+	std::atomic<uint64_t> unchecked;
+};
+
+/**
+ * Read-only view of a block as stored, fields are read straight from the database value without building a block.
+ * The value belongs to LMDB so a view is only valid until the transaction it was read in ends, or in a write transaction until the next put or delete.
+ * Don't keep a view across block_put or block_del, e.g. while rolling back, read it again afterwards.
+ * Fields a block type doesn't have read as zero, the same as the block accessors.
+ */
+class block_view
+{
+public:
+	block_view ();
+	block_view (rai::block_type, MDB_val const &);
+	rai::block_hash previous () const;
+	rai::block_hash source () const;
+	rai::block_hash root () const;
+	rai::account representative () const;
+	rai::account account () const;
+	rai::account destination () const;
+	rai::amount balance () const;
+	rai::uint256_union link () const;
+	rai::block_hash successor () const;
+	rai::block_hash hash () const;
+	// Serialized size of the block, not counting the successor stored after it
+	size_t size () const;
+	std::unique_ptr<rai::block> block () const;
+	// invalid when the block wasn't found
+	rai::block_type type;
+	MDB_val value;
+
+private:
+	rai::uint256_union read (size_t) const;
+};
+
 /**
  * Manages block storage and iteration
  */
@@ -55,11 +107,13 @@ public:
 	rai::block_hash block_successor (MDB_txn *, rai::block_hash const &);
 	void block_successor_clear (MDB_txn *, rai::block_hash const &);
 	std::unique_ptr<rai::block> block_get (MDB_txn *, rai::block_hash const &);
+	rai::block_view block_get_view (MDB_txn *, rai::block_hash const &);
 	std::unique_ptr<rai::block> block_random (MDB_txn *);
 	std::unique_ptr<rai::block> block_random (MDB_txn *, MDB_dbi);
 	void block_del (MDB_txn *, rai::block_hash const &);
 	bool block_exists (MDB_txn *, rai::block_hash const &);
 	rai::block_counts block_count (MDB_txn *);
+	std::atomic<uint64_t> & block_counter (MDB_dbi);
 	bool root_exists (MDB_txn *, rai::uint256_union const &);
 
 	void frontier_put (MDB_txn *, rai::block_hash const &, rai::account const &);
@@ -75,6 +129,12 @@ public:
 	rai::store_iterator latest_begin (MDB_txn *);
 	rai::store_iterator latest_end ();
 
+	void balance_put (MDB_txn *, rai::account const &, rai::uint128_t const &);
+	void balance_del (MDB_txn *, rai::account const &, rai::uint128_t const &);
+	rai::store_iterator balance_begin (MDB_txn *, rai::balance_key const &);
+	rai::store_iterator balance_begin (MDB_txn *);
+	rai::store_iterator balance_end ();
+
 	void pending_put (MDB_txn *, rai::pending_key const &, rai::pending_info const &);
 	void pending_del (MDB_txn *, rai::pending_key const &);
 	bool pending_get (MDB_txn *, rai::pending_key const &, rai::pending_info &);
@@ -82,6 +142,8 @@ public:
 	rai::store_iterator pending_begin (MDB_txn *, rai::pending_key const &);
 	rai::store_iterator pending_begin (MDB_txn *);
 	rai::store_iterator pending_end ();
+	rai::pending_totals pending_totals_get (MDB_txn *, rai::account const &);
+	size_t pending_count (MDB_txn *);
 
 	void block_info_put (MDB_txn *, rai::block_hash const &, rai::block_info const &);
 	void block_info_del (MDB_txn *, rai::block_hash const &);
@@ -98,6 +160,10 @@ public:
 	void representation_add (MDB_txn *, rai::account const &, rai::uint128_t const &);
 	rai::store_iterator representation_begin (MDB_txn *);
 	rai::store_iterator representation_end ();
+	void representation_load (MDB_txn *);
+	// Every nonzero representative weight, loaded on open and kept in step by representation_put so weight lookups don't touch LMDB
+	std::unordered_map<rai::account, rai::uint128_t> representation_cache;
+	std::mutex representation_mutex;
 
 	void unchecked_clear (MDB_txn *);
 	void unchecked_put (MDB_txn *, rai::block_hash const &, std::shared_ptr<rai::block> const &);
@@ -107,12 +173,23 @@ public:
 	rai::store_iterator unchecked_begin (MDB_txn *, rai::block_hash const &);
 	rai::store_iterator unchecked_end ();
 	size_t unchecked_count (MDB_txn *);
+	// Remove unchecked blocks that arrived before cutoff, in seconds since epoch, returning the number removed
+	size_t unchecked_cleanup (MDB_txn *, uint64_t, rai::block_hash &, size_t);
+	void unchecked_flush (MDB_txn *);
 	std::unordered_multimap<rai::block_hash, std::shared_ptr<rai::block>> unchecked_cache;
+	// Number of unchecked blocks held in memory before they're spilled to disk
+	size_t unchecked_cache_max;
+	static size_t const unchecked_cache_default = 64 * 1024;
 
 	void checksum_put (MDB_txn *, uint64_t, uint8_t, rai::checksum const &);
 	bool checksum_get (MDB_txn *, uint64_t, uint8_t, rai::checksum &);
 	void checksum_del (MDB_txn *, uint64_t, uint8_t);
 
+	void bootstrap_score_put (MDB_txn *, rai::endpoint_key const &, rai::bootstrap_score const &);
+	void bootstrap_score_del (MDB_txn *, rai::endpoint_key const &);
+	rai::store_iterator bootstrap_score_begin (MDB_txn *);
+	rai::store_iterator bootstrap_score_end ();
+
 	// Return latest vote for an account from store
 	std::shared_ptr<rai::vote> vote_get (MDB_txn *, rai::account const &);
 	// Populate vote with the next sequence number
@@ -140,8 +217,15 @@ public:
 	void upgrade_v8_to_v9 (MDB_txn *);
 	void upgrade_v9_to_v10 (MDB_txn *);
 	void upgrade_v10_to_v11 (MDB_txn *);
+	void upgrade_v11_to_v12 (MDB_txn *);
+	void upgrade_v12_to_v13 (MDB_txn *);
+	void upgrade_v13_to_v14 (MDB_txn *);
 
 	void clear (MDB_dbi);
+	void counters_load (MDB_txn *);
+	// Set a counter from the table's entry count as this transaction sees it
+	void counter_update (MDB_txn *, MDB_dbi, std::atomic<uint64_t> &);
+	rai::store_counters counters;
 
 	rai::mdb_env environment;
 
@@ -157,6 +241,12 @@ public:
 	 */
 	MDB_dbi accounts;
 
+	/**
+	 * Accounts ordered by descending balance, maintained alongside accounts.
+	 * rai::uint128_t (inverted balance), rai::account -> nil
+	 */
+	MDB_dbi balances;
+
 	/**
 	 * Maps block hash to send block.
 	 * rai::block_hash -> rai::send_block
@@ -193,6 +283,12 @@ public:
 	 */
 	MDB_dbi pending;
 
+	/**
+	 * Number and sum of pending entries per destination, maintained alongside pending.
+	 * rai::account -> rai::amount, uint64_t
+	 */
+	MDB_dbi pending_totals;
+
 	/**
 	 * Maps block hash to account and balance.
 	 * block_hash -> rai::account, rai::amount
@@ -206,8 +302,8 @@ public:
 	MDB_dbi representation;
 
 	/**
-	 * Unchecked bootstrap blocks.
-	 * rai::block_hash -> rai::block
+	 * Unchecked bootstrap blocks keyed by the dependency they're waiting on.
+	 * rai::block_hash -> rai::block, uint64_t arrival in seconds since epoch
 	 */
 	MDB_dbi unchecked;
 
@@ -217,6 +313,12 @@ public:
 	 */
 	MDB_dbi checksum;
 
+	/**
+	 * Bootstrap history of peers, pruned along with the peers themselves.
+	 * rai::endpoint_key -> rai::bootstrap_score
+	 */
+	MDB_dbi bootstrap_scores;
+
 	/**
 	 * Highest vote observed for account.
 	 * rai::account -> uint64_t
@@ -229,4 +331,24 @@ public:
 	 */
 	MDB_dbi meta;
 };
+
+/**
+ * Iterates the pending entries of one account, skipping entries below a threshold.
+ * Amounts are stored big endian so they're compared in place without decoding the entry.
+ */
+class pending_iterator
+{
+public:
+	pending_iterator (MDB_txn *, rai::block_store &, rai::account const &, rai::uint128_t const & = 0, rai::block_hash const & = rai::block_hash (0));
+	rai::pending_iterator & operator++ ();
+	bool done () const;
+	rai::pending_key key () const;
+	rai::pending_info info () const;
+
+private:
+	void skip ();
+	rai::account account;
+	rai::amount threshold;
+	rai::store_iterator current;
+};
 }
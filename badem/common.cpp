@@ -107,13 +107,26 @@ rai::block_hash const & rai::not_a_block (globals.not_a_block);
 rai::block_hash const & rai::not_an_account (globals.not_an_account);
 rai::account const & rai::burn_account (globals.burn_account);
 
+size_t rai::shared_ptr_block_hash::operator() (std::shared_ptr<rai::block> const & block_a) const
+{
+	auto hash (block_a->hash ());
+	auto result (static_cast<size_t> (hash.qwords[0]));
+	return result;
+}
+
+bool rai::shared_ptr_block_hash::operator() (std::shared_ptr<rai::block> const & lhs, std::shared_ptr<rai::block> const & rhs) const
+{
+	return lhs->hash () == rhs->hash ();
+}
+
 rai::votes::votes (std::shared_ptr<rai::block> block_a) :
 id (block_a->root ())
 {
 	rep_votes.insert (std::make_pair (rai::not_an_account, block_a));
+	tally_add (rai::not_an_account, block_a, 0);
 }
 
-rai::tally_result rai::votes::vote (std::shared_ptr<rai::vote> vote_a)
+rai::tally_result rai::votes::vote (std::shared_ptr<rai::vote> vote_a, rai::uint128_t const & weight_a)
 {
 	rai::tally_result result;
 	auto existing (rep_votes.find (vote_a->account));
@@ -125,6 +138,8 @@ rai::tally_result rai::votes::vote (std::shared_ptr<rai::vote> vote_a)
 	}
 	else
 	{
+		// Take back the previous vote so it can be counted again with the current weight
+		tally_remove (existing->first, existing->second);
 		if (!(*existing->second == *vote_a->block))
 		{
 			// Rep changed their vote
@@ -137,6 +152,41 @@ rai::tally_result rai::votes::vote (std::shared_ptr<rai::vote> vote_a)
 			result = rai::tally_result::confirm;
 		}
 	}
+	tally_add (vote_a->account, vote_a->block, weight_a);
+	return result;
+}
+
+void rai::votes::tally_add (rai::account const & account_a, std::shared_ptr<rai::block> block_a, rai::uint128_t const & weight_a)
+{
+	auto & total (totals[block_a]);
+	total.first += weight_a;
+	++total.second;
+	rep_weights[account_a] = weight_a;
+}
+
+void rai::votes::tally_remove (rai::account const & account_a, std::shared_ptr<rai::block> block_a)
+{
+	auto weight (rep_weights.find (account_a));
+	assert (weight != rep_weights.end ());
+	auto total (totals.find (block_a));
+	assert (total != totals.end ());
+	assert (total->second.first >= weight->second);
+	assert (total->second.second > 0);
+	total->second.first -= weight->second;
+	if (--total->second.second == 0)
+	{
+		totals.erase (total);
+	}
+	rep_weights.erase (weight);
+}
+
+rai::tally_t rai::votes::tally () const
+{
+	rai::tally_t result;
+	for (auto & i : totals)
+	{
+		result[i.second.first] = i.first;
+	}
 	return result;
 }
 
@@ -358,6 +408,162 @@ rai::mdb_val rai::pending_key::val () const
 	return rai::mdb_val (sizeof (*this), const_cast<rai::pending_key *> (this));
 }
 
+rai::balance_key::balance_key (rai::uint128_t const & balance_a, rai::account const & account_a) :
+inverse (std::numeric_limits<rai::uint128_t>::max () - balance_a),
+account (account_a)
+{
+}
+
+rai::balance_key::balance_key (MDB_val const & val_a)
+{
+	assert (val_a.mv_size == sizeof (*this));
+	static_assert (sizeof (inverse) + sizeof (account) == sizeof (*this), "Packed class");
+	std::copy (reinterpret_cast<uint8_t const *> (val_a.mv_data), reinterpret_cast<uint8_t const *> (val_a.mv_data) + sizeof (*this), reinterpret_cast<uint8_t *> (this));
+}
+
+bool rai::balance_key::operator== (rai::balance_key const & other_a) const
+{
+	return inverse == other_a.inverse && account == other_a.account;
+}
+
+rai::mdb_val rai::balance_key::val () const
+{
+	return rai::mdb_val (sizeof (*this), const_cast<rai::balance_key *> (this));
+}
+
+rai::uint128_t rai::balance_key::balance () const
+{
+	return std::numeric_limits<rai::uint128_t>::max () - inverse.number ();
+}
+
+rai::pending_totals::pending_totals () :
+sum (0),
+count (0)
+{
+}
+
+rai::pending_totals::pending_totals (MDB_val const & val_a)
+{
+	assert (val_a.mv_size == sizeof (*this));
+	static_assert (sizeof (sum) + sizeof (count) == sizeof (*this), "Packed class");
+	std::copy (reinterpret_cast<uint8_t const *> (val_a.mv_data), reinterpret_cast<uint8_t const *> (val_a.mv_data) + sizeof (*this), reinterpret_cast<uint8_t *> (this));
+}
+
+rai::pending_totals::pending_totals (rai::amount const & sum_a, uint64_t count_a) :
+sum (sum_a),
+count (count_a)
+{
+}
+
+bool rai::pending_totals::operator== (rai::pending_totals const & other_a) const
+{
+	return sum == other_a.sum && count == other_a.count;
+}
+
+rai::mdb_val rai::pending_totals::val () const
+{
+	return rai::mdb_val (sizeof (*this), const_cast<rai::pending_totals *> (this));
+}
+
+rai::endpoint_key::endpoint_key (std::array<uint8_t, 16> const & address_a, uint16_t port_a) :
+address (address_a),
+port (port_a)
+{
+}
+
+rai::endpoint_key::endpoint_key (MDB_val const & val_a)
+{
+	assert (val_a.mv_size == sizeof (*this));
+	static_assert (sizeof (address) + sizeof (port) == sizeof (*this), "Packed class");
+	std::copy (reinterpret_cast<uint8_t const *> (val_a.mv_data), reinterpret_cast<uint8_t const *> (val_a.mv_data) + sizeof (*this), reinterpret_cast<uint8_t *> (this));
+}
+
+bool rai::endpoint_key::operator== (rai::endpoint_key const & other_a) const
+{
+	return address == other_a.address && port == other_a.port;
+}
+
+rai::mdb_val rai::endpoint_key::val () const
+{
+	return rai::mdb_val (sizeof (*this), const_cast<rai::endpoint_key *> (this));
+}
+
+rai::bootstrap_score::bootstrap_score () :
+rate (0.0),
+latency (0.0),
+failure (0.0),
+attempts (0),
+last_update (0)
+{
+}
+
+void rai::bootstrap_score::completed (std::chrono::milliseconds const & latency_a, uint64_t blocks_a, double rate_a)
+{
+	auto first (attempts == 0);
+	latency = first ? latency_a.count () : latency + smoothing * (latency_a.count () - latency);
+	failure = first ? 0.0 : failure - smoothing * failure;
+	// Connections used only for frontiers or left idle say nothing about throughput
+	if (blocks_a > 0)
+	{
+		rate = rate == 0.0 ? rate_a : rate + smoothing * (rate_a - rate);
+	}
+	++attempts;
+	last_update = rai::seconds_since_epoch ();
+}
+
+void rai::bootstrap_score::failed ()
+{
+	failure = attempts == 0 ? 1.0 : failure + smoothing * (1.0 - failure);
+	++attempts;
+	last_update = rai::seconds_since_epoch ();
+}
+
+double rai::bootstrap_score::score () const
+{
+	double result;
+	if (attempts == 0)
+	{
+		// Untried peers go first so every peer gets measured
+		result = std::numeric_limits<double>::max ();
+	}
+	else
+	{
+		result = rate * (1.0 - failure) / (1.0 + latency / 1000.0);
+	}
+	return result;
+}
+
+void rai::bootstrap_score::serialize (rai::stream & stream_a) const
+{
+	rai::write (stream_a, rate);
+	rai::write (stream_a, latency);
+	rai::write (stream_a, failure);
+	rai::write (stream_a, attempts);
+	rai::write (stream_a, last_update);
+}
+
+bool rai::bootstrap_score::deserialize (rai::stream & stream_a)
+{
+	auto error (rai::read (stream_a, rate));
+	if (!error)
+	{
+		error = rai::read (stream_a, latency);
+		if (!error)
+		{
+			error = rai::read (stream_a, failure);
+			if (!error)
+			{
+				error = rai::read (stream_a, attempts);
+				if (!error)
+				{
+					error = rai::read (stream_a, last_update);
+				}
+			}
+		}
+	}
+	return error;
+}
+
 rai::block_info::block_info () :
 account (0),
 balance (0)
@@ -598,9 +804,19 @@ void rai::representative_visitor::compute (rai::block_hash const & hash_a)
 	current = hash_a;
 	while (result.is_zero ())
 	{
-		auto block (store.block_get (transaction, current));
-		assert (block != nullptr);
-		block->visit (*this);
+		// Only the type and previous are needed to find the block that set the representative so it's read in place
+		auto block (store.block_get_view (transaction, current));
+		assert (block.type != rai::block_type::invalid);
+		switch (block.type)
+		{
+			case rai::block_type::send:
+			case rai::block_type::receive:
+				current = block.previous ();
+				break;
+			default:
+				result = current;
+				break;
+		}
 	}
 }
 
@@ -671,7 +887,7 @@ rai::vote::vote (bool & error_a, rai::stream & stream_a, rai::block_type type_a)
 				error_a = rai::read (stream_a, sequence);
 				if (!error_a)
 				{
-					block = rai::deserialize_block (stream_a, type_a);
+					block = rai::deserialize_block_pooled (stream_a, type_a);
 					error_a = block == nullptr;
 				}
 			}
@@ -774,6 +990,7 @@ void rai::genesis::initialize (MDB_txn * transaction_a, rai::block_store & store
 	assert (store_a.latest_begin (transaction_a) == store_a.latest_end ());
 	store_a.block_put (transaction_a, hash_l, *open);
 	store_a.account_put (transaction_a, genesis_account, { hash_l, open->hash (), open->hash (), std::numeric_limits<rai::uint128_t>::max (), rai::seconds_since_epoch (), 1 });
+	store_a.balance_put (transaction_a, genesis_account, std::numeric_limits<rai::uint128_t>::max ());
 	store_a.representation_put (transaction_a, genesis_account, std::numeric_limits<rai::uint128_t>::max ());
 	store_a.checksum_put (transaction_a, 0, 0, hash_l);
 	store_a.frontier_put (transaction_a, hash_l, genesis_account);
@@ -5,6 +5,8 @@
 
 #include <boost/property_tree/ptree.hpp>
 
+#include <array>
+#include <chrono>
 #include <unordered_map>
 
 #include <blake2/blake2.h>
@@ -157,6 +159,34 @@ public:
 	rai::account account;
 	rai::block_hash hash;
 };
+/**
+ * Key of the balance index, the balance is stored inverted so iteration visits the largest balances first
+ */
+class balance_key
+{
+public:
+	balance_key (rai::uint128_t const &, rai::account const &);
+	balance_key (MDB_val const &);
+	bool operator== (rai::balance_key const &) const;
+	rai::mdb_val val () const;
+	rai::uint128_t balance () const;
+	rai::amount inverse;
+	rai::account account;
+};
+/**
+ * Number and sum of the pending entries of one account
+ */
+class pending_totals
+{
+public:
+	pending_totals ();
+	pending_totals (MDB_val const &);
+	pending_totals (rai::amount const &, uint64_t);
+	bool operator== (rai::pending_totals const &) const;
+	rai::mdb_val val () const;
+	rai::amount sum;
+	uint64_t count;
+};
 class block_info
 {
 public:
@@ -170,6 +200,40 @@ public:
 	rai::account account;
 	rai::amount balance;
 };
+/**
+ * Key of a peer in the bootstrap score table, an IPv6 address and port
+ */
+class endpoint_key
+{
+public:
+	endpoint_key (std::array<uint8_t, 16> const &, uint16_t);
+	endpoint_key (MDB_val const &);
+	bool operator== (rai::endpoint_key const &) const;
+	rai::mdb_val val () const;
+	std::array<uint8_t, 16> address;
+	uint16_t port;
+};
+/**
+ * Bootstrap history of an endpoint, kept across attempts and node restarts so fast peers are preferred the next time around
+ */
+class bootstrap_score
+{
+public:
+	bootstrap_score ();
+	void completed (std::chrono::milliseconds const &, uint64_t, double);
+	void failed ();
+	double score () const;
+	void serialize (rai::stream &) const;
+	bool deserialize (rai::stream &);
+	// Moving averages of served blocks per second, connection latency in milliseconds and the fraction of failed connections
+	double rate;
+	double latency;
+	double failure;
+	uint32_t attempts;
+	// Seconds since epoch of the last attempt, scores left untouched long enough are evicted
+	uint64_t last_update;
+	static double constexpr smoothing = 0.25;
+};
 class block_counts
 {
 public:
@@ -242,16 +306,34 @@ enum class tally_result
 	changed,
 	confirm
 };
+class shared_ptr_block_hash
+{
+public:
+	size_t operator() (std::shared_ptr<rai::block> const &) const;
+	bool operator() (std::shared_ptr<rai::block> const &, std::shared_ptr<rai::block> const &) const;
+};
+using tally_t = std::map<rai::uint128_t, std::shared_ptr<rai::block>, std::greater<rai::uint128_t>>;
 class votes
 {
 public:
 	votes (std::shared_ptr<rai::block>);
-	rai::tally_result vote (std::shared_ptr<rai::vote>);
+	// Record the vote counted with the representative's current weight
+	rai::tally_result vote (std::shared_ptr<rai::vote>, rai::uint128_t const &);
 	bool uncontested ();
+	// Vote totals per block from the weights recorded with each vote
+	rai::tally_t tally () const;
 	// Root block of fork
 	rai::block_hash id;
 	// All votes received by account
 	std::unordered_map<rai::account, std::shared_ptr<rai::block>> rep_votes;
+	// Weight each representative's current vote was counted with
+	std::unordered_map<rai::account, rai::uint128_t> rep_weights;
+	// Running weight and voter count for each block voted on
+	std::unordered_map<std::shared_ptr<rai::block>, std::pair<rai::uint128_t, size_t>, rai::shared_ptr_block_hash, rai::shared_ptr_block_hash> totals;
+
+private:
+	void tally_add (rai::account const &, std::shared_ptr<rai::block>, rai::uint128_t const &);
+	void tally_remove (rai::account const &, std::shared_ptr<rai::block>);
 };
 extern rai::keypair const & zero_key;
 extern rai::keypair const & test_genesis_key;
@@ -390,23 +390,61 @@ TEST (state_block, hashing)
 	rai::state_block block (key.pub, 0, key.pub, 0, 0, key.prv, key.pub, 0);
 	auto hash (block.hash ());
 	block.hashables.account.bytes[0] ^= 0x1;
+	block.refresh ();
 	ASSERT_NE (hash, block.hash ());
 	block.hashables.account.bytes[0] ^= 0x1;
+	block.refresh ();
 	ASSERT_EQ (hash, block.hash ());
 	block.hashables.previous.bytes[0] ^= 0x1;
+	block.refresh ();
 	ASSERT_NE (hash, block.hash ());
 	block.hashables.previous.bytes[0] ^= 0x1;
+	block.refresh ();
 	ASSERT_EQ (hash, block.hash ());
 	block.hashables.representative.bytes[0] ^= 0x1;
+	block.refresh ();
 	ASSERT_NE (hash, block.hash ());
 	block.hashables.representative.bytes[0] ^= 0x1;
+	block.refresh ();
 	ASSERT_EQ (hash, block.hash ());
 	block.hashables.balance.bytes[0] ^= 0x1;
+	block.refresh ();
 	ASSERT_NE (hash, block.hash ());
 	block.hashables.balance.bytes[0] ^= 0x1;
+	block.refresh ();
 	ASSERT_EQ (hash, block.hash ());
 	block.hashables.link.bytes[0] ^= 0x1;
+	block.refresh ();
 	ASSERT_NE (hash, block.hash ());
 	block.hashables.link.bytes[0] ^= 0x1;
+	block.refresh ();
 	ASSERT_EQ (hash, block.hash ());
 }
+
+TEST (block, hash_cache)
+{
+	rai::keypair key;
+	rai::state_block block (key.pub, 0, key.pub, 0, 0, key.prv, key.pub, 0);
+	auto hash (block.hash ());
+	auto hits (rai::block::hash_cache_hits);
+	ASSERT_EQ (hash, block.hash ());
+	ASSERT_EQ (hits + 1, rai::block::hash_cache_hits);
+	// Copies carry the cached hash along
+	rai::state_block block2 (block);
+	ASSERT_EQ (hash, block2.hash ());
+	// Hashables modified in place aren't seen until the cache is dropped
+	block2.hashables.balance = 1;
+	ASSERT_EQ (hash, block2.hash ());
+	block2.refresh ();
+	ASSERT_NE (hash, block2.hash ());
+	ASSERT_EQ (hash, block.hash ());
+	// Deserializing in place replaces the cached hash
+	std::vector<uint8_t> bytes;
+	{
+		rai::vectorstream stream (bytes);
+		block.serialize (stream);
+	}
+	rai::bufferstream stream (bytes.data (), bytes.size ());
+	ASSERT_FALSE (block2.deserialize (stream));
+	ASSERT_EQ (hash, block2.hash ());
+}
@@ -36,6 +36,45 @@ TEST (block_store, add_item)
 	ASSERT_EQ (nullptr, latest3);
 }
 
+TEST (block_store, block_view)
+{
+	bool init (false);
+	rai::block_store store (init, rai::unique_path ());
+	ASSERT_TRUE (!init);
+	rai::keypair key1;
+	rai::send_block send (1, 2, 3, key1.prv, key1.pub, 4);
+	rai::receive_block receive (5, 6, key1.prv, key1.pub, 7);
+	rai::open_block open (8, 9, 10, key1.prv, key1.pub, 11);
+	rai::change_block change (12, 13, key1.prv, key1.pub, 14);
+	rai::state_block state (15, 16, 17, 18, 19, key1.prv, key1.pub, 20);
+	std::vector<rai::block *> blocks ({ &send, &receive, &open, &change, &state });
+	rai::transaction transaction (store.environment, nullptr, true);
+	ASSERT_EQ (rai::block_type::invalid, store.block_get_view (transaction, send.hash ()).type);
+	for (auto i : blocks)
+	{
+		store.block_put (transaction, i->hash (), *i, 21);
+	}
+	for (auto i : blocks)
+	{
+		auto view (store.block_get_view (transaction, i->hash ()));
+		ASSERT_EQ (i->type (), view.type);
+		ASSERT_EQ (i->hash (), view.hash ());
+		ASSERT_EQ (i->previous (), view.previous ());
+		ASSERT_EQ (i->source (), view.source ());
+		ASSERT_EQ (i->root (), view.root ());
+		ASSERT_EQ (i->representative (), view.representative ());
+		ASSERT_EQ (rai::block_hash (21), view.successor ());
+		ASSERT_EQ (*i, *view.block ());
+	}
+	ASSERT_EQ (send.hashables.destination, store.block_get_view (transaction, send.hash ()).destination ());
+	ASSERT_EQ (send.hashables.balance, store.block_get_view (transaction, send.hash ()).balance ());
+	ASSERT_EQ (open.hashables.account, store.block_get_view (transaction, open.hash ()).account ());
+	ASSERT_EQ (state.hashables.account, store.block_get_view (transaction, state.hash ()).account ());
+	ASSERT_EQ (state.hashables.balance, store.block_get_view (transaction, state.hash ()).balance ());
+	ASSERT_EQ (state.hashables.link, store.block_get_view (transaction, state.hash ()).link ());
+	ASSERT_TRUE (store.block_get_view (transaction, change.hash ()).account ().is_zero ());
+}
+
 TEST (block_store, add_nonempty_block)
 {
 	bool init (false);
@@ -68,6 +107,7 @@ TEST (block_store, add_two_items)
 	ASSERT_EQ (nullptr, latest1);
 	rai::open_block block2 (0, 1, 3, rai::keypair ().prv, 0, 0);
 	block2.hashables.account = 3;
+	block2.refresh ();
 	rai::uint256_union hash2 (block2.hash ());
 	block2.signature = rai::sign_message (key1.prv, key1.pub, hash2);
 	auto latest2 (store.block_get (transaction, hash2));
@@ -350,6 +390,7 @@ TEST (block_store, two_block)
 	ASSERT_TRUE (!init);
 	rai::open_block block1 (0, 1, 1, rai::keypair ().prv, 0, 0);
 	block1.hashables.account = 1;
+	block1.refresh ();
 	std::vector<rai::block_hash> hashes;
 	std::vector<rai::open_block> blocks;
 	hashes.push_back (block1.hash ());
@@ -560,6 +601,119 @@ TEST (block_store, account_count)
 	ASSERT_EQ (1, store.account_count (rai::transaction (store.environment, nullptr, false)));
 }
 
+TEST (block_store, counters)
+{
+	auto path (rai::unique_path ());
+	rai::open_block block1 (0, 1, 0, rai::keypair ().prv, 0, 0);
+	rai::send_block block2 (block1.hash (), 1, 2, rai::keypair ().prv, 4, 5);
+	{
+		bool init (false);
+		rai::block_store store (init, path);
+		ASSERT_FALSE (init);
+		rai::transaction transaction (store.environment, nullptr, true);
+		store.block_put (transaction, block1.hash (), block1);
+		store.block_put (transaction, block2.hash (), block2);
+		// Rewriting an existing block or account doesn't add to the counts
+		store.block_put (transaction, block2.hash (), block2);
+		store.account_put (transaction, 200, rai::account_info ());
+		store.account_put (transaction, 200, rai::account_info ());
+		store.account_put (transaction, 300, rai::account_info ());
+		store.pending_put (transaction, rai::pending_key (200, 1), rai::pending_info (300, 10));
+		store.pending_put (transaction, rai::pending_key (200, 1), rai::pending_info (300, 10));
+		store.unchecked_put (transaction, block1.hash (), std::make_shared<rai::send_block> (block2));
+		store.flush (transaction);
+		store.unchecked_put (transaction, block1.hash (), std::make_shared<rai::send_block> (block2));
+		store.flush (transaction);
+		auto counts (store.block_count (transaction));
+		ASSERT_EQ (1, counts.open);
+		ASSERT_EQ (1, counts.send);
+		ASSERT_EQ (2, store.account_count (transaction));
+		ASSERT_EQ (1, store.pending_count (transaction));
+		ASSERT_EQ (1, store.unchecked_count (transaction));
+		store.block_del (transaction, block2.hash ());
+		store.account_del (transaction, 300);
+		store.unchecked_del (transaction, block1.hash (), block2);
+		ASSERT_EQ (1, store.block_count (transaction).sum ());
+		ASSERT_EQ (1, store.account_count (transaction));
+		ASSERT_EQ (0, store.unchecked_count (transaction));
+	}
+	bool init (false);
+	rai::block_store store (init, path);
+	ASSERT_FALSE (init);
+	rai::transaction transaction (store.environment, nullptr, false);
+	ASSERT_EQ (1, store.block_count (transaction).open);
+	ASSERT_EQ (1, store.block_count (transaction).sum ());
+	ASSERT_EQ (1, store.account_count (transaction));
+	ASSERT_EQ (1, store.pending_count (transaction));
+	ASSERT_EQ (0, store.unchecked_count (transaction));
+}
+
+TEST (block_store, unchecked_spill)
+{
+	bool init (false);
+	rai::block_store store (init, rai::unique_path ());
+	ASSERT_FALSE (init);
+	store.unchecked_cache_max = 1;
+	rai::transaction transaction (store.environment, nullptr, true);
+	auto send1 (std::make_shared<rai::send_block> (0, 0, 0, rai::test_genesis_key.prv, rai::test_genesis_key.pub, 0));
+	auto send2 (std::make_shared<rai::send_block> (1, 0, 0, rai::test_genesis_key.prv, rai::test_genesis_key.pub, 0));
+	store.unchecked_put (transaction, send1->hash (), send1);
+	ASSERT_EQ (0, store.unchecked_count (transaction));
+	// Exceeding the cache budget writes the cache through to disk
+	store.unchecked_put (transaction, send1->hash (), send2);
+	ASSERT_EQ (2, store.unchecked_count (transaction));
+	ASSERT_TRUE (store.unchecked_cache.empty ());
+	ASSERT_EQ (2, store.unchecked_get (transaction, send1->hash ()).size ());
+	store.unchecked_del (transaction, send1->hash (), *send2);
+	auto blocks (store.unchecked_get (transaction, send1->hash ()));
+	ASSERT_EQ (1, blocks.size ());
+	ASSERT_EQ (*send1, *blocks[0]);
+}
+
+TEST (block_store, unchecked_cleanup)
+{
+	bool init (false);
+	rai::block_store store (init, rai::unique_path ());
+	ASSERT_FALSE (init);
+	rai::transaction transaction (store.environment, nullptr, true);
+	auto send1 (std::make_shared<rai::send_block> (0, 0, 0, rai::test_genesis_key.prv, rai::test_genesis_key.pub, 0));
+	store.unchecked_put (transaction, send1->hash (), send1);
+	store.flush (transaction);
+	ASSERT_EQ (1, store.unchecked_count (transaction));
+	auto now (std::chrono::duration_cast<std::chrono::seconds> (std::chrono::system_clock::now ().time_since_epoch ()).count ());
+	rai::block_hash cursor (0);
+	ASSERT_EQ (0, store.unchecked_cleanup (transaction, now - 60, cursor, 16));
+	ASSERT_TRUE (cursor.is_zero ());
+	ASSERT_EQ (1, store.unchecked_count (transaction));
+	ASSERT_EQ (1, store.unchecked_cleanup (transaction, now + 60, cursor, 16));
+	ASSERT_EQ (0, store.unchecked_count (transaction));
+	ASSERT_EQ (store.unchecked_end (), store.unchecked_begin (transaction));
+}
+
+// A sweep limited to fewer entries than the table holds resumes where the last pass stopped
+TEST (block_store, unchecked_cleanup_resume)
+{
+	bool init (false);
+	rai::block_store store (init, rai::unique_path ());
+	ASSERT_FALSE (init);
+	rai::transaction transaction (store.environment, nullptr, true);
+	for (auto i (1); i <= 3; ++i)
+	{
+		auto send (std::make_shared<rai::send_block> (i, 0, 0, rai::test_genesis_key.prv, rai::test_genesis_key.pub, 0));
+		store.unchecked_put (transaction, send->previous (), send);
+	}
+	store.flush (transaction);
+	ASSERT_EQ (3, store.unchecked_count (transaction));
+	auto now (std::chrono::duration_cast<std::chrono::seconds> (std::chrono::system_clock::now ().time_since_epoch ()).count ());
+	rai::block_hash cursor (0);
+	ASSERT_EQ (2, store.unchecked_cleanup (transaction, now + 60, cursor, 2));
+	ASSERT_EQ (rai::block_hash (3), cursor);
+	ASSERT_EQ (1, store.unchecked_count (transaction));
+	ASSERT_EQ (1, store.unchecked_cleanup (transaction, now + 60, cursor, 2));
+	ASSERT_TRUE (cursor.is_zero ());
+	ASSERT_EQ (0, store.unchecked_count (transaction));
+}
+
 TEST (block_store, sequence_increment)
 {
 	bool init (false);
@@ -929,6 +1083,125 @@ TEST (block_store, upgrade_v9_v10)
 	ASSERT_EQ (block_info.balance.number (), rai::genesis_amount - rai::kBDM_ratio * 31);
 }
 
+TEST (block_store, upgrade_v11_v12)
+{
+	auto path (rai::unique_path ());
+	rai::keypair key1;
+	{
+		bool init (false);
+		rai::block_store store (init, path);
+		ASSERT_FALSE (init);
+		rai::transaction transaction (store.environment, nullptr, true);
+		rai::genesis genesis;
+		genesis.initialize (transaction, store);
+		store.account_put (transaction, key1.pub, rai::account_info (0, 0, 0, 100, 0, 1));
+		ASSERT_EQ (0, mdb_drop (transaction, store.balances, 0));
+		store.version_put (transaction, 11);
+	}
+	bool init (false);
+	rai::block_store store (init, path);
+	ASSERT_FALSE (init);
+	rai::transaction transaction (store.environment, nullptr, false);
+	ASSERT_LT (11, store.version_get (transaction));
+	auto i (store.balance_begin (transaction));
+	ASSERT_NE (store.balance_end (), i);
+	ASSERT_EQ (rai::balance_key (std::numeric_limits<rai::uint128_t>::max (), rai::test_genesis_key.pub), rai::balance_key (i->first));
+	++i;
+	ASSERT_NE (store.balance_end (), i);
+	ASSERT_EQ (rai::balance_key (100, key1.pub), rai::balance_key (i->first));
+	++i;
+	ASSERT_EQ (store.balance_end (), i);
+}
+
+TEST (block_store, balance_index)
+{
+	bool init (false);
+	rai::block_store store (init, rai::unique_path ());
+	ASSERT_FALSE (init);
+	rai::transaction transaction (store.environment, nullptr, true);
+	rai::genesis genesis;
+	genesis.initialize (transaction, store);
+	rai::stat stats;
+	rai::ledger ledger (store, stats);
+	rai::keypair key1;
+	rai::send_block send (genesis.hash (), key1.pub, rai::genesis_amount - 100, rai::test_genesis_key.prv, rai::test_genesis_key.pub, 0);
+	ASSERT_EQ (rai::process_result::progress, ledger.process (transaction, send).code);
+	rai::open_block open (send.hash (), key1.pub, key1.pub, key1.prv, key1.pub, 0);
+	ASSERT_EQ (rai::process_result::progress, ledger.process (transaction, open).code);
+	auto i (store.balance_begin (transaction));
+	ASSERT_EQ (rai::balance_key (rai::genesis_amount - 100, rai::test_genesis_key.pub), rai::balance_key (i->first));
+	++i;
+	ASSERT_EQ (rai::balance_key (100, key1.pub), rai::balance_key (i->first));
+	++i;
+	ASSERT_EQ (store.balance_end (), i);
+	ledger.rollback (transaction, open.hash ());
+	auto j (store.balance_begin (transaction));
+	ASSERT_EQ (rai::balance_key (rai::genesis_amount - 100, rai::test_genesis_key.pub), rai::balance_key (j->first));
+	++j;
+	ASSERT_EQ (store.balance_end (), j);
+}
+
+TEST (block_store, upgrade_v12_v13)
+{
+	auto path (rai::unique_path ());
+	rai::keypair key1;
+	{
+		bool init (false);
+		rai::block_store store (init, path);
+		ASSERT_FALSE (init);
+		rai::transaction transaction (store.environment, nullptr, true);
+		rai::genesis genesis;
+		genesis.initialize (transaction, store);
+		store.pending_put (transaction, rai::pending_key (key1.pub, 1), rai::pending_info (rai::test_genesis_key.pub, 100));
+		store.pending_put (transaction, rai::pending_key (key1.pub, 2), rai::pending_info (rai::test_genesis_key.pub, 200));
+		ASSERT_EQ (0, mdb_drop (transaction, store.pending_totals, 0));
+		store.version_put (transaction, 12);
+	}
+	bool init (false);
+	rai::block_store store (init, path);
+	ASSERT_FALSE (init);
+	rai::transaction transaction (store.environment, nullptr, false);
+	ASSERT_LT (12, store.version_get (transaction));
+	ASSERT_EQ (rai::pending_totals (300, 2), store.pending_totals_get (transaction, key1.pub));
+	ASSERT_EQ (rai::pending_totals (), store.pending_totals_get (transaction, rai::test_genesis_key.pub));
+}
+
+TEST (block_store, pending_totals)
+{
+	bool init (false);
+	rai::block_store store (init, rai::unique_path ());
+	ASSERT_FALSE (init);
+	rai::transaction transaction (store.environment, nullptr, true);
+	rai::keypair key1;
+	rai::keypair key2;
+	store.pending_put (transaction, rai::pending_key (key1.pub, 1), rai::pending_info (key2.pub, 5));
+	store.pending_put (transaction, rai::pending_key (key1.pub, 2), rai::pending_info (key2.pub, 1000));
+	store.pending_put (transaction, rai::pending_key (key1.pub, 3), rai::pending_info (key2.pub, 7));
+	store.pending_put (transaction, rai::pending_key (key2.pub, 4), rai::pending_info (key1.pub, 2000));
+	ASSERT_EQ (rai::pending_totals (1012, 3), store.pending_totals_get (transaction, key1.pub));
+	store.pending_put (transaction, rai::pending_key (key1.pub, 3), rai::pending_info (key2.pub, 8));
+	ASSERT_EQ (rai::pending_totals (1013, 3), store.pending_totals_get (transaction, key1.pub));
+	rai::pending_iterator i (transaction, store, key1.pub, 10);
+	ASSERT_FALSE (i.done ());
+	ASSERT_EQ (rai::pending_key (key1.pub, 2), i.key ());
+	ASSERT_EQ (rai::pending_info (key2.pub, 1000), i.info ());
+	++i;
+	ASSERT_TRUE (i.done ());
+	size_t all (0);
+	for (rai::pending_iterator j (transaction, store, key1.pub); !j.done (); ++j)
+	{
+		++all;
+	}
+	ASSERT_EQ (3, all);
+	store.pending_del (transaction, rai::pending_key (key1.pub, 2));
+	ASSERT_EQ (rai::pending_totals (13, 2), store.pending_totals_get (transaction, key1.pub));
+	ASSERT_TRUE (rai::pending_iterator (transaction, store, key1.pub, 10).done ());
+	store.pending_del (transaction, rai::pending_key (key1.pub, 1));
+	store.pending_del (transaction, rai::pending_key (key1.pub, 3));
+	ASSERT_EQ (rai::pending_totals (), store.pending_totals_get (transaction, key1.pub));
+	ASSERT_EQ (rai::pending_totals (2000, 1), store.pending_totals_get (transaction, key2.pub));
+}
+
 TEST (block_store, state_block)
 {
 	bool error (false);
@@ -952,3 +1225,57 @@ TEST (block_store, state_block)
 	auto count2 (store.block_count (transaction));
 	ASSERT_EQ (0, count2.state);
 }
+
+TEST (block_store, representation_cache)
+{
+	auto path (rai::unique_path ());
+	rai::account rep1 (1);
+	rai::account rep2 (2);
+	{
+		bool init (false);
+		rai::block_store store (init, path);
+		ASSERT_FALSE (init);
+		rai::transaction transaction (store.environment, nullptr, true);
+		store.representation_put (transaction, rep1, 100);
+		store.representation_put (transaction, rep2, 200);
+		ASSERT_EQ (100, store.representation_get (transaction, rep1));
+		store.representation_put (transaction, rep2, 0);
+		ASSERT_EQ (0, store.representation_get (transaction, rep2));
+		ASSERT_EQ (store.representation_cache.end (), store.representation_cache.find (rep2));
+	}
+	// Weights are loaded back from the representation table on open
+	bool init (false);
+	rai::block_store store (init, path);
+	ASSERT_FALSE (init);
+	rai::transaction transaction (store.environment, nullptr, false);
+	ASSERT_EQ (100, store.representation_get (transaction, rep1));
+	ASSERT_EQ (0, store.representation_get (transaction, rep2));
+	ASSERT_EQ (1, store.representation_cache.size ());
+}
+
+TEST (block_store, bootstrap_scores)
+{
+	bool init (false);
+	rai::block_store store (init, rai::unique_path ());
+	ASSERT_FALSE (init);
+	rai::transaction transaction (store.environment, nullptr, true);
+	rai::endpoint_key key1 (boost::asio::ip::address_v6::loopback ().to_bytes (), 10000);
+	rai::endpoint_key key2 (boost::asio::ip::address_v6::loopback ().to_bytes (), 10001);
+	rai::bootstrap_score score1;
+	score1.completed (std::chrono::milliseconds (10), 1000, 100.0);
+	rai::bootstrap_score score2;
+	score2.failed ();
+	store.bootstrap_score_put (transaction, key1, score1);
+	store.bootstrap_score_put (transaction, key2, score2);
+	store.bootstrap_score_del (transaction, key2);
+	auto i (store.bootstrap_score_begin (transaction));
+	ASSERT_NE (store.bootstrap_score_end (), i);
+	ASSERT_EQ (key1, rai::endpoint_key (i->first));
+	rai::bootstrap_score score3;
+	rai::bufferstream stream (reinterpret_cast<uint8_t const *> (i->second.data ()), i->second.size ());
+	ASSERT_FALSE (score3.deserialize (stream));
+	ASSERT_EQ (score1.score (), score3.score ());
+	ASSERT_EQ (1, score3.attempts);
+	++i;
+	ASSERT_EQ (store.bootstrap_score_end (), i);
+}
@@ -1,8 +1,12 @@
 #include <cryptopp/filters.h>
 #include <cryptopp/randpool.h>
 #include <gtest/gtest.h>
+#include <badem/ledger_validator.hpp>
 #include <badem/node/stats.hpp>
 #include <badem/node/testing.hpp>
+#include <badem/snapshot.hpp>
+
+#include <sstream>
 
 // Init returns an error if it can't open files at the path
 TEST (ledger, store_error)
@@ -873,6 +877,45 @@ TEST (votes, add_existing)
 	ASSERT_EQ (*send2, *winner.second);
 }
 
+// Running totals agree with a full recount as votes are added and changed
+TEST (votes, tally_incremental)
+{
+	rai::system system (24000, 1);
+	auto & node1 (*system.nodes[0]);
+	rai::genesis genesis;
+	rai::keypair key1;
+	auto send1 (std::make_shared<rai::send_block> (genesis.hash (), key1.pub, rai::genesis_amount - 100, rai::test_genesis_key.prv, rai::test_genesis_key.pub, 0));
+	rai::keypair key2;
+	auto send2 (std::make_shared<rai::send_block> (genesis.hash (), key2.pub, 0, rai::test_genesis_key.prv, rai::test_genesis_key.pub, 0));
+	rai::transaction transaction (node1.store.environment, nullptr, true);
+	ASSERT_EQ (rai::process_result::progress, node1.ledger.process (transaction, *send1).code);
+	node1.store.representation_put (transaction, key2.pub, 100);
+	auto weight1 (node1.ledger.weight (transaction, rai::test_genesis_key.pub));
+	rai::votes votes1 (send1);
+	ASSERT_EQ (node1.ledger.tally (transaction, votes1), votes1.tally ());
+	auto vote1 (std::make_shared<rai::vote> (rai::test_genesis_key.pub, rai::test_genesis_key.prv, 1, send1));
+	ASSERT_EQ (rai::tally_result::vote, votes1.vote (vote1, weight1));
+	auto vote2 (std::make_shared<rai::vote> (key2.pub, key2.prv, 1, send2));
+	ASSERT_EQ (rai::tally_result::vote, votes1.vote (vote2, 100));
+	auto tally1 (votes1.tally ());
+	ASSERT_EQ (node1.ledger.tally (transaction, votes1), tally1);
+	ASSERT_EQ (2, tally1.size ());
+	ASSERT_EQ (*send1, *tally1.begin ()->second);
+	ASSERT_EQ (weight1, tally1.begin ()->first);
+	// Changing a vote moves its weight to the new block
+	auto vote3 (std::make_shared<rai::vote> (rai::test_genesis_key.pub, rai::test_genesis_key.prv, 2, send2));
+	ASSERT_EQ (rai::tally_result::changed, votes1.vote (vote3, weight1));
+	auto tally2 (votes1.tally ());
+	ASSERT_EQ (node1.ledger.tally (transaction, votes1), tally2);
+	ASSERT_EQ (2, tally2.size ());
+	ASSERT_EQ (*send2, *tally2.begin ()->second);
+	ASSERT_EQ (weight1 + 100, tally2.begin ()->first);
+	// Repeating a vote recounts it with the weight it now carries
+	ASSERT_EQ (rai::tally_result::confirm, votes1.vote (vote2, 50));
+	ASSERT_EQ (weight1 + 50, votes1.tally ().begin ()->first);
+	ASSERT_EQ (3, votes1.rep_weights.size ());
+}
+
 // Lower sequence numbers are ignored
 TEST (votes, add_old)
 {
@@ -2269,3 +2312,254 @@ TEST (ledger, state_canary_blocks)
 	ASSERT_TRUE (ledger.state_block_parsing_enabled (transaction));
 	ASSERT_TRUE (ledger.state_block_generation_enabled (transaction));
 }
+
+TEST (snapshot, round_trip)
+{
+	bool init (false);
+	rai::block_store store1 (init, rai::unique_path ());
+	ASSERT_FALSE (init);
+	rai::stat stats;
+	rai::ledger ledger1 (store1, stats);
+	rai::work_pool pool (std::numeric_limits<unsigned>::max (), nullptr);
+	rai::genesis genesis;
+	rai::keypair key;
+	rai::send_block send1 (genesis.hash (), key.pub, rai::genesis_amount - 100, rai::test_genesis_key.prv, rai::test_genesis_key.pub, pool.generate (genesis.hash ()));
+	rai::open_block open (send1.hash (), key.pub, key.pub, key.prv, key.pub, pool.generate (key.pub));
+	rai::state_block send2 (rai::test_genesis_key.pub, send1.hash (), rai::test_genesis_key.pub, rai::genesis_amount - 300, key.pub, rai::test_genesis_key.prv, rai::test_genesis_key.pub, pool.generate (send1.hash ()));
+	std::stringstream stream;
+	{
+		rai::transaction transaction (store1.environment, nullptr, true);
+		genesis.initialize (transaction, store1);
+		ASSERT_EQ (rai::process_result::progress, ledger1.process (transaction, send1).code);
+		ASSERT_EQ (rai::process_result::progress, ledger1.process (transaction, open).code);
+		ASSERT_EQ (rai::process_result::progress, ledger1.process (transaction, send2).code);
+		rai::snapshot snapshot (ledger1);
+		// Cut a chunk after every block so chains carry on across chunks
+		snapshot.chunk_size = 1;
+		ASSERT_FALSE (snapshot.write (transaction, stream));
+		ASSERT_EQ (2, snapshot.accounts);
+		ASSERT_EQ (4, snapshot.blocks);
+		ASSERT_EQ (1, snapshot.pending);
+	}
+	rai::block_store store2 (init, rai::unique_path ());
+	ASSERT_FALSE (init);
+	rai::ledger ledger2 (store2, stats);
+	rai::transaction transaction1 (store1.environment, nullptr, false);
+	rai::transaction transaction2 (store2.environment, nullptr, true);
+	genesis.initialize (transaction2, store2);
+	rai::snapshot snapshot (ledger2, 2);
+	ASSERT_FALSE (snapshot.read (transaction2, stream));
+	for (auto account : { rai::test_genesis_key.pub, key.pub })
+	{
+		rai::account_info info1;
+		rai::account_info info2;
+		ASSERT_FALSE (store1.account_get (transaction1, account, info1));
+		ASSERT_FALSE (store2.account_get (transaction2, account, info2));
+		ASSERT_EQ (info1, info2);
+		ASSERT_EQ (store1.representation_get (transaction1, account), store2.representation_get (transaction2, account));
+	}
+	rai::checksum checksum1;
+	rai::checksum checksum2;
+	ASSERT_FALSE (store1.checksum_get (transaction1, 0, 0, checksum1));
+	ASSERT_FALSE (store2.checksum_get (transaction2, 0, 0, checksum2));
+	ASSERT_EQ (checksum1, checksum2);
+	ASSERT_EQ (send1.hash (), store2.block_successor (transaction2, genesis.hash ()));
+	ASSERT_EQ (send2.hash (), store2.block_successor (transaction2, send1.hash ()));
+	ASSERT_TRUE (store2.frontier_get (transaction2, genesis.hash ()).is_zero ());
+	ASSERT_EQ (key.pub, store2.frontier_get (transaction2, open.hash ()));
+	ASSERT_EQ (200, ledger2.account_pending (transaction2, key.pub));
+	ASSERT_EQ (store1.block_count (transaction1).sum (), store2.block_count (transaction2).sum ());
+	// Only a ledger holding nothing but genesis accepts a snapshot
+	stream.clear ();
+	stream.seekg (0);
+	ASSERT_TRUE (snapshot.read (transaction2, stream));
+}
+
+// A damaged snapshot is rejected before anything is written
+TEST (snapshot, corrupt)
+{
+	bool init (false);
+	rai::block_store store1 (init, rai::unique_path ());
+	ASSERT_FALSE (init);
+	rai::stat stats;
+	rai::ledger ledger1 (store1, stats);
+	rai::work_pool pool (std::numeric_limits<unsigned>::max (), nullptr);
+	rai::genesis genesis;
+	rai::keypair key;
+	rai::send_block send1 (genesis.hash (), key.pub, rai::genesis_amount - 100, rai::test_genesis_key.prv, rai::test_genesis_key.pub, pool.generate (genesis.hash ()));
+	std::stringstream stream1;
+	{
+		rai::transaction transaction (store1.environment, nullptr, true);
+		genesis.initialize (transaction, store1);
+		ASSERT_EQ (rai::process_result::progress, ledger1.process (transaction, send1).code);
+		rai::snapshot snapshot (ledger1);
+		ASSERT_FALSE (snapshot.write (transaction, stream1));
+	}
+	auto contents (stream1.str ());
+	// Inside the end chunk's payload
+	contents[contents.size () - 40] ^= 1;
+	std::stringstream stream2 (contents);
+	rai::block_store store2 (init, rai::unique_path ());
+	ASSERT_FALSE (init);
+	rai::ledger ledger2 (store2, stats);
+	rai::transaction transaction (store2.environment, nullptr, true);
+	genesis.initialize (transaction, store2);
+	rai::snapshot snapshot (ledger2);
+	ASSERT_TRUE (snapshot.read (transaction, stream2));
+	ASSERT_EQ (1, store2.block_count (transaction).sum ());
+	ASSERT_EQ (genesis.hash (), ledger2.latest (transaction, rai::test_genesis_key.pub));
+	// A chunk claiming a payload past chunk_max is refused before anything is allocated for it
+	auto header (contents.substr (0, 8 + sizeof (uint32_t) + sizeof (uint8_t) + sizeof (rai::block_hash)));
+	header.push_back (static_cast<char> (rai::snapshot_chunk::accounts));
+	header.append (4, static_cast<char> (0xff));
+	std::stringstream stream3 (header);
+	ASSERT_TRUE (snapshot.read (transaction, stream3));
+}
+
+// Well formed snapshots whose tables don't agree with their blocks are rejected and leave the ledger as it was
+TEST (snapshot, inconsistent)
+{
+	rai::work_pool pool (std::numeric_limits<unsigned>::max (), nullptr);
+	rai::genesis genesis;
+	rai::keypair key;
+	rai::send_block send1 (genesis.hash (), key.pub, rai::genesis_amount - 100, rai::test_genesis_key.prv, rai::test_genesis_key.pub, pool.generate (genesis.hash ()));
+	rai::stat stats;
+	for (auto tamper : { 0, 1 })
+	{
+		bool init (false);
+		rai::block_store store1 (init, rai::unique_path ());
+		ASSERT_FALSE (init);
+		rai::ledger ledger1 (store1, stats);
+		std::stringstream stream;
+		{
+			rai::transaction transaction (store1.environment, nullptr, true);
+			genesis.initialize (transaction, store1);
+			ASSERT_EQ (rai::process_result::progress, ledger1.process (transaction, send1).code);
+			if (tamper == 0)
+			{
+				// A balance the chain doesn't add up to
+				rai::account_info info;
+				ASSERT_FALSE (store1.account_get (transaction, rai::test_genesis_key.pub, info));
+				info.balance = rai::genesis_amount - 50;
+				store1.account_put (transaction, rai::test_genesis_key.pub, info);
+			}
+			else
+			{
+				// The send's amount vanishes from the supply
+				store1.pending_del (transaction, rai::pending_key (key.pub, send1.hash ()));
+			}
+			rai::snapshot snapshot (ledger1);
+			ASSERT_FALSE (snapshot.write (transaction, stream));
+		}
+		rai::block_store store2 (init, rai::unique_path ());
+		ASSERT_FALSE (init);
+		rai::ledger ledger2 (store2, stats);
+		rai::transaction transaction (store2.environment, nullptr, true);
+		genesis.initialize (transaction, store2);
+		rai::snapshot snapshot (ledger2);
+		ASSERT_TRUE (snapshot.read (transaction, stream));
+		ASSERT_EQ (1, store2.block_count (transaction).sum ());
+		ASSERT_EQ (1, store2.account_count (transaction));
+		ASSERT_EQ (0, store2.pending_count (transaction));
+		ASSERT_EQ (genesis.hash (), ledger2.latest (transaction, rai::test_genesis_key.pub));
+		ASSERT_EQ (rai::genesis_amount, ledger2.weight (transaction, rai::test_genesis_key.pub));
+	}
+}
+
+TEST (ledger_validator, consistent)
+{
+	bool init (false);
+	rai::block_store store (init, rai::unique_path ());
+	ASSERT_FALSE (init);
+	rai::stat stats;
+	rai::ledger ledger (store, stats);
+	rai::genesis genesis;
+	rai::keypair key1;
+	rai::keypair key2;
+	rai::send_block send1 (genesis.hash (), key1.pub, rai::genesis_amount - 100, rai::test_genesis_key.prv, rai::test_genesis_key.pub, 0);
+	rai::open_block open (send1.hash (), key2.pub, key1.pub, key1.prv, key1.pub, 0);
+	rai::state_block send2 (rai::test_genesis_key.pub, send1.hash (), rai::test_genesis_key.pub, rai::genesis_amount - 300, key2.pub, rai::test_genesis_key.prv, rai::test_genesis_key.pub, 0);
+	{
+		rai::transaction transaction (store.environment, nullptr, true);
+		genesis.initialize (transaction, store);
+		ASSERT_EQ (rai::process_result::progress, ledger.process (transaction, send1).code);
+		ASSERT_EQ (rai::process_result::progress, ledger.process (transaction, open).code);
+		ASSERT_EQ (rai::process_result::progress, ledger.process (transaction, send2).code);
+	}
+	rai::ledger_validator validator (ledger, 4);
+	ASSERT_FALSE (validator.validate ());
+	ASSERT_EQ (0, validator.failures);
+	ASSERT_EQ (2, validator.accounts);
+	ASSERT_EQ (4, validator.blocks);
+	ASSERT_EQ (1, validator.pending);
+	rai::checksum checksum (send2.hash ());
+	checksum ^= open.hash ();
+	ASSERT_EQ (checksum, validator.checksum);
+}
+
+TEST (ledger_validator, inconsistent)
+{
+	bool init (false);
+	rai::block_store store (init, rai::unique_path ());
+	ASSERT_FALSE (init);
+	rai::stat stats;
+	rai::ledger ledger (store, stats);
+	rai::genesis genesis;
+	rai::keypair key1;
+	rai::send_block send1 (genesis.hash (), key1.pub, rai::genesis_amount - 100, rai::test_genesis_key.prv, rai::test_genesis_key.pub, 0);
+	{
+		rai::transaction transaction (store.environment, nullptr, true);
+		genesis.initialize (transaction, store);
+		ASSERT_EQ (rai::process_result::progress, ledger.process (transaction, send1).code);
+		// Weight delegated to nobody and a balance the chain doesn't add up to
+		store.representation_put (transaction, key1.pub, 100);
+		rai::account_info info;
+		ASSERT_FALSE (store.account_get (transaction, rai::test_genesis_key.pub, info));
+		info.balance = rai::genesis_amount - 50;
+		store.account_put (transaction, rai::test_genesis_key.pub, info);
+	}
+	rai::ledger_validator validator (ledger, 2);
+	ASSERT_TRUE (validator.validate ());
+	// Balance mismatch, missing balance index entry, genesis weight no longer matching the balance and the stray weight
+	ASSERT_EQ (4, validator.failures);
+	ASSERT_EQ (validator.failures, validator.errors.size ());
+}
+
+TEST (benchmark_ledger, replay)
+{
+	rai::work_pool pool (std::numeric_limits<unsigned>::max (), nullptr);
+	rai::benchmark_ledger ledger1 (7, 10, 5, 50, 50);
+	ASSERT_FALSE (ledger1.generate (pool));
+	// Funding sends, opens and the requested activity
+	ASSERT_EQ (10 + 10 + 10 * 5, ledger1.blocks.size ());
+	rai::benchmark_ledger ledger2 (7, 10, 5, 50, 50);
+	ASSERT_FALSE (ledger2.generate (pool));
+	// A lone account has nobody to send to so only its open can be generated
+	ASSERT_TRUE (rai::benchmark_ledger (7, 1, 5, 50, 50).generate (pool));
+	ASSERT_FALSE (rai::benchmark_ledger (7, 1, 0, 50, 50).generate (pool));
+	ASSERT_EQ (ledger1.blocks.size (), ledger2.blocks.size ());
+	for (size_t i (0); i < ledger1.blocks.size (); ++i)
+	{
+		ASSERT_EQ (*ledger1.blocks[i], *ledger2.blocks[i]);
+	}
+	std::stringstream stream;
+	ledger1.serialize (stream);
+	rai::benchmark_ledger ledger3;
+	ASSERT_FALSE (ledger3.deserialize (stream));
+	ASSERT_EQ (10, ledger3.accounts);
+	ASSERT_EQ (5, ledger3.length);
+	ASSERT_EQ (ledger1.blocks.size (), ledger3.blocks.size ());
+	bool init (false);
+	rai::block_store store (init, rai::unique_path ());
+	ASSERT_FALSE (init);
+	rai::stat stats;
+	rai::ledger ledger (store, stats);
+	rai::genesis genesis;
+	rai::transaction transaction (store.environment, nullptr, true);
+	genesis.initialize (transaction, store);
+	for (auto & i : ledger3.blocks)
+	{
+		ASSERT_EQ (rai::process_result::progress, ledger.process (transaction, *i).code);
+	}
+	ASSERT_EQ (11, store.account_count (transaction));
+}
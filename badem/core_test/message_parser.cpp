@@ -179,3 +179,40 @@ TEST (message_parser, exact_keepalive_size)
 	ASSERT_EQ (1, visitor.keepalive_count);
 	ASSERT_NE (parser.status, rai::message_parser::parse_status::success);
 }
+
+// Once blocks, votes and buffers from earlier messages are released, parsing and reserializing messages takes nothing new from the heap through the pools
+TEST (message_parser, pooled_allocations)
+{
+	rai::work_pool work (std::numeric_limits<unsigned>::max (), nullptr);
+	test_visitor visitor;
+	rai::message_parser parser (visitor, work);
+	rai::keypair key1;
+	auto block (std::make_shared<rai::send_block> (1, 1, 2, key1.prv, key1.pub, work.generate (1)));
+	rai::confirm_ack confirm (std::make_shared<rai::vote> (key1.pub, key1.prv, 0, block));
+	rai::publish publish (block);
+	auto parse ([&]() {
+		auto bytes (rai::buffer_pool::get ());
+		{
+			rai::vectorstream stream (*bytes);
+			confirm.serialize (stream);
+		}
+		parser.deserialize_buffer (bytes->data (), bytes->size ());
+		bytes = rai::buffer_pool::get ();
+		{
+			rai::vectorstream stream (*bytes);
+			publish.serialize (stream);
+		}
+		parser.deserialize_buffer (bytes->data (), bytes->size ());
+	});
+	parse ();
+	auto allocated (rai::pool_counters::allocated.load ());
+	auto reused (rai::pool_counters::reused.load ());
+	for (auto i (0); i < 100; ++i)
+	{
+		parse ();
+	}
+	ASSERT_EQ (200, visitor.confirm_ack_count + visitor.publish_count - 2);
+	ASSERT_EQ (allocated, rai::pool_counters::allocated.load ());
+	// Per iteration, two buffers and their control blocks, the vote and its block, and the published block
+	ASSERT_LE (reused + 100 * 7, rai::pool_counters::reused.load ());
+}
@@ -438,6 +438,7 @@ TEST (bulk_pull, end_not_owned)
 	open.hashables.account = key2.pub;
 	open.hashables.representative = key2.pub;
 	open.hashables.source = latest;
+	open.refresh ();
 	open.signature = rai::sign_message (key2.prv, key2.pub, open.hash ());
 	ASSERT_EQ (rai::process_result::progress, system.nodes[0]->process (open).code);
 	auto connection (std::make_shared<rai::bootstrap_server> (nullptr, system.nodes[0]));
@@ -480,6 +481,94 @@ TEST (bulk_pull, get_next_on_open)
 	ASSERT_EQ (request->current, request->request->end);
 }
 
+// A start that isn't an account but a block hash pulls that block's chain
+TEST (bulk_pull, by_block)
+{
+	rai::system system (24000, 1);
+	auto connection (std::make_shared<rai::bootstrap_server> (nullptr, system.nodes[0]));
+	rai::genesis genesis;
+	std::unique_ptr<rai::bulk_pull> req (new rai::bulk_pull{});
+	req->start = genesis.hash ();
+	req->end.clear ();
+	connection->requests.push (std::unique_ptr<rai::message>{});
+	auto request (std::make_shared<rai::bulk_pull_server> (connection, std::move (req)));
+	ASSERT_EQ (genesis.hash (), request->current);
+	auto block (request->get_next ());
+	ASSERT_NE (nullptr, block);
+	ASSERT_EQ (genesis.hash (), block->hash ());
+	ASSERT_EQ (nullptr, request->get_next ());
+}
+
+TEST (bulk_pull, resume_between_reads)
+{
+	rai::system system (24000, 1);
+	system.wallet (0)->insert_adhoc (rai::test_genesis_key.prv);
+	rai::keypair key2;
+	auto send1 (system.wallet (0)->send_action (rai::test_genesis_key.pub, key2.pub, 100));
+	ASSERT_NE (nullptr, send1);
+	auto connection (std::make_shared<rai::bootstrap_server> (nullptr, system.nodes[0]));
+	std::unique_ptr<rai::bulk_pull> req (new rai::bulk_pull{});
+	req->start = rai::test_genesis_key.pub;
+	req->end.clear ();
+	connection->requests.push (std::unique_ptr<rai::message>{});
+	auto request (std::make_shared<rai::bulk_pull_server> (connection, std::move (req)));
+	auto block1 (request->get_next ());
+	ASSERT_NE (nullptr, block1);
+	ASSERT_EQ (send1->hash (), block1->hash ());
+	// Each read opens its own snapshot and walking continues from the same position
+	auto block2 (request->get_next ());
+	ASSERT_NE (nullptr, block2);
+	ASSERT_EQ (send1->previous (), block2->hash ());
+	ASSERT_EQ (nullptr, request->get_next ());
+}
+
+// Several pulls are requested in one write on a single connection and answered back to back
+TEST (bulk_pull, pipelined)
+{
+	rai::system system (24000, 1);
+	auto node0 (system.nodes[0]);
+	system.wallet (0)->insert_adhoc (rai::test_genesis_key.prv);
+	std::vector<rai::keypair> keys (4);
+	for (auto & i : keys)
+	{
+		system.wallet (0)->insert_adhoc (i.prv);
+		ASSERT_NE (nullptr, system.wallet (0)->send_action (rai::test_genesis_key.pub, i.pub, 100));
+	}
+	auto iterations1 (0);
+	while (std::any_of (keys.begin (), keys.end (), [&node0](rai::keypair const & key_a) { return node0->balance (key_a.pub).is_zero (); }))
+	{
+		system.poll ();
+		++iterations1;
+		ASSERT_LT (iterations1, 200);
+	}
+	rai::node_config config (24001, system.logging);
+	config.bootstrap_connections = 1;
+	config.bootstrap_connections_max = 1;
+	rai::node_init init1;
+	auto node1 (std::make_shared<rai::node> (init1, system.service, rai::unique_path (), system.alarm, config, system.work));
+	ASSERT_FALSE (init1.error ());
+	node1->bootstrap_initiator.bootstrap (node0->network.endpoint ());
+	auto attempt (node1->bootstrap_initiator.current_attempt ());
+	ASSERT_NE (nullptr, attempt);
+	auto iterations2 (0);
+	while (attempt->pulls_completed < keys.size () + 1)
+	{
+		system.poll ();
+		++iterations2;
+		ASSERT_LT (iterations2, 200);
+	}
+	auto iterations3 (0);
+	while (std::any_of (keys.begin (), keys.end (), [&node1](rai::keypair const & key_a) { return node1->balance (key_a.pub) != 100; }))
+	{
+		system.poll ();
+		++iterations3;
+		ASSERT_LT (iterations3, 200);
+	}
+	ASSERT_EQ (node0->latest (rai::test_genesis_key.pub), node1->latest (rai::test_genesis_key.pub));
+	ASSERT_EQ (0, attempt->pulls_failed);
+	node1->stop ();
+}
+
 TEST (bootstrap_processor, DISABLED_process_none)
 {
 	rai::system system (24000, 1);
@@ -546,6 +635,30 @@ TEST (bootstrap_processor, process_two)
 	node1->stop ();
 }
 
+// Pulled chains are processed oldest first without being parked in unchecked
+TEST (bootstrap_processor, ordered_ingest)
+{
+	rai::system system (24000, 1);
+	system.wallet (0)->insert_adhoc (rai::test_genesis_key.prv);
+	for (auto i (0); i < 4; ++i)
+	{
+		ASSERT_NE (nullptr, system.wallet (0)->send_action (rai::test_genesis_key.pub, rai::test_genesis_key.pub, 50));
+	}
+	rai::node_init init1;
+	auto node1 (std::make_shared<rai::node> (init1, system.service, 24001, rai::unique_path (), system.alarm, system.logging, system.work));
+	ASSERT_FALSE (init1.error ());
+	node1->bootstrap_initiator.bootstrap (system.nodes[0]->network.endpoint ());
+	auto iterations (0);
+	while (node1->latest (rai::test_genesis_key.pub) != system.nodes[0]->latest (rai::test_genesis_key.pub))
+	{
+		system.poll ();
+		++iterations;
+		ASSERT_LT (iterations, 200);
+	}
+	ASSERT_EQ (0, node1->stats.count (rai::stat::type::unchecked, rai::stat::detail::gap_previous));
+	node1->stop ();
+}
+
 // Bootstrap can pull universal blocks
 TEST (bootstrap_processor, process_state)
 {
@@ -607,6 +720,71 @@ TEST (bootstrap_processor, process_new)
 	node1->stop ();
 }
 
+// Lazy bootstrap from an open block also pulls the chain holding its source
+TEST (bootstrap_processor, lazy_hash)
+{
+	rai::system system (24000, 1);
+	rai::keypair key;
+	auto node0 (system.nodes[0]);
+	rai::send_block send (node0->latest (rai::test_genesis_key.pub), key.pub, rai::genesis_amount - 100, rai::test_genesis_key.prv, rai::test_genesis_key.pub, system.work.generate (node0->latest (rai::test_genesis_key.pub)));
+	ASSERT_EQ (rai::process_result::progress, node0->process (send).code);
+	rai::open_block open (send.hash (), key.pub, key.pub, key.prv, key.pub, system.work.generate (key.pub));
+	ASSERT_EQ (rai::process_result::progress, node0->process (open).code);
+	rai::node_init init1;
+	auto node1 (std::make_shared<rai::node> (init1, system.service, 24001, rai::unique_path (), system.alarm, system.logging, system.work));
+	ASSERT_FALSE (init1.error ());
+	node1->peers.insert (node0->network.endpoint (), rai::protocol_version);
+	node1->bootstrap_initiator.bootstrap_lazy (open.hash ());
+	auto iterations (0);
+	while (node1->balance (key.pub) != 100)
+	{
+		system.poll ();
+		++iterations;
+		ASSERT_LT (iterations, 200);
+	}
+	ASSERT_EQ (send.hash (), node1->latest (rai::test_genesis_key.pub));
+	node1->stop ();
+}
+
+TEST (bootstrap_processor, lazy_end)
+{
+	rai::system system (24000, 1);
+	rai::keypair key;
+	auto node0 (system.nodes[0]);
+	rai::genesis genesis;
+	rai::state_block send1 (rai::test_genesis_key.pub, genesis.hash (), rai::test_genesis_key.pub, rai::genesis_amount - 100, key.pub, rai::test_genesis_key.prv, rai::test_genesis_key.pub, system.work.generate (genesis.hash ()));
+	ASSERT_EQ (rai::process_result::progress, node0->process (send1).code);
+	rai::state_block send2 (rai::test_genesis_key.pub, send1.hash (), rai::test_genesis_key.pub, rai::genesis_amount - 200, key.pub, rai::test_genesis_key.prv, rai::test_genesis_key.pub, system.work.generate (send1.hash ()));
+	ASSERT_EQ (rai::process_result::progress, node0->process (send2).code);
+	rai::node_init init1;
+	auto node1 (std::make_shared<rai::node> (init1, system.service, 24001, rai::unique_path (), system.alarm, system.logging, system.work));
+	ASSERT_FALSE (init1.error ());
+	node1->peers.insert (node0->network.endpoint (), rai::protocol_version);
+	// The pull stops at the head we already hold
+	node1->bootstrap_initiator.bootstrap_lazy (send2.hash (), genesis.hash ());
+	auto iterations (0);
+	while (node1->latest (rai::test_genesis_key.pub) != send2.hash ())
+	{
+		system.poll ();
+		++iterations;
+		ASSERT_LT (iterations, 200);
+	}
+	node1->stop ();
+}
+
+TEST (bootstrap_processor, lazy_start_stopped)
+{
+	rai::system system (24000, 1);
+	auto attempt (std::make_shared<rai::bootstrap_attempt> (system.nodes[0]));
+	ASSERT_FALSE (attempt->lazy_start (1, 2));
+	ASSERT_EQ (1, attempt->pulls.size ());
+	ASSERT_EQ (rai::block_hash (2), attempt->pulls.front ().end);
+	// Hashes handed to a stopped attempt are refused rather than lost
+	attempt->stop ();
+	ASSERT_TRUE (attempt->lazy_start (3));
+	ASSERT_EQ (1, attempt->pulls.size ());
+}
+
 TEST (bootstrap_processor, pull_diamond)
 {
 	rai::system system (24000, 1);
@@ -761,6 +939,88 @@ TEST (frontier_req, time_cutoff)
 	ASSERT_EQ (genesis.hash (), request->info.head);
 }
 
+TEST (frontier_req, stream)
+{
+	rai::system system (24000, 1);
+	rai::keypair key2;
+	system.wallet (0)->insert_adhoc (rai::test_genesis_key.prv);
+	system.wallet (0)->insert_adhoc (key2.prv);
+	ASSERT_NE (nullptr, system.wallet (0)->send_action (rai::test_genesis_key.pub, key2.pub, 100));
+	auto iterations (0);
+	while (system.nodes[0]->balance (key2.pub).is_zero ())
+	{
+		system.poll ();
+		++iterations;
+		ASSERT_LT (iterations, 200);
+	}
+	auto connection (std::make_shared<rai::bootstrap_server> (nullptr, system.nodes[0]));
+	std::unique_ptr<rai::frontier_req> req (new rai::frontier_req);
+	req->start.clear ();
+	req->age = std::numeric_limits<decltype (req->age)>::max ();
+	req->count = std::numeric_limits<decltype (req->count)>::max ();
+	connection->requests.push (std::unique_ptr<rai::message>{});
+	auto request (std::make_shared<rai::frontier_req_server> (connection, std::move (req)));
+	auto first (std::min (rai::test_genesis_key.pub, key2.pub));
+	auto second (std::max (rai::test_genesis_key.pub, key2.pub));
+	ASSERT_EQ (first, request->current);
+	ASSERT_EQ (system.nodes[0]->latest (first), request->info.head);
+	request->next ();
+	ASSERT_EQ (second, request->current);
+	ASSERT_EQ (system.nodes[0]->latest (second), request->info.head);
+	request->next ();
+	ASSERT_TRUE (request->current.is_zero ());
+}
+
+TEST (frontier_req_client, batched_flush)
+{
+	rai::system system (24000, 1);
+	auto node (system.nodes[0]);
+	rai::keypair key2;
+	system.wallet (0)->insert_adhoc (rai::test_genesis_key.prv);
+	system.wallet (0)->insert_adhoc (key2.prv);
+	ASSERT_NE (nullptr, system.wallet (0)->send_action (rai::test_genesis_key.pub, key2.pub, 100));
+	auto iterations (0);
+	while (node->balance (key2.pub).is_zero ())
+	{
+		system.poll ();
+		++iterations;
+		ASSERT_LT (iterations, 200);
+	}
+	auto attempt (std::make_shared<rai::bootstrap_attempt> (node));
+	attempt->next_log = std::chrono::steady_clock::now () + std::chrono::hours (1);
+	auto client (std::make_shared<rai::bootstrap_client> (node, attempt, rai::tcp_endpoint (boost::asio::ip::address_v6::loopback (), 24001)));
+	auto frontiers (std::make_shared<rai::frontier_req_client> (client));
+	auto receive ([&client, &frontiers](rai::account const & account_a, rai::block_hash const & latest_a) {
+		std::copy (account_a.bytes.begin (), account_a.bytes.end (), client->receive_buffer->begin ());
+		std::copy (latest_a.bytes.begin (), latest_a.bytes.end (), client->receive_buffer->begin () + sizeof (account_a));
+		frontiers->received_frontier (boost::system::error_code (), sizeof (rai::uint256_union) + sizeof (rai::uint256_union));
+	});
+	// The peer is ahead on genesis, has an account we don't and lacks key2
+	rai::keypair key3;
+	std::map<rai::account, rai::block_hash> remote;
+	remote[rai::test_genesis_key.pub] = rai::block_hash (1);
+	remote[key3.pub] = rai::block_hash (2);
+	for (auto & i : remote)
+	{
+		// Each frontier reads under a new snapshot without losing the merge position
+		receive (i.first, i.second);
+		ASSERT_TRUE (attempt->pulls.empty ());
+		ASSERT_TRUE (attempt->bulk_push_targets.empty ());
+	}
+	receive (rai::account (0), rai::block_hash (0));
+	ASSERT_TRUE (frontiers->pulls.empty ());
+	ASSERT_TRUE (frontiers->bulk_push_targets.empty ());
+	ASSERT_EQ (2, attempt->pulls.size ());
+	for (auto & i : attempt->pulls)
+	{
+		ASSERT_EQ (remote[i.account], i.head);
+		ASSERT_EQ (i.account == rai::test_genesis_key.pub ? node->latest (rai::test_genesis_key.pub) : rai::block_hash (0), i.end);
+	}
+	ASSERT_EQ (1, attempt->bulk_push_targets.size ());
+	ASSERT_EQ (node->latest (key2.pub), attempt->bulk_push_targets[0].first);
+	ASSERT_TRUE (attempt->bulk_push_targets[0].second.is_zero ());
+}
+
 TEST (bulk, genesis)
 {
 	rai::system system (24000, 1);
@@ -2,8 +2,11 @@
 #include <badem/node/testing.hpp>
 #include <badem/node/working.hpp>
 
+#include <boost/beast.hpp>
 #include <boost/make_shared.hpp>
 
+#include <numeric>
+
 TEST (node, stop)
 {
 	rai::system system (24000, 1);
@@ -515,7 +518,12 @@ TEST (node_config, serialization)
 	config1.callback_address = "test";
 	config1.callback_port = 10;
 	config1.callback_target = "test";
+	config1.callback_connections = 10;
+	config1.callback_queue_max = 10;
+	config1.callback_batch_max = 10;
 	config1.lmdb_max_dbs = 256;
+	config1.unchecked_cache_max = 10;
+	config1.unchecked_cutoff_time = 10;
 	config1.state_block_parse_canary = 10;
 	config1.state_block_generate_canary = 10;
 	boost::property_tree::ptree tree;
@@ -534,7 +542,12 @@ TEST (node_config, serialization)
 	ASSERT_NE (config2.callback_address, config1.callback_address);
 	ASSERT_NE (config2.callback_port, config1.callback_port);
 	ASSERT_NE (config2.callback_target, config1.callback_target);
+	ASSERT_NE (config2.callback_connections, config1.callback_connections);
+	ASSERT_NE (config2.callback_queue_max, config1.callback_queue_max);
+	ASSERT_NE (config2.callback_batch_max, config1.callback_batch_max);
 	ASSERT_NE (config2.lmdb_max_dbs, config1.lmdb_max_dbs);
+	ASSERT_NE (config2.unchecked_cache_max, config1.unchecked_cache_max);
+	ASSERT_NE (config2.unchecked_cutoff_time, config1.unchecked_cutoff_time);
 	ASSERT_NE (config2.state_block_parse_canary, config1.state_block_parse_canary);
 	ASSERT_NE (config2.state_block_generate_canary, config1.state_block_generate_canary);
 
@@ -551,7 +564,12 @@ TEST (node_config, serialization)
 	ASSERT_EQ (config2.callback_address, config1.callback_address);
 	ASSERT_EQ (config2.callback_port, config1.callback_port);
 	ASSERT_EQ (config2.callback_target, config1.callback_target);
+	ASSERT_EQ (config2.callback_connections, config1.callback_connections);
+	ASSERT_EQ (config2.callback_queue_max, config1.callback_queue_max);
+	ASSERT_EQ (config2.callback_batch_max, config1.callback_batch_max);
 	ASSERT_EQ (config2.lmdb_max_dbs, config1.lmdb_max_dbs);
+	ASSERT_EQ (config2.unchecked_cache_max, config1.unchecked_cache_max);
+	ASSERT_EQ (config2.unchecked_cutoff_time, config1.unchecked_cutoff_time);
 	ASSERT_EQ (config2.state_block_parse_canary, config1.state_block_parse_canary);
 	ASSERT_EQ (config2.state_block_generate_canary, config1.state_block_generate_canary);
 }
@@ -1424,6 +1442,66 @@ TEST (node, send_callback)
 	ASSERT_EQ (std::numeric_limits<rai::uint128_t>::max () - system.nodes[0]->config.receive_minimum.number (), system.nodes[0]->balance (rai::test_genesis_key.pub));
 }
 
+TEST (node, callback_overflow)
+{
+	rai::system system (24000, 1);
+	auto & node (*system.nodes[0]);
+	node.config.callback_address = "localhost";
+	node.config.callback_port = 8010;
+	node.config.callback_target = "/";
+	node.config.callback_queue_max = 2;
+	node.callback.add ("{}");
+	node.callback.add ("{}");
+	ASSERT_EQ (2, node.callback.size ());
+	ASSERT_EQ (0, node.callback.dropped.load ());
+	node.callback.add ("{}");
+	ASSERT_EQ (2, node.callback.size ());
+	ASSERT_EQ (1, node.callback.dropped.load ());
+	ASSERT_EQ (1, node.stats.count (rai::stat::type::http_callback, rai::stat::detail::overflow, rai::stat::dir::out));
+}
+
+// A callback the target answers with an error status is counted as failed rather than delivered
+TEST (node, callback_error_status)
+{
+	rai::system system (24000, 1);
+	auto & node (*system.nodes[0]);
+	boost::asio::ip::tcp::endpoint endpoint (boost::asio::ip::address_v4::loopback (), 24100);
+	boost::asio::ip::tcp::acceptor acceptor (system.service);
+	acceptor.open (endpoint.protocol ());
+	acceptor.set_option (boost::asio::ip::tcp::acceptor::reuse_address (true));
+	acceptor.bind (endpoint);
+	acceptor.listen ();
+	boost::asio::ip::tcp::socket socket (system.service);
+	boost::beast::flat_buffer buffer;
+	boost::beast::http::request<boost::beast::http::string_body> request;
+	boost::beast::http::response<boost::beast::http::string_body> response;
+	acceptor.async_accept (socket, [&socket, &buffer, &request, &response](boost::system::error_code const & ec) {
+		ASSERT_FALSE (ec);
+		boost::beast::http::async_read (socket, buffer, request, [&socket, &response](boost::system::error_code const & ec, size_t bytes_transferred) {
+			ASSERT_FALSE (ec);
+			response.result (boost::beast::http::status::internal_server_error);
+			response.version (11);
+			response.keep_alive (false);
+			response.prepare_payload ();
+			boost::beast::http::async_write (socket, response, [](boost::system::error_code const & ec, size_t bytes_transferred) {});
+		});
+	});
+	node.config.callback_address = "127.0.0.1";
+	node.config.callback_port = endpoint.port ();
+	node.config.callback_target = "/";
+	node.callback.add ("{}");
+	auto iterations (0);
+	while (node.stats.count (rai::stat::type::http_callback, rai::stat::detail::failed, rai::stat::dir::out) == 0)
+	{
+		system.poll ();
+		++iterations;
+		ASSERT_LT (iterations, 200);
+	}
+	ASSERT_EQ (0, node.stats.count (rai::stat::type::http_callback, rai::stat::detail::delivered, rai::stat::dir::out));
+	ASSERT_EQ (1, node.callback.dropped.load ());
+	ASSERT_EQ ("{}", request.body ());
+}
+
 // Check that votes get replayed back to nodes if they sent an old sequence number.
 // This helps representatives continue from their last sequence number if their node is reinitialized and the old sequence number is lost
 TEST (node, vote_replay)
@@ -1500,6 +1578,9 @@ TEST (node, bootstrap_connection_scaling)
 	ASSERT_EQ (4, attempt->target_connections (0));
 	ASSERT_EQ (64, attempt->target_connections (50000));
 	ASSERT_EQ (64, attempt->target_connections (10000000000));
+	// The adaptive target starts at bootstrap_connections and never exceeds the ceiling it's given
+	ASSERT_EQ (4, attempt->adapt_connections (64, 0.0));
+	ASSERT_EQ (2, attempt->adapt_connections (2, 1000.0));
 	node1.config.bootstrap_connections = 128;
 	ASSERT_EQ (64, attempt->target_connections (0));
 	ASSERT_EQ (64, attempt->target_connections (50000));
@@ -1527,6 +1608,66 @@ TEST (node, stat_counting)
 	ASSERT_EQ (1, node1.stats.count (rai::stat::type::ledger, rai::stat::detail::receive, rai::stat::dir::in));
 }
 
+TEST (node, bootstrap_scores_persist)
+{
+	rai::system system (24000, 1);
+	auto path (rai::unique_path ());
+	rai::endpoint endpoint1 (boost::asio::ip::address_v6::loopback (), 10000);
+	double score;
+	{
+		rai::node_init init1;
+		auto node1 (std::make_shared<rai::node> (init1, system.service, 24001, path, system.alarm, system.logging, system.work));
+		ASSERT_FALSE (init1.error ());
+		ASSERT_FALSE (node1->peers.insert (endpoint1, rai::protocol_version));
+		node1->peers.bootstrap_completed (endpoint1, std::chrono::milliseconds (10), 1000, 10.0);
+		score = node1->peers.bootstrap_score (endpoint1);
+		node1->bootstrap_scores_store ();
+		node1->stop ();
+	}
+	{
+		rai::node_init init2;
+		auto node2 (std::make_shared<rai::node> (init2, system.service, 24001, path, system.alarm, system.logging, system.work));
+		ASSERT_FALSE (init2.error ());
+		ASSERT_EQ (score, node2->peers.bootstrap_score (endpoint1));
+		// Purged peers keep their stored score, evicted ones lose it
+		ASSERT_FALSE (node2->peers.insert (endpoint1, rai::protocol_version));
+		node2->peers.purge_list (std::chrono::steady_clock::now () + std::chrono::seconds (10));
+		node2->bootstrap_scores_store ();
+		{
+			rai::transaction transaction (node2->store.environment, nullptr, false);
+			ASSERT_NE (node2->store.bootstrap_score_end (), node2->store.bootstrap_score_begin (transaction));
+		}
+		{
+			std::lock_guard<std::mutex> lock (node2->peers.mutex);
+			node2->peers.bootstrap_scores[endpoint1].last_update -= rai::peer_container::bootstrap_score_cutoff + 1;
+		}
+		node2->peers.purge_list (std::chrono::steady_clock::now ());
+		node2->bootstrap_scores_store ();
+		rai::transaction transaction (node2->store.environment, nullptr, false);
+		ASSERT_EQ (node2->store.bootstrap_score_end (), node2->store.bootstrap_score_begin (transaction));
+		node2->stop ();
+	}
+}
+
+TEST (node, stat_histogram)
+{
+	rai::system system (24000, 1);
+	auto & node1 (*system.nodes[0]);
+	node1.stats.define_histogram (rai::stat::type::ledger, rai::stat::detail::send, rai::stat::dir::in, { 10, 100 });
+	node1.stats.update_histogram (rai::stat::type::ledger, rai::stat::detail::send, rai::stat::dir::in, 0);
+	node1.stats.update_histogram (rai::stat::type::ledger, rai::stat::detail::send, rai::stat::dir::in, 10);
+	node1.stats.update_histogram (rai::stat::type::ledger, rai::stat::detail::send, rai::stat::dir::in, 11);
+	node1.stats.update_histogram (rai::stat::type::ledger, rai::stat::detail::send, rai::stat::dir::in, 1000);
+	node1.stats.update_histogram (rai::stat::type::ledger, rai::stat::detail::receive, rai::stat::dir::in, 1);
+	auto histogram (node1.stats.histogram (rai::stat::type::ledger, rai::stat::detail::send, rai::stat::dir::in));
+	ASSERT_EQ (3, histogram.counts.size ());
+	ASSERT_EQ (2, histogram.counts[0]);
+	ASSERT_EQ (1, histogram.counts[1]);
+	ASSERT_EQ (1, histogram.counts[2]);
+	ASSERT_EQ (1, node1.stats.histogram (rai::stat::type::ledger, rai::stat::detail::receive, rai::stat::dir::in).counts.size ());
+	ASSERT_EQ (0, node1.stats.histogram (rai::stat::type::ledger, rai::stat::detail::receive, rai::stat::dir::in).counts[0]);
+}
+
 TEST (node, online_reps)
 {
 	rai::system system (24000, 2);
@@ -1553,3 +1694,188 @@ TEST (node, online_reps)
 	}
 	ASSERT_EQ (0, system.nodes[0]->balance (rai::test_genesis_key.pub));
 }
+
+// Signatures checked ahead of the write transaction still reject a badly signed block
+TEST (node, block_processor_signatures)
+{
+	rai::system system (24000, 1);
+	auto & node1 (*system.nodes[0]);
+	rai::keypair key1;
+	std::vector<std::shared_ptr<rai::block>> blocks;
+	auto previous (node1.latest (rai::test_genesis_key.pub));
+	auto balance (rai::genesis_amount);
+	for (auto i (0); i < 2 * rai::block_processor::verify_threshold; ++i)
+	{
+		balance -= 1;
+		auto send (std::make_shared<rai::send_block> (previous, key1.pub, balance, rai::test_genesis_key.prv, rai::test_genesis_key.pub, system.work.generate (previous)));
+		previous = send->hash ();
+		blocks.push_back (send);
+	}
+	auto bad (rai::block_processor::verify_threshold);
+	std::static_pointer_cast<rai::send_block> (blocks[bad])->signature.bytes[0] ^= 1;
+	// Queued newest first
+	node1.block_processor.add (std::vector<std::shared_ptr<rai::block>> (blocks.rbegin (), blocks.rend ()));
+	node1.block_processor.flush ();
+	ASSERT_EQ (blocks[bad - 1]->hash (), node1.latest (rai::test_genesis_key.pub));
+	rai::transaction transaction (node1.store.environment, nullptr, false);
+	ASSERT_FALSE (node1.store.block_exists (transaction, blocks[bad]->hash ()));
+}
+
+TEST (signature_checker, slices)
+{
+	rai::signature_checker checker (3);
+	std::vector<std::atomic<unsigned>> counts (1000);
+	auto task ([&counts](size_t begin_a, size_t end_a) {
+		for (auto i (begin_a); i < end_a; ++i)
+		{
+			++counts[i];
+		}
+	});
+	checker.run (counts.size (), task);
+	checker.run (counts.size (), task);
+	// Once stopped the caller does all the work itself
+	checker.stop ();
+	checker.run (counts.size (), task);
+	for (auto & i : counts)
+	{
+		ASSERT_EQ (3, i.load ());
+	}
+}
+
+// A chain longer than a live batch is written over several transactions, each recorded in the block processor histograms
+TEST (node, block_processor_batches)
+{
+	rai::system system (24000, 1);
+	auto & node1 (*system.nodes[0]);
+	rai::keypair key1;
+	std::vector<std::shared_ptr<rai::block>> blocks;
+	auto previous (node1.latest (rai::test_genesis_key.pub));
+	auto balance (rai::genesis_amount);
+	for (auto i (0); i <= rai::block_processor::live_batch_max; ++i)
+	{
+		balance -= 1;
+		auto send (std::make_shared<rai::send_block> (previous, key1.pub, balance, rai::test_genesis_key.prv, rai::test_genesis_key.pub, system.work.generate (previous)));
+		previous = send->hash ();
+		blocks.push_back (send);
+	}
+	node1.block_processor.add (std::vector<std::shared_ptr<rai::block>> (blocks.rbegin (), blocks.rend ()));
+	node1.block_processor.flush ();
+	ASSERT_EQ (blocks.back ()->hash (), node1.latest (rai::test_genesis_key.pub));
+	auto sizes (node1.stats.histogram (rai::stat::type::block_processor, rai::stat::detail::batch_size, rai::stat::dir::in));
+	auto waits (node1.stats.histogram (rai::stat::type::block_processor, rai::stat::detail::lock_wait, rai::stat::dir::in));
+	auto batches (std::accumulate (sizes.counts.begin (), sizes.counts.end (), uint64_t (0)));
+	ASSERT_LE (2, batches);
+	ASSERT_EQ (batches, std::accumulate (waits.counts.begin (), waits.counts.end (), uint64_t (0)));
+}
+
+// Live blocks waiting behind a bootstrap backlog cap the batch, and the batch size adapts to how long commits hold the write lock
+TEST (node, block_processor_live_batch)
+{
+	rai::system system (24000, 1);
+	auto & node1 (*system.nodes[0]);
+	rai::genesis genesis;
+	auto work (system.work.generate (genesis.hash ()));
+	auto live (std::make_shared<rai::send_block> (genesis.hash (), rai::test_genesis_key.pub, rai::genesis_amount - 1, rai::test_genesis_key.prv, rai::test_genesis_key.pub, work));
+	auto bootstrap (std::make_shared<rai::send_block> (genesis.hash (), rai::test_genesis_key.pub, rai::genesis_amount - 2, rai::test_genesis_key.prv, rai::test_genesis_key.pub, work));
+	size_t const live_batch_max (rai::block_processor::live_batch_max);
+	size_t const batch_min (rai::block_processor::batch_min);
+	size_t const batch_max (rai::block_processor::batch_max);
+	node1.block_processor.stop ();
+	node1.block_processor.add (std::vector<std::shared_ptr<rai::block>> (4 * live_batch_max, bootstrap));
+	ASSERT_EQ (live_batch_max, node1.block_processor.next_batch_size ());
+	// Full batches committed quickly double the size while only bootstrap blocks are waiting
+	node1.block_processor.adapt (std::chrono::milliseconds (1), true);
+	node1.block_processor.adapt (std::chrono::milliseconds (1), true);
+	ASSERT_EQ (4 * live_batch_max, node1.block_processor.next_batch_size ());
+	node1.block_processor.add (live, rai::block_origin::live);
+	ASSERT_EQ (live_batch_max, node1.block_processor.next_batch_size ());
+	auto batch (node1.block_processor.next_batch (node1.block_processor.next_batch_size ()));
+	ASSERT_EQ (live_batch_max, batch.size ());
+	ASSERT_EQ (1, std::count_if (batch.begin (), batch.end (), [&live](std::pair<std::shared_ptr<rai::block>, bool> const & item_a) { return item_a.first == live; }));
+	// Once the live lane is drained the whole batch size applies again
+	ASSERT_EQ (4 * live_batch_max, node1.block_processor.next_batch_size ());
+	// Quick commits that didn't fill the batch and commits between half and all of the target leave it alone
+	node1.block_processor.adapt (std::chrono::milliseconds (1), false);
+	node1.block_processor.adapt (rai::block_processor::batch_target * 3 / 4, true);
+	ASSERT_EQ (4 * live_batch_max, node1.block_processor.next_batch_size ());
+	// Slow commits halve it down to batch_min
+	node1.block_processor.adapt (rai::block_processor::batch_target * 2, true);
+	ASSERT_EQ (2 * live_batch_max, node1.block_processor.next_batch_size ());
+	for (auto i (0); i < 16; ++i)
+	{
+		node1.block_processor.adapt (rai::block_processor::batch_target * 2, true);
+	}
+	ASSERT_EQ (batch_min, node1.block_processor.next_batch_size ());
+	for (auto i (0); i < 16; ++i)
+	{
+		node1.block_processor.adapt (std::chrono::milliseconds (1), true);
+	}
+	ASSERT_EQ (batch_max, node1.block_processor.next_batch_size ());
+}
+
+// Each origin is queued in its own lane and blocks past a lane's depth limit are dropped and counted
+TEST (node, block_processor_lanes)
+{
+	rai::system system (24000, 1);
+	auto & node1 (*system.nodes[0]);
+	rai::genesis genesis;
+	auto send (std::make_shared<rai::send_block> (genesis.hash (), rai::test_genesis_key.pub, rai::genesis_amount - 1, rai::test_genesis_key.prv, rai::test_genesis_key.pub, system.work.generate (genesis.hash ())));
+	// Nothing is taken from the lanes once the processor is stopped
+	node1.block_processor.stop ();
+	node1.process_active (send, rai::block_origin::local);
+	node1.block_processor.add (std::vector<std::shared_ptr<rai::block>> (1, send));
+	ASSERT_EQ (1, node1.block_processor.lane_size (rai::block_origin::local));
+	ASSERT_EQ (0, node1.block_processor.lane_size (rai::block_origin::live));
+	ASSERT_EQ (1, node1.block_processor.lane_size (rai::block_origin::bootstrap));
+	auto max (rai::block_processor::lane_max (rai::block_origin::local));
+	for (size_t i (0); i < max; ++i)
+	{
+		node1.block_processor.add (send, rai::block_origin::local);
+	}
+	ASSERT_EQ (max, node1.block_processor.lane_size (rai::block_origin::local));
+	ASSERT_EQ (max + 1, node1.block_processor.size ());
+	ASSERT_EQ (1, node1.stats.count (rai::stat::type::block_processor, rai::stat::detail::drop_local, rai::stat::dir::in));
+	ASSERT_EQ (0, node1.stats.count (rai::stat::type::block_processor, rai::stat::detail::drop_live, rai::stat::dir::in));
+	ASSERT_EQ (std::numeric_limits<size_t>::max (), rai::block_processor::lane_max (rai::block_origin::bootstrap));
+	ASSERT_EQ (std::numeric_limits<size_t>::max (), rai::block_processor::lane_max (rai::block_origin::unchecked));
+}
+
+// A local block is taken ahead of a bootstrap backlog and lanes then give blocks in turns of their weight
+TEST (node, block_processor_weights)
+{
+	rai::system system (24000, 1);
+	auto & node1 (*system.nodes[0]);
+	rai::genesis genesis;
+	auto work (system.work.generate (genesis.hash ()));
+	auto local (std::make_shared<rai::send_block> (genesis.hash (), rai::test_genesis_key.pub, rai::genesis_amount - 1, rai::test_genesis_key.prv, rai::test_genesis_key.pub, work));
+	auto live (std::make_shared<rai::send_block> (genesis.hash (), rai::test_genesis_key.pub, rai::genesis_amount - 2, rai::test_genesis_key.prv, rai::test_genesis_key.pub, work));
+	auto bootstrap (std::make_shared<rai::send_block> (genesis.hash (), rai::test_genesis_key.pub, rai::genesis_amount - 3, rai::test_genesis_key.prv, rai::test_genesis_key.pub, work));
+	node1.block_processor.stop ();
+	node1.block_processor.add (std::vector<std::shared_ptr<rai::block>> (100, bootstrap));
+	for (auto i (0); i < 20; ++i)
+	{
+		node1.block_processor.add (live, rai::block_origin::live);
+	}
+	node1.block_processor.add (local, rai::block_origin::local);
+	auto batch (node1.block_processor.next_batch (64));
+	ASSERT_EQ (64, batch.size ());
+	auto local_weight (rai::block_processor::lane_weight (rai::block_origin::local));
+	auto live_weight (rai::block_processor::lane_weight (rai::block_origin::live));
+	auto bootstrap_weight (rai::block_processor::lane_weight (rai::block_origin::bootstrap));
+	ASSERT_LT (1, local_weight);
+	ASSERT_LT (live_weight, 20);
+	ASSERT_LE (20 - live_weight, live_weight);
+	// The local lane empties on its turn, live gives its weight, then bootstrap, then live gives what it has left
+	std::vector<std::shared_ptr<rai::block>> expected;
+	expected.push_back (local);
+	expected.insert (expected.end (), live_weight, live);
+	expected.insert (expected.end (), bootstrap_weight, bootstrap);
+	expected.insert (expected.end (), 20 - live_weight, live);
+	expected.insert (expected.end (), 64 - expected.size (), bootstrap);
+	for (size_t i (0); i < batch.size (); ++i)
+	{
+		ASSERT_EQ (expected[i], batch[i].first);
+		ASSERT_FALSE (batch[i].second);
+	}
+	ASSERT_EQ (100 - (64 - 1 - 20), node1.block_processor.lane_size (rai::block_origin::bootstrap));
+}
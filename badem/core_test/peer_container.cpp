@@ -169,3 +169,73 @@ TEST (peer_container, depeer)
 	peers.contacted (endpoint0, rai::protocol_version_min - 1);
 	ASSERT_EQ (0, peers.size ());
 }
+
+TEST (peer_container, bootstrap_score)
+{
+	rai::peer_container peers (rai::endpoint{});
+	rai::endpoint endpoint1 (boost::asio::ip::address_v6::loopback (), 10000);
+	rai::endpoint endpoint2 (boost::asio::ip::address_v6::loopback (), 10001);
+	ASSERT_FALSE (peers.insert (endpoint1, rai::protocol_version));
+	ASSERT_FALSE (peers.insert (endpoint2, rai::protocol_version));
+	// Untried peers are preferred until they've been measured
+	ASSERT_GT (peers.bootstrap_score (endpoint1), 0.0);
+	peers.bootstrap_completed (endpoint1, std::chrono::milliseconds (10), 1000, 10.0);
+	peers.bootstrap_completed (endpoint2, std::chrono::milliseconds (10), 1000, 1000.0);
+	ASSERT_GT (peers.bootstrap_score (endpoint2), peers.bootstrap_score (endpoint1));
+	ASSERT_EQ (endpoint2, peers.bootstrap_peer ());
+	ASSERT_EQ (endpoint2, peers.bootstrap_peer ());
+	// Failures count against a peer across attempts
+	auto score (peers.bootstrap_score (endpoint2));
+	peers.bootstrap_failed (endpoint2);
+	ASSERT_LT (peers.bootstrap_score (endpoint2), score);
+	// Idle connections don't move the rate
+	score = peers.bootstrap_score (endpoint1);
+	peers.bootstrap_completed (endpoint1, std::chrono::milliseconds (10), 0, 0.0);
+	ASSERT_EQ (score, peers.bootstrap_score (endpoint1));
+}
+
+TEST (peer_container, bootstrap_score_purge)
+{
+	rai::peer_container peers (rai::endpoint{});
+	rai::endpoint endpoint1 (boost::asio::ip::address_v6::loopback (), 10000);
+	ASSERT_FALSE (peers.insert (endpoint1, rai::protocol_version));
+	peers.bootstrap_completed (endpoint1, std::chrono::milliseconds (10), 1000, 10.0);
+	ASSERT_EQ (1, peers.bootstrap_scores_list ().size ());
+	// Scores outlive the peers they belong to
+	peers.purge_list (std::chrono::steady_clock::now () + std::chrono::seconds (10));
+	ASSERT_EQ (0, peers.size ());
+	ASSERT_EQ (1, peers.bootstrap_scores_list ().size ());
+	// Until they age out
+	peers.bootstrap_scores[endpoint1].last_update -= rai::peer_container::bootstrap_score_cutoff + 1;
+	peers.purge_list (std::chrono::steady_clock::now ());
+	ASSERT_TRUE (peers.bootstrap_scores_list ().empty ());
+	ASSERT_EQ (rai::bootstrap_score ().score (), peers.bootstrap_score (endpoint1));
+}
+
+TEST (peer_container, bootstrap_score_bound)
+{
+	rai::peer_container peers (rai::endpoint{});
+	auto max (rai::peer_container::bootstrap_scores_max);
+	for (uint16_t i (0); i <= max; ++i)
+	{
+		peers.bootstrap_failed (rai::endpoint (boost::asio::ip::address_v6::loopback (), 10000 + i));
+	}
+	rai::endpoint oldest (boost::asio::ip::address_v6::loopback (), 10000);
+	peers.bootstrap_scores[oldest].last_update -= 10;
+	peers.purge_list (std::chrono::steady_clock::now ());
+	auto scores (peers.bootstrap_scores_list ());
+	ASSERT_EQ (max, scores.size ());
+	ASSERT_EQ (scores.end (), scores.find (oldest));
+	std::unordered_map<rai::endpoint, rai::bootstrap_score> changed;
+	std::vector<rai::endpoint> evicted;
+	peers.bootstrap_scores_changes (changed, evicted);
+	ASSERT_EQ (max, changed.size ());
+	ASSERT_EQ (1, evicted.size ());
+	ASSERT_EQ (oldest, evicted[0]);
+	// Nothing left to write until a score changes again
+	changed.clear ();
+	evicted.clear ();
+	peers.bootstrap_scores_changes (changed, evicted);
+	ASSERT_TRUE (changed.empty ());
+	ASSERT_TRUE (evicted.empty ());
+}
@@ -910,6 +910,55 @@ TEST (rpc, frontier_startpoint)
 	ASSERT_EQ (source.begin ()->first.to_account (), frontiers_node.begin ()->first);
 }
 
+TEST (rpc, frontier_cursor)
+{
+	rai::system system (24000, 1);
+	std::unordered_set<rai::account> source;
+	{
+		rai::transaction transaction (system.nodes[0]->store.environment, nullptr, true);
+		for (auto i (0); i < 1000; ++i)
+		{
+			rai::keypair key;
+			source.insert (key.pub);
+			system.nodes[0]->store.account_put (transaction, key.pub, rai::account_info (key.prv.data, 0, 0, 0, 0, 0));
+		}
+	}
+	source.insert (rai::test_genesis_key.pub);
+	rai::rpc rpc (system.service, *system.nodes[0], rai::rpc_config (true));
+	rpc.start ();
+	boost::property_tree::ptree request;
+	request.put ("action", "frontiers");
+	request.put ("account", rai::account (0).to_account ());
+	request.put ("count", std::to_string (300));
+	std::unordered_set<rai::account> seen;
+	auto pages (0);
+	auto done (false);
+	while (!done)
+	{
+		test_response response (request, rpc, system.service);
+		while (response.status == 0)
+		{
+			system.poll ();
+		}
+		ASSERT_EQ (200, response.status);
+		++pages;
+		for (auto & frontier : response.json.get_child ("frontiers"))
+		{
+			rai::account account;
+			ASSERT_FALSE (account.decode_account (frontier.first));
+			ASSERT_TRUE (seen.insert (account).second);
+		}
+		auto cursor (response.json.get_optional<std::string> ("cursor"));
+		done = !cursor.is_initialized ();
+		if (!done)
+		{
+			request.put ("cursor", cursor.get ());
+		}
+	}
+	ASSERT_EQ (4, pages);
+	ASSERT_EQ (source, seen);
+}
+
 TEST (rpc, history)
 {
 	rai::system system (24000, 1);
@@ -2111,6 +2160,53 @@ TEST (rpc, bootstrap_any)
 	ASSERT_TRUE (success.empty ());
 }
 
+TEST (rpc, bootstrap_lazy)
+{
+	rai::system system (24000, 1);
+	auto & node1 (*system.nodes[0]);
+	rai::genesis genesis;
+	rai::rpc rpc (system.service, node1, rai::rpc_config (true));
+	rpc.start ();
+	boost::property_tree::ptree request;
+	request.put ("action", "bootstrap_lazy");
+	request.put ("hash", genesis.hash ().to_string ());
+	test_response response1 (request, rpc, system.service);
+	while (response1.status == 0)
+	{
+		system.poll ();
+	}
+	ASSERT_EQ (200, response1.status);
+	ASSERT_EQ ("0", response1.json.get<std::string> ("started"));
+	request.put ("hash", rai::block_hash (1).to_string ());
+	test_response response2 (request, rpc, system.service);
+	while (response2.status == 0)
+	{
+		system.poll ();
+	}
+	ASSERT_EQ (200, response2.status);
+	ASSERT_EQ ("1", response2.json.get<std::string> ("started"));
+}
+
+TEST (rpc, bootstrap_status)
+{
+	rai::system system (24000, 1);
+	auto & node1 (*system.nodes[0]);
+	rai::rpc rpc (system.service, node1, rai::rpc_config (true));
+	rpc.start ();
+	boost::property_tree::ptree request;
+	request.put ("action", "bootstrap_status");
+	test_response response (request, rpc, system.service);
+	while (response.status == 0)
+	{
+		system.poll ();
+	}
+	ASSERT_EQ (200, response.status);
+	ASSERT_EQ ("0", response.json.get<std::string> ("running"));
+	ASSERT_EQ ("0", response.json.get<std::string> ("unchecked"));
+	ASSERT_EQ ("0", response.json.get<std::string> ("block_processor_queue"));
+	ASSERT_FALSE (response.json.get_optional<std::string> ("phase").is_initialized ());
+}
+
 TEST (rpc, republish)
 {
 	rai::system system (24000, 2);
@@ -3501,6 +3597,116 @@ TEST (rpc, wallet_ledger)
 	}
 }
 
+TEST (rpc, ledger_sorted_cursor)
+{
+	rai::system system (24000, 1);
+	rai::keypair key;
+	system.wallet (0)->insert_adhoc (rai::test_genesis_key.prv);
+	auto & node1 (*system.nodes[0]);
+	auto latest (node1.latest (rai::test_genesis_key.pub));
+	rai::send_block send (latest, key.pub, 100, rai::test_genesis_key.prv, rai::test_genesis_key.pub, node1.work_generate_blocking (latest));
+	ASSERT_EQ (rai::process_result::progress, node1.process (send).code);
+	rai::open_block open (send.hash (), rai::test_genesis_key.pub, key.pub, key.prv, key.pub, node1.work_generate_blocking (key.pub));
+	ASSERT_EQ (rai::process_result::progress, node1.process (open).code);
+	rai::rpc rpc (system.service, node1, rai::rpc_config (true));
+	rpc.start ();
+	boost::property_tree::ptree request;
+	request.put ("action", "ledger");
+	request.put ("sorting", "1");
+	request.put ("count", "1");
+	test_response response (request, rpc, system.service);
+	while (response.status == 0)
+	{
+		system.poll ();
+	}
+	ASSERT_EQ (200, response.status);
+	auto & accounts (response.json.get_child ("accounts"));
+	ASSERT_EQ (1, accounts.size ());
+	ASSERT_EQ (key.pub.to_account (), accounts.begin ()->first);
+	auto cursor (response.json.get_optional<std::string> ("cursor"));
+	ASSERT_TRUE (cursor.is_initialized ());
+	request.put ("cursor", cursor.get ());
+	test_response response2 (request, rpc, system.service);
+	while (response2.status == 0)
+	{
+		system.poll ();
+	}
+	ASSERT_EQ (200, response2.status);
+	auto & accounts2 (response2.json.get_child ("accounts"));
+	ASSERT_EQ (1, accounts2.size ());
+	ASSERT_EQ (rai::test_genesis_key.pub.to_account (), accounts2.begin ()->first);
+	ASSERT_FALSE (response2.json.get_optional<std::string> ("cursor").is_initialized ());
+}
+
+// A bad cursor gets a single error response and nothing else
+TEST (rpc, invalid_cursor)
+{
+	rai::system system (24000, 1);
+	auto & node1 (*system.nodes[0]);
+	rai::rpc rpc (system.service, node1, rai::rpc_config (true));
+	rpc.start ();
+	for (auto action : { "ledger", "pending", "unchecked", "wallet_ledger" })
+	{
+		boost::property_tree::ptree request;
+		request.put ("action", action);
+		request.put ("account", rai::test_genesis_key.pub.to_account ());
+		request.put ("wallet", node1.wallets.items.begin ()->first.to_string ());
+		request.put ("cursor", "invalid");
+		test_response response (request, rpc, system.service);
+		while (response.status == 0)
+		{
+			system.poll ();
+		}
+		ASSERT_EQ (200, response.status);
+		ASSERT_EQ (1, response.json.size ());
+		ASSERT_EQ ("Invalid cursor", response.json.get<std::string> ("error"));
+	}
+}
+
+TEST (rpc, accounts_top)
+{
+	rai::system system (24000, 1);
+	rai::keypair key;
+	system.wallet (0)->insert_adhoc (rai::test_genesis_key.prv);
+	auto & node1 (*system.nodes[0]);
+	auto latest (node1.latest (rai::test_genesis_key.pub));
+	rai::send_block send (latest, key.pub, 100, rai::test_genesis_key.prv, rai::test_genesis_key.pub, node1.work_generate_blocking (latest));
+	ASSERT_EQ (rai::process_result::progress, node1.process (send).code);
+	rai::open_block open (send.hash (), rai::test_genesis_key.pub, key.pub, key.prv, key.pub, node1.work_generate_blocking (key.pub));
+	ASSERT_EQ (rai::process_result::progress, node1.process (open).code);
+	rai::rpc rpc (system.service, node1, rai::rpc_config (true));
+	rpc.start ();
+	boost::property_tree::ptree request;
+	request.put ("action", "accounts_top");
+	request.put ("count", "1");
+	test_response response (request, rpc, system.service);
+	while (response.status == 0)
+	{
+		system.poll ();
+	}
+	ASSERT_EQ (200, response.status);
+	auto & accounts (response.json.get_child ("accounts"));
+	ASSERT_EQ (1, accounts.size ());
+	ASSERT_EQ (key.pub.to_account (), accounts.begin ()->first);
+	ASSERT_EQ ((rai::genesis_amount - 100).convert_to<std::string> (), accounts.begin ()->second.get<std::string> (""));
+	ASSERT_TRUE (response.json.get_optional<std::string> ("cursor").is_initialized ());
+	boost::property_tree::ptree request2;
+	request2.put ("action", "accounts_balance_range");
+	request2.put ("min", "1");
+	request2.put ("max", "1000");
+	test_response response2 (request2, rpc, system.service);
+	while (response2.status == 0)
+	{
+		system.poll ();
+	}
+	ASSERT_EQ (200, response2.status);
+	auto & accounts2 (response2.json.get_child ("accounts"));
+	ASSERT_EQ (1, accounts2.size ());
+	ASSERT_EQ (rai::test_genesis_key.pub.to_account (), accounts2.begin ()->first);
+	ASSERT_EQ ("100", accounts2.begin ()->second.get<std::string> (""));
+	ASSERT_FALSE (response2.json.get_optional<std::string> ("cursor").is_initialized ());
+}
+
 TEST (rpc, wallet_add_watch)
 {
 	rai::system system (24000, 1);
@@ -162,7 +162,7 @@ public:
 class ledger_processor : public rai::block_visitor
 {
 public:
-	ledger_processor (rai::ledger &, MDB_txn *);
+	ledger_processor (rai::ledger &, MDB_txn *, bool);
 	virtual ~ledger_processor () = default;
 	void send_block (rai::send_block const &) override;
 	void receive_block (rai::receive_block const &) override;
@@ -172,6 +172,8 @@ public:
 	void state_block_impl (rai::state_block const &);
 	rai::ledger & ledger;
 	MDB_txn * transaction;
+	// The signature was already checked against the account this block belongs to
+	bool valid_signature;
 	rai::process_return result;
 };
 
@@ -187,7 +189,7 @@ void ledger_processor::state_block_impl (rai::state_block const & block_a)
 	result.code = existing ? rai::process_result::old : rai::process_result::progress; // Have we seen this block before? (Unambiguous)
 	if (result.code == rai::process_result::progress)
 	{
-		result.code = validate_message (block_a.hashables.account, hash, block_a.signature) ? rai::process_result::bad_signature : rai::process_result::progress; // Is this block signed correctly (Unambiguous)
+		result.code = !valid_signature && validate_message (block_a.hashables.account, hash, block_a.signature) ? rai::process_result::bad_signature : rai::process_result::progress; // Is this block signed correctly (Unambiguous)
 		if (result.code == rai::process_result::progress)
 		{
 			result.code = block_a.hashables.account.is_zero () ? rai::process_result::opened_burn_account : rai::process_result::progress; // Is this for the burn account? (Unambiguous)
@@ -309,7 +311,7 @@ void ledger_processor::change_block (rai::change_block const & block_a)
 					auto latest_error (ledger.store.account_get (transaction, account, info));
 					assert (!latest_error);
 					assert (info.head == block_a.hashables.previous);
-					result.code = validate_message (account, hash, block_a.signature) ? rai::process_result::bad_signature : rai::process_result::progress; // Is this block signed correctly (Malformed)
+					result.code = !valid_signature && validate_message (account, hash, block_a.signature) ? rai::process_result::bad_signature : rai::process_result::progress; // Is this block signed correctly (Malformed)
 					if (result.code == rai::process_result::progress)
 					{
 						ledger.store.block_put (transaction, hash, block_a);
@@ -347,7 +349,7 @@ void ledger_processor::send_block (rai::send_block const & block_a)
 				result.code = account.is_zero () ? rai::process_result::fork : rai::process_result::progress;
 				if (result.code == rai::process_result::progress)
 				{
-					result.code = validate_message (account, hash, block_a.signature) ? rai::process_result::bad_signature : rai::process_result::progress; // Is this block signed correctly (Malformed)
+					result.code = !valid_signature && validate_message (account, hash, block_a.signature) ? rai::process_result::bad_signature : rai::process_result::progress; // Is this block signed correctly (Malformed)
 					if (result.code == rai::process_result::progress)
 					{
 						rai::account_info info;
@@ -397,7 +399,7 @@ void ledger_processor::receive_block (rai::receive_block const & block_a)
 					result.code = account.is_zero () ? rai::process_result::gap_previous : rai::process_result::progress; //Have we seen the previous block? No entries for account at all (Harmless)
 					if (result.code == rai::process_result::progress)
 					{
-						result.code = rai::validate_message (account, hash, block_a.signature) ? rai::process_result::bad_signature : rai::process_result::progress; // Is the signature valid (Malformed)
+						result.code = !valid_signature && rai::validate_message (account, hash, block_a.signature) ? rai::process_result::bad_signature : rai::process_result::progress; // Is the signature valid (Malformed)
 						if (result.code == rai::process_result::progress)
 						{
 							rai::account_info info;
@@ -448,7 +450,7 @@ void ledger_processor::open_block (rai::open_block const & block_a)
 		result.code = source_missing ? rai::process_result::gap_source : rai::process_result::progress; // Have we seen the source block? (Harmless)
 		if (result.code == rai::process_result::progress)
 		{
-			result.code = rai::validate_message (block_a.hashables.account, hash, block_a.signature) ? rai::process_result::bad_signature : rai::process_result::progress; // Is the signature valid (Malformed)
+			result.code = !valid_signature && rai::validate_message (block_a.hashables.account, hash, block_a.signature) ? rai::process_result::bad_signature : rai::process_result::progress; // Is the signature valid (Malformed)
 			if (result.code == rai::process_result::progress)
 			{
 				rai::account_info info;
@@ -482,25 +484,14 @@ void ledger_processor::open_block (rai::open_block const & block_a)
 	}
 }
 
-ledger_processor::ledger_processor (rai::ledger & ledger_a, MDB_txn * transaction_a) :
+ledger_processor::ledger_processor (rai::ledger & ledger_a, MDB_txn * transaction_a, bool valid_signature_a) :
 ledger (ledger_a),
-transaction (transaction_a)
+transaction (transaction_a),
+valid_signature (valid_signature_a)
 {
 }
 } // namespace
 
-size_t rai::shared_ptr_block_hash::operator() (std::shared_ptr<rai::block> const & block_a) const
-{
-	auto hash (block_a->hash ());
-	auto result (static_cast<size_t> (hash.qwords[0]));
-	return result;
-}
-
-bool rai::shared_ptr_block_hash::operator() (std::shared_ptr<rai::block> const & lhs, std::shared_ptr<rai::block> const & rhs) const
-{
-	return lhs->hash () == rhs->hash ();
-}
-
 rai::ledger::ledger (rai::block_store & store_a, rai::stat & stat_a) :
 store (store_a),
 stats (stat_a),
@@ -564,19 +555,12 @@ rai::uint128_t rai::ledger::account_balance (MDB_txn * transaction_a, rai::accou
 
 rai::uint128_t rai::ledger::account_pending (MDB_txn * transaction_a, rai::account const & account_a)
 {
-	rai::uint128_t result (0);
-	rai::account end (account_a.number () + 1);
-	for (auto i (store.pending_begin (transaction_a, rai::pending_key (account_a, 0))), n (store.pending_begin (transaction_a, rai::pending_key (end, 0))); i != n; ++i)
-	{
-		rai::pending_info info (i->second);
-		result += info.amount.number ();
-	}
-	return result;
+	return store.pending_totals_get (transaction_a, account_a).sum.number ();
 }
 
-rai::process_return rai::ledger::process (MDB_txn * transaction_a, rai::block const & block_a)
+rai::process_return rai::ledger::process (MDB_txn * transaction_a, rai::block const & block_a, bool valid_signature_a)
 {
-	ledger_processor processor (*this, transaction_a);
+	ledger_processor processor (*this, transaction_a, valid_signature_a);
 	block_a.visit (processor);
 	return processor.result;
 }
@@ -707,20 +691,20 @@ rai::account rai::ledger::account (MDB_txn * transaction_a, rai::block_hash cons
 	auto hash (hash_a);
 	rai::block_hash successor (1);
 	rai::block_info block_info;
-	std::unique_ptr<rai::block> block (store.block_get (transaction_a, hash));
-	while (!successor.is_zero () && block->type () != rai::block_type::state && store.block_info_get (transaction_a, successor, block_info))
+	// Walks successors, possibly through much of a chain during rollback, so blocks are read in place
+	auto block (store.block_get_view (transaction_a, hash));
+	while (!successor.is_zero () && block.type != rai::block_type::state && store.block_info_get (transaction_a, successor, block_info))
 	{
-		successor = store.block_successor (transaction_a, hash);
+		successor = block.successor ();
 		if (!successor.is_zero ())
 		{
 			hash = successor;
-			block = store.block_get (transaction_a, hash);
+			block = store.block_get_view (transaction_a, hash);
 		}
 	}
-	if (block->type () == rai::block_type::state)
+	if (block.type == rai::block_type::state)
 	{
-		auto state_block (dynamic_cast<rai::state_block *> (block.get ()));
-		result = state_block->hashables.account;
+		result = block.account ();
 	}
 	else if (successor.is_zero ())
 	{
@@ -804,6 +788,7 @@ void rai::ledger::change_latest (MDB_txn * transaction_a, rai::account const & a
 	if (exists)
 	{
 		checksum_update (transaction_a, info.head);
+		store.balance_del (transaction_a, account_a, info.balance.number ());
 	}
 	else
 	{
@@ -818,6 +803,7 @@ void rai::ledger::change_latest (MDB_txn * transaction_a, rai::account const & a
 		info.modified = rai::seconds_since_epoch ();
 		info.block_count = block_count_a;
 		store.account_put (transaction_a, account_a, info);
+		store.balance_put (transaction_a, account_a, balance_a.number ());
 		if (!(block_count_a % store.block_info_max) && !is_state)
 		{
 			rai::block_info block_info;
@@ -7,13 +7,6 @@ namespace rai
 class block_store;
 class stat;
 
-class shared_ptr_block_hash
-{
-public:
-	size_t operator() (std::shared_ptr<rai::block> const &) const;
-	bool operator() (std::shared_ptr<rai::block> const &, std::shared_ptr<rai::block> const &) const;
-};
-using tally_t = std::map<rai::uint128_t, std::shared_ptr<rai::block>, std::greater<rai::uint128_t>>;
 class ledger
 {
 public:
@@ -39,7 +32,8 @@ public:
 	bool is_send (MDB_txn *, rai::state_block const &);
 	rai::block_hash block_destination (MDB_txn *, rai::block const &);
 	rai::block_hash block_source (MDB_txn *, rai::block const &);
-	rai::process_return process (MDB_txn *, rai::block const &);
+	// Pass true when the block's signature has already been verified against its account
+	rai::process_return process (MDB_txn *, rai::block const &, bool = false);
 	void rollback (MDB_txn *, rai::block_hash const &);
 	void change_latest (MDB_txn *, rai::account const &, rai::block_hash const &, rai::account const &, rai::uint128_union const &, uint64_t, bool = false);
 	void checksum_update (MDB_txn *, rai::block_hash const &);
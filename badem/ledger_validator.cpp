@@ -0,0 +1,347 @@
+#include <badem/blockstore.hpp>
+#include <badem/ledger.hpp>
+#include <badem/ledger_validator.hpp>
+
+#include <boost/format.hpp>
+
+#include <thread>
+#include <unordered_set>
+
+namespace
+{
+/**
+ * Replays one block of a chain, oldest first, on top of the balance of the blocks before it
+ */
+class balance_step : public rai::block_visitor
+{
+public:
+	balance_step (MDB_txn * transaction_a, rai::ledger & ledger_a, rai::account const & account_a) :
+	transaction (transaction_a),
+	ledger (ledger_a),
+	account (account_a),
+	balance (0)
+	{
+	}
+	void send_block (rai::send_block const & block_a) override
+	{
+		if (block_a.hashables.balance.number () > balance)
+		{
+			problem = "send increases the balance";
+		}
+		balance = block_a.hashables.balance.number ();
+	}
+	void receive_block (rai::receive_block const & block_a) override
+	{
+		balance += received (block_a.hash (), block_a.hashables.source);
+	}
+	void open_block (rai::open_block const & block_a) override
+	{
+		if (block_a.hashables.account != account)
+		{
+			problem = "open block names another account";
+		}
+		balance = received (block_a.hash (), block_a.hashables.source);
+	}
+	void change_block (rai::change_block const &) override
+	{
+	}
+	void state_block (rai::state_block const & block_a) override
+	{
+		if (block_a.hashables.account != account)
+		{
+			problem = "state block names another account";
+		}
+		balance = block_a.hashables.balance.number ();
+	}
+	// Amount a receive or open block took in, the genesis open block sources the genesis account rather than a block
+	rai::uint128_t received (rai::block_hash const & hash_a, rai::block_hash const & source_a)
+	{
+		rai::uint128_t result (0);
+		if (source_a == rai::genesis_account || ledger.store.block_exists (transaction, source_a))
+		{
+			result = ledger.amount (transaction, hash_a);
+		}
+		else
+		{
+			problem = "source block is missing";
+		}
+		return result;
+	}
+	MDB_txn * transaction;
+	rai::ledger & ledger;
+	rai::account account;
+	rai::uint128_t balance;
+	std::string problem;
+};
+}
+
+rai::ledger_validator::ledger_validator (rai::ledger & ledger_a, unsigned threads_a) :
+ledger (ledger_a),
+threads (threads_a != 0 ? threads_a : std::max (1u, std::thread::hardware_concurrency ())),
+accounts (0),
+blocks (0),
+pending (0),
+failures (0),
+checksum (0)
+{
+}
+
+bool rai::ledger_validator::validate ()
+{
+	auto & store (ledger.store);
+	clear ();
+	std::vector<std::thread> workers;
+	rai::uint256_t step (std::numeric_limits<rai::uint256_t>::max () / threads);
+	for (unsigned i (0); i < threads; ++i)
+	{
+		rai::account begin (step * i);
+		rai::account end (step * (i + 1));
+		auto last (i + 1 == threads);
+		workers.push_back (std::thread ([this, &store, begin, end, last]() {
+			rai::transaction transaction (store.environment, nullptr, false);
+			validate_range (transaction, begin, end, last);
+		}));
+	}
+	for (auto & i : workers)
+	{
+		i.join ();
+	}
+	rai::transaction transaction (store.environment, nullptr, false);
+	validate_tables (transaction);
+	return failures != 0;
+}
+
+bool rai::ledger_validator::validate (MDB_txn * transaction_a)
+{
+	clear ();
+	validate_range (transaction_a, rai::account (0), rai::account (0), true);
+	validate_tables (transaction_a);
+	return failures != 0;
+}
+
+void rai::ledger_validator::clear ()
+{
+	accounts = 0;
+	blocks = 0;
+	pending = 0;
+	failures = 0;
+	errors.clear ();
+	checksum.clear ();
+	weights.clear ();
+}
+
+/**
+ * Compare the counters and the representation table with what the chains added up to
+ */
+void rai::ledger_validator::validate_tables (MDB_txn * transaction_a)
+{
+	auto & store (ledger.store);
+	auto counts (store.block_count (transaction_a));
+	if (counts.sum () != blocks)
+	{
+		error (boost::str (boost::format ("Block counter holds %1% but the chains hold %2% blocks") % counts.sum () % blocks));
+	}
+	auto account_count (store.account_count (transaction_a));
+	if (account_count != accounts)
+	{
+		error (boost::str (boost::format ("Account counter holds %1% but %2% accounts were walked") % account_count % accounts));
+	}
+	auto pending_count (store.pending_count (transaction_a));
+	if (pending_count != pending)
+	{
+		error (boost::str (boost::format ("Pending counter holds %1% but %2% pending entries were walked") % pending_count % pending));
+	}
+	// Compare the representation table itself rather than the cache built from it
+	std::unordered_set<rai::account> stored;
+	for (auto i (store.representation_begin (transaction_a)), n (store.representation_end ()); i != n; ++i)
+	{
+		rai::account representative (i->first.uint256 ());
+		rai::uint128_union weight;
+		rai::bufferstream stream (reinterpret_cast<uint8_t const *> (i->second.data ()), i->second.size ());
+		auto error_l (rai::read (stream, weight));
+		auto existing (weights.find (representative));
+		rai::uint128_t computed (existing != weights.end () ? existing->second : rai::uint128_t (0));
+		if (error_l || weight.number () != computed)
+		{
+			error (boost::str (boost::format ("Representative %1% stores weight %2% but accounts delegate %3%") % representative.to_account () % weight.number ().convert_to<std::string> () % computed.convert_to<std::string> ()));
+		}
+		stored.insert (representative);
+	}
+	for (auto & i : weights)
+	{
+		if (!i.second.is_zero () && stored.find (i.first) == stored.end ())
+		{
+			error (boost::str (boost::format ("Representative %1% has no stored weight but accounts delegate %2%") % i.first.to_account () % i.second.convert_to<std::string> ()));
+		}
+	}
+}
+
+void rai::ledger_validator::validate_range (MDB_txn * transaction_a, rai::account const & begin_a, rai::account const & end_a, bool last_a)
+{
+	auto & store (ledger.store);
+	std::unordered_map<rai::account, rai::uint128_t> weights_l;
+	rai::checksum checksum_l (0);
+	for (auto i (store.latest_begin (transaction_a, begin_a)), n (store.latest_end ()); i != n && (last_a || rai::account (i->first.uint256 ()) < end_a); ++i)
+	{
+		rai::account account (i->first.uint256 ());
+		rai::account_info info (i->second);
+		validate_account (transaction_a, account, info, weights_l);
+		checksum_l ^= info.head;
+	}
+	validate_pending (transaction_a, begin_a, end_a, last_a);
+	std::lock_guard<std::mutex> lock (mutex);
+	for (auto & i : weights_l)
+	{
+		weights[i.first] += i.second;
+	}
+	checksum ^= checksum_l;
+}
+
+void rai::ledger_validator::validate_account (MDB_txn * transaction_a, rai::account const & account_a, rai::account_info const & info_a, std::unordered_map<rai::account, rai::uint128_t> & weights_a)
+{
+	auto & store (ledger.store);
+	auto name (account_a.to_account ());
+	// Walk from head to open reading blocks in place and keeping only their hashes, newest first, so long chains stay small in memory
+	std::vector<rai::block_hash> chain;
+	rai::account representative (0);
+	auto has_representative (false);
+	auto head_type (rai::block_type::invalid);
+	auto hash (info_a.head);
+	auto broken (false);
+	while (!broken && !hash.is_zero ())
+	{
+		auto block (store.block_get_view (transaction_a, hash));
+		if (block.type == rai::block_type::invalid)
+		{
+			error (boost::str (boost::format ("Account %1% is missing block %2%") % name % hash.to_string ()));
+			broken = true;
+		}
+		else if (chain.size () == info_a.block_count)
+		{
+			error (boost::str (boost::format ("Account %1% holds more blocks than its block count %2%") % name % info_a.block_count));
+			broken = true;
+		}
+		else
+		{
+			if (hash == info_a.rep_block)
+			{
+				representative = block.representative ();
+				has_representative = true;
+			}
+			if (chain.empty ())
+			{
+				head_type = block.type;
+			}
+			chain.push_back (hash);
+			hash = block.previous ();
+		}
+	}
+	if (!broken)
+	{
+		if (chain.size () != info_a.block_count)
+		{
+			error (boost::str (boost::format ("Account %1% has block count %2% but its chain holds %3% blocks") % name % info_a.block_count % chain.size ()));
+		}
+		if (chain.empty () || chain.back () != info_a.open_block)
+		{
+			error (boost::str (boost::format ("Account %1% chain does not end at its open block %2%") % name % info_a.open_block.to_string ()));
+		}
+		if (!has_representative)
+		{
+			error (boost::str (boost::format ("Account %1% representative block %2% is not in its chain") % name % info_a.rep_block.to_string ()));
+		}
+		else
+		{
+			weights_a[representative] += info_a.balance.number ();
+		}
+		// Replay balances oldest first, reading each block again, checking successors and blocks_info along the way
+		balance_step step (transaction_a, ledger, account_a);
+		for (auto i (chain.size ()); i > 0 && step.problem.empty (); --i)
+		{
+			auto & current (chain[i - 1]);
+			auto view (store.block_get_view (transaction_a, current));
+			assert (view.type != rai::block_type::invalid);
+			view.block ()->visit (step);
+			rai::block_hash successor (i > 1 ? chain[i - 2] : rai::block_hash (0));
+			if (view.successor () != successor)
+			{
+				error (boost::str (boost::format ("Account %1% block %2% has the wrong successor") % name % current.to_string ()));
+			}
+			rai::block_info block_info;
+			if (!store.block_info_get (transaction_a, current, block_info) && (block_info.account != account_a || block_info.balance.number () != step.balance))
+			{
+				error (boost::str (boost::format ("Account %1% block %2% disagrees with its blocks_info entry") % name % current.to_string ()));
+			}
+			if (!step.problem.empty ())
+			{
+				error (boost::str (boost::format ("Account %1% block %2%: %3%") % name % current.to_string () % step.problem));
+			}
+		}
+		if (step.problem.empty () && step.balance != info_a.balance.number ())
+		{
+			error (boost::str (boost::format ("Account %1% stores balance %2% but its chain adds up to %3%") % name % info_a.balance.number ().convert_to<std::string> () % step.balance.convert_to<std::string> ()));
+		}
+		if (!chain.empty () && head_type != rai::block_type::state && store.frontier_get (transaction_a, info_a.head) != account_a)
+		{
+			error (boost::str (boost::format ("Account %1% head %2% has no frontier entry") % name % info_a.head.to_string ()));
+		}
+		rai::balance_key key (info_a.balance.number (), account_a);
+		auto indexed (store.balance_begin (transaction_a, key));
+		if (indexed == store.balance_end () || !(rai::balance_key (indexed->first) == key))
+		{
+			error (boost::str (boost::format ("Account %1% is missing from the balance index") % name));
+		}
+	}
+	++accounts;
+	blocks += chain.size ();
+}
+
+void rai::ledger_validator::validate_pending (MDB_txn * transaction_a, rai::account const & begin_a, rai::account const & end_a, bool last_a)
+{
+	auto & store (ledger.store);
+	rai::account current (0);
+	rai::pending_totals totals;
+	for (auto i (store.pending_begin (transaction_a, rai::pending_key (begin_a, 0))), n (store.pending_end ()); i != n && (last_a || rai::pending_key (i->first).account < end_a); ++i)
+	{
+		rai::pending_key key (i->first);
+		rai::pending_info info (i->second);
+		if (key.account != current)
+		{
+			if (totals.count != 0)
+			{
+				validate_totals (transaction_a, current, totals);
+			}
+			current = key.account;
+			totals = rai::pending_totals ();
+		}
+		if (!store.block_exists (transaction_a, key.hash))
+		{
+			error (boost::str (boost::format ("Pending entry for %1% refers to missing block %2%") % key.account.to_account () % key.hash.to_string ()));
+		}
+		totals.sum = rai::amount (totals.sum.number () + info.amount.number ());
+		++totals.count;
+		++pending;
+	}
+	if (totals.count != 0)
+	{
+		validate_totals (transaction_a, current, totals);
+	}
+}
+
+void rai::ledger_validator::validate_totals (MDB_txn * transaction_a, rai::account const & account_a, rai::pending_totals const & totals_a)
+{
+	if (!(ledger.store.pending_totals_get (transaction_a, account_a) == totals_a))
+	{
+		error (boost::str (boost::format ("Account %1% pending totals disagree with its %2% pending entries") % account_a.to_account () % totals_a.count));
+	}
+}
+
+void rai::ledger_validator::error (std::string const & error_a)
+{
+	std::lock_guard<std::mutex> lock (mutex);
+	++failures;
+	if (errors.size () < errors_max)
+	{
+		errors.push_back (error_a);
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <badem/common.hpp>
+
+#include <atomic>
+#include <mutex>
+
+namespace rai
+{
+class ledger;
+/**
+ * Offline consistency check of the ledger tables.
+ * The account space is split in to one range per thread and each thread walks the chains of its accounts, checking them against
+ * account info, successors, blocks_info, frontiers, the balance index and pending totals while summing representation and the checksum.
+ */
+class ledger_validator
+{
+public:
+	ledger_validator (rai::ledger &, unsigned = 0);
+	bool validate ();
+	// Validate the ledger as the given transaction sees it, in the calling thread
+	bool validate (MDB_txn *);
+	static size_t const errors_max = 1000;
+	rai::ledger & ledger;
+	unsigned threads;
+	std::atomic<uint64_t> accounts;
+	std::atomic<uint64_t> blocks;
+	std::atomic<uint64_t> pending;
+	// Number of inconsistencies found, only the first errors_max are described in errors
+	uint64_t failures;
+	std::vector<std::string> errors;
+	// XOR of every account head, the value the checksum table is meant to hold
+	rai::checksum checksum;
+
+private:
+	void clear ();
+	void validate_range (MDB_txn *, rai::account const &, rai::account const &, bool);
+	void validate_tables (MDB_txn *);
+	void validate_account (MDB_txn *, rai::account const &, rai::account_info const &, std::unordered_map<rai::account, rai::uint128_t> &);
+	void validate_pending (MDB_txn *, rai::account const &, rai::account const &, bool);
+	void validate_totals (MDB_txn *, rai::account const &, rai::pending_totals const &);
+	void error (std::string const &);
+	std::mutex mutex;
+	std::unordered_map<rai::account, rai::uint128_t> weights;
+};
+}
@@ -1,4 +1,5 @@
 #include <badem/lib/blocks.hpp>
+#include <badem/lib/utility.hpp>
 
 #include <boost/endian/conversion.hpp>
 
@@ -57,7 +58,58 @@ std::string rai::block::to_json ()
 	return result;
 }
 
+thread_local uint64_t rai::block::hash_cache_hits (0);
+
+rai::block::block () :
+cached_hash (0),
+cached_state (0)
+{
+}
+
+rai::block::block (rai::block const & other_a) :
+cached_hash (other_a.cached_state.load (std::memory_order_acquire) == 2 ? other_a.cached_hash : rai::block_hash (0)),
+cached_state (other_a.cached_state.load (std::memory_order_acquire) == 2 ? 2 : 0)
+{
+}
+
+rai::block & rai::block::operator= (rai::block const & other_a)
+{
+	auto cached (other_a.cached_state.load (std::memory_order_acquire) == 2);
+	cached_hash = cached ? other_a.cached_hash : rai::block_hash (0);
+	cached_state.store (cached ? 2 : 0, std::memory_order_release);
+	return *this;
+}
+
+/**
+ * The first caller to claim the cache stores the hash, callers racing it compute their own copy instead of waiting
+ */
 rai::block_hash rai::block::hash () const
+{
+	rai::block_hash result;
+	if (cached_state.load (std::memory_order_acquire) == 2)
+	{
+		result = cached_hash;
+		++hash_cache_hits;
+	}
+	else
+	{
+		result = hash_compute ();
+		uint8_t empty (0);
+		if (cached_state.compare_exchange_strong (empty, 1, std::memory_order_acq_rel))
+		{
+			cached_hash = result;
+			cached_state.store (2, std::memory_order_release);
+		}
+	}
+	return result;
+}
+
+void rai::block::refresh ()
+{
+	cached_state.store (0, std::memory_order_release);
+}
+
+rai::block_hash rai::block::hash_compute () const
 {
 	rai::uint256_union result;
 	blake2b_state hash_l;
@@ -173,6 +225,7 @@ void rai::send_block::serialize_json (std::string & string_a) const
 
 bool rai::send_block::deserialize (rai::stream & stream_a)
 {
+	refresh ();
 	auto error (false);
 	error = read (stream_a, hashables.previous.bytes);
 	if (!error)
@@ -196,6 +249,7 @@ bool rai::send_block::deserialize (rai::stream & stream_a)
 
 bool rai::send_block::deserialize_json (boost::property_tree::ptree const & tree_a)
 {
+	refresh ();
 	auto error (false);
 	try
 	{
@@ -484,6 +538,7 @@ void rai::open_block::serialize_json (std::string & string_a) const
 
 bool rai::open_block::deserialize (rai::stream & stream_a)
 {
+	refresh ();
 	auto error (read (stream_a, hashables.source));
 	if (!error)
 	{
@@ -506,6 +561,7 @@ bool rai::open_block::deserialize (rai::stream & stream_a)
 
 bool rai::open_block::deserialize_json (boost::property_tree::ptree const & tree_a)
 {
+	refresh ();
 	auto error (false);
 	try
 	{
@@ -716,6 +772,7 @@ void rai::change_block::serialize_json (std::string & string_a) const
 
 bool rai::change_block::deserialize (rai::stream & stream_a)
 {
+	refresh ();
 	auto error (read (stream_a, hashables.previous));
 	if (!error)
 	{
@@ -734,6 +791,7 @@ bool rai::change_block::deserialize (rai::stream & stream_a)
 
 bool rai::change_block::deserialize_json (boost::property_tree::ptree const & tree_a)
 {
+	refresh ();
 	auto error (false);
 	try
 	{
@@ -1000,6 +1058,7 @@ void rai::state_block::serialize_json (std::string & string_a) const
 
 bool rai::state_block::deserialize (rai::stream & stream_a)
 {
+	refresh ();
 	auto error (read (stream_a, hashables.account));
 	if (!error)
 	{
@@ -1031,6 +1090,7 @@ bool rai::state_block::deserialize (rai::stream & stream_a)
 
 bool rai::state_block::deserialize_json (boost::property_tree::ptree const & tree_a)
 {
+	refresh ();
 	auto error (false);
 	try
 	{
@@ -1195,6 +1255,32 @@ std::unique_ptr<rai::block> rai::deserialize_block (rai::stream & stream_a)
 	return result;
 }
 
+size_t rai::block_size (rai::block_type type_a)
+{
+	size_t result (0);
+	switch (type_a)
+	{
+		case rai::block_type::send:
+			result = rai::send_block::size;
+			break;
+		case rai::block_type::receive:
+			result = rai::receive_block::size;
+			break;
+		case rai::block_type::open:
+			result = rai::open_block::size;
+			break;
+		case rai::block_type::change:
+			result = rai::change_block::size;
+			break;
+		case rai::block_type::state:
+			result = rai::state_block::size;
+			break;
+		default:
+			break;
+	}
+	return result;
+}
+
 std::unique_ptr<rai::block> rai::deserialize_block (rai::stream & stream_a, rai::block_type type_a)
 {
 	std::unique_ptr<rai::block> result;
@@ -1257,6 +1343,48 @@ std::unique_ptr<rai::block> rai::deserialize_block (rai::stream & stream_a, rai:
 	return result;
 }
 
+namespace
+{
+template <typename T>
+std::shared_ptr<rai::block> deserialize_pooled (rai::stream & stream_a)
+{
+	bool error;
+	std::shared_ptr<rai::block> result (std::allocate_shared<T> (rai::pool_allocator<T> (), error, stream_a));
+	if (error)
+	{
+		result.reset ();
+	}
+	return result;
+}
+}
+
+std::shared_ptr<rai::block> rai::deserialize_block_pooled (rai::stream & stream_a, rai::block_type type_a)
+{
+	std::shared_ptr<rai::block> result;
+	switch (type_a)
+	{
+		case rai::block_type::receive:
+			result = deserialize_pooled<rai::receive_block> (stream_a);
+			break;
+		case rai::block_type::send:
+			result = deserialize_pooled<rai::send_block> (stream_a);
+			break;
+		case rai::block_type::open:
+			result = deserialize_pooled<rai::open_block> (stream_a);
+			break;
+		case rai::block_type::change:
+			result = deserialize_pooled<rai::change_block> (stream_a);
+			break;
+		case rai::block_type::state:
+			result = deserialize_pooled<rai::state_block> (stream_a);
+			break;
+		default:
+			assert (false);
+			break;
+	}
+	return result;
+}
+
 void rai::receive_block::visit (rai::block_visitor & visitor_a) const
 {
 	visitor_a.receive_block (*this);
@@ -1270,6 +1398,7 @@ bool rai::receive_block::operator== (rai::receive_block const & other_a) const
 
 bool rai::receive_block::deserialize (rai::stream & stream_a)
 {
+	refresh ();
 	auto error (false);
 	error = read (stream_a, hashables.previous.bytes);
 	if (!error)
@@ -1289,6 +1418,7 @@ bool rai::receive_block::deserialize (rai::stream & stream_a)
 
 bool rai::receive_block::deserialize_json (boost::property_tree::ptree const & tree_a)
 {
+	refresh ();
 	auto error (false);
 	try
 	{
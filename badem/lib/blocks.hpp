@@ -3,6 +3,7 @@
 #include <badem/lib/numbers.hpp>
 
 #include <assert.h>
+#include <atomic>
 #include <blake2/blake2.h>
 #include <boost/property_tree/json_parser.hpp>
 #include <streambuf>
@@ -42,8 +43,13 @@ enum class block_type : uint8_t
 class block
 {
 public:
-	// Return a digest of the hashables in this block.
+	block ();
+	block (rai::block const &);
+	rai::block & operator= (rai::block const &);
+	// Return a digest of the hashables in this block, computed on first use and cached
 	rai::block_hash hash () const;
+	// Drop the cached hash, needed after hashables are modified in place
+	void refresh ();
 	std::string to_json ();
 	virtual void hash (blake2b_state &) const = 0;
 	virtual uint64_t block_work () const = 0;
@@ -64,6 +70,15 @@ public:
 	virtual void signature_set (rai::uint512_union const &) = 0;
 	virtual ~block () = default;
 	virtual bool valid_predecessor (rai::block const &) const = 0;
+	// Number of hash () calls made by this thread and answered from the cache since the last time it was taken
+	// Counted per thread so readers on different cores don't contend on one cache line
+	static thread_local uint64_t hash_cache_hits;
+
+private:
+	rai::block_hash hash_compute () const;
+	mutable rai::block_hash cached_hash;
+	// 0 while empty, 1 while one thread stores the hash, 2 once it's readable
+	mutable std::atomic<uint8_t> cached_state;
 };
 class send_hashables
 {
@@ -297,6 +312,10 @@ public:
 };
 std::unique_ptr<rai::block> deserialize_block (rai::stream &);
 std::unique_ptr<rai::block> deserialize_block (rai::stream &, rai::block_type);
+// Serialized size of a block of the given type, 0 for types that aren't blocks
+size_t block_size (rai::block_type);
+// Deserializes in to memory from the block pools, for blocks arriving in network messages
+std::shared_ptr<rai::block> deserialize_block_pooled (rai::stream &, rai::block_type);
 std::unique_ptr<rai::block> deserialize_block_json (boost::property_tree::ptree const &);
 void serialize_block (rai::stream &, rai::block const &);
 }
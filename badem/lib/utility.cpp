@@ -0,0 +1,48 @@
+#include <badem/lib/utility.hpp>
+
+std::atomic<uint64_t> rai::pool_counters::allocated (0);
+std::atomic<uint64_t> rai::pool_counters::reused (0);
+std::mutex rai::buffer_pool::mutex;
+std::vector<std::vector<uint8_t> *> rai::buffer_pool::free;
+
+std::shared_ptr<std::vector<uint8_t>> rai::buffer_pool::get ()
+{
+	std::vector<uint8_t> * buffer (nullptr);
+	{
+		std::lock_guard<std::mutex> lock (mutex);
+		if (!free.empty ())
+		{
+			buffer = free.back ();
+			free.pop_back ();
+		}
+	}
+	if (buffer == nullptr)
+	{
+		buffer = new std::vector<uint8_t>;
+		++rai::pool_counters::allocated;
+	}
+	else
+	{
+		++rai::pool_counters::reused;
+	}
+	return std::shared_ptr<std::vector<uint8_t>> (buffer, [](std::vector<uint8_t> * buffer_a) { rai::buffer_pool::release (buffer_a); }, rai::pool_allocator<std::vector<uint8_t>> ());
+}
+
+void rai::buffer_pool::release (std::vector<uint8_t> * buffer_a)
+{
+	auto pooled (false);
+	buffer_a->clear ();
+	if (buffer_a->capacity () <= capacity_max)
+	{
+		std::lock_guard<std::mutex> lock (mutex);
+		if (free.size () < free_max)
+		{
+			free.push_back (buffer_a);
+			pooled = true;
+		}
+	}
+	if (!pooled)
+	{
+		delete buffer_a;
+	}
+}
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <vector>
@@ -29,4 +33,221 @@ public:
 	std::mutex mutex;
 	std::vector<std::function<void(T...)>> observers;
 };
+/**
+ * Allocations made by every pool, across all sizes
+ */
+class pool_counters
+{
+public:
+	// Served from the heap because no released memory was waiting
+	static std::atomic<uint64_t> allocated;
+	// Served from memory released earlier
+	static std::atomic<uint64_t> reused;
+};
+/**
+ * Free list of memory blocks of one size, shared by every pool_allocator allocating that size.
+ * Released blocks are kept for reuse, up to free_max of them, instead of going back to the heap.
+ * Each thread keeps up to cache_max blocks of its own and only takes the shared lock to move half of them at a time.
+ */
+template <size_t Size>
+class object_pool
+{
+public:
+	static void * allocate ()
+	{
+		void * result (nullptr);
+		auto cache (local ());
+		if (cache != nullptr)
+		{
+			if (cache->blocks.empty ())
+			{
+				instance ().take (cache->blocks, cache_max / 2);
+			}
+			if (!cache->blocks.empty ())
+			{
+				result = cache->blocks.back ();
+				cache->blocks.pop_back ();
+			}
+		}
+		else
+		{
+			auto & pool (instance ());
+			std::lock_guard<std::mutex> lock (pool.mutex);
+			if (!pool.free.empty ())
+			{
+				result = pool.free.back ();
+				pool.free.pop_back ();
+			}
+		}
+		if (result == nullptr)
+		{
+			result = ::operator new (Size);
+			++rai::pool_counters::allocated;
+		}
+		else
+		{
+			++rai::pool_counters::reused;
+		}
+		return result;
+	}
+	static void deallocate (void * object_a)
+	{
+		auto cache (local ());
+		if (cache != nullptr)
+		{
+			if (cache->blocks.size () >= cache_max)
+			{
+				instance ().give (cache->blocks, cache_max / 2);
+			}
+			cache->blocks.push_back (object_a);
+		}
+		else
+		{
+			auto & pool (instance ());
+			std::unique_lock<std::mutex> lock (pool.mutex);
+			if (pool.free.size () < free_max)
+			{
+				pool.free.push_back (object_a);
+			}
+			else
+			{
+				lock.unlock ();
+				::operator delete (object_a);
+			}
+		}
+	}
+	// Never destroyed so objects released during static destruction still have somewhere to go
+	static object_pool & instance ()
+	{
+		static object_pool * result (new object_pool);
+		return *result;
+	}
+	// Move up to count blocks from the shared list to the end of blocks_a
+	void take (std::vector<void *> & blocks_a, size_t count_a)
+	{
+		std::lock_guard<std::mutex> lock (mutex);
+		auto count (std::min (count_a, free.size ()));
+		blocks_a.insert (blocks_a.end (), free.end () - count, free.end ());
+		free.resize (free.size () - count);
+	}
+	// Move count blocks from the end of blocks_a to the shared list, freeing those past free_max
+	void give (std::vector<void *> & blocks_a, size_t count_a)
+	{
+		assert (count_a <= blocks_a.size ());
+		std::vector<void *> excess;
+		{
+			std::lock_guard<std::mutex> lock (mutex);
+			for (auto i (blocks_a.end () - count_a), n (blocks_a.end ()); i != n; ++i)
+			{
+				if (free.size () < free_max)
+				{
+					free.push_back (*i);
+				}
+				else
+				{
+					excess.push_back (*i);
+				}
+			}
+		}
+		blocks_a.resize (blocks_a.size () - count_a);
+		for (auto i : excess)
+		{
+			::operator delete (i);
+		}
+	}
+	static size_t const free_max = 4096;
+	static size_t const cache_max = 64;
+	std::mutex mutex;
+	std::vector<void *> free;
+
+private:
+	class cache
+	{
+	public:
+		cache ()
+		{
+			blocks.reserve (cache_max);
+		}
+		~cache ()
+		{
+			exited () = true;
+			instance ().give (blocks, blocks.size ());
+		}
+		std::vector<void *> blocks;
+	};
+	// This thread's cache, or null once it was handed back at thread exit and the shared list is used directly
+	static cache * local ()
+	{
+		cache * result (nullptr);
+		if (!exited ())
+		{
+			static thread_local cache cache_l;
+			result = &cache_l;
+		}
+		return result;
+	}
+	static bool & exited ()
+	{
+		static thread_local bool result (false);
+		return result;
+	}
+};
+/**
+ * Allocator drawing single objects from the object_pool for their size, for use with std::allocate_shared.
+ * Arrays go straight to the heap.
+ */
+template <typename T>
+class pool_allocator
+{
+public:
+	using value_type = T;
+	pool_allocator () = default;
+	template <typename U>
+	pool_allocator (rai::pool_allocator<U> const &)
+	{
+	}
+	T * allocate (size_t count_a)
+	{
+		return static_cast<T *> (count_a == 1 ? rai::object_pool<sizeof (T)>::allocate () : ::operator new (count_a * sizeof (T)));
+	}
+	void deallocate (T * object_a, size_t count_a)
+	{
+		if (count_a == 1)
+		{
+			rai::object_pool<sizeof (T)>::deallocate (object_a);
+		}
+		else
+		{
+			::operator delete (object_a);
+		}
+	}
+	template <typename U>
+	bool operator== (rai::pool_allocator<U> const &) const
+	{
+		return true;
+	}
+	template <typename U>
+	bool operator!= (rai::pool_allocator<U> const &) const
+	{
+		return false;
+	}
+};
+/**
+ * Send buffers whose storage is kept once the last holder lets go, so serializing a message reuses an earlier message's capacity
+ */
+class buffer_pool
+{
+public:
+	// Empty buffer, returned to the pool when the last copy of the pointer is released
+	static std::shared_ptr<std::vector<uint8_t>> get ();
+	static void release (std::vector<uint8_t> *);
+	// Enough for the sends in flight on a busy node, at most 256KB is kept
+	static size_t const free_max = 256;
+	// The pooled sends are single messages well under this, buffers that grew past it are freed rather than pinned
+	static size_t const capacity_max = 1024;
+
+private:
+	static std::mutex mutex;
+	static std::vector<std::vector<uint8_t> *> free;
+};
 }
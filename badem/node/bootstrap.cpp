@@ -12,7 +12,13 @@ constexpr double bootstrap_minimum_frontier_blocks_per_sec = 1000.0;
 constexpr unsigned bootstrap_frontier_retry_limit = 16;
 constexpr double bootstrap_minimum_termination_time_sec = 30.0;
 constexpr unsigned bootstrap_max_new_connections = 10;
+constexpr double bootstrap_connection_adapt_interval_sec = 5.0;
 constexpr unsigned bulk_push_cost_limit = 200;
+constexpr size_t bootstrap_pull_pipeline_depth = 4;
+constexpr unsigned bulk_pull_batch_blocks = 512;
+constexpr size_t bulk_pull_batch_bytes = 64 * 1024;
+constexpr unsigned frontier_req_batch_frontiers = 1024;
+constexpr size_t frontier_req_client_flush_size = 1024;
 
 rai::socket::socket (std::shared_ptr<rai::node> node_a) :
 socket_m (node_a->service),
@@ -95,7 +101,10 @@ endpoint (endpoint_a),
 start_time (std::chrono::steady_clock::now ()),
 block_count (0),
 pending_stop (false),
-hard_stop (false)
+hard_stop (false),
+connected (false),
+latency (0),
+pulls_outstanding (0)
 {
 	++attempt->connections;
 	receive_buffer->resize (256);
@@ -103,6 +112,10 @@ hard_stop (false)
 
 rai::bootstrap_client::~bootstrap_client ()
 {
+	if (connected)
+	{
+		node->peers.bootstrap_completed (rai::endpoint (endpoint.address (), endpoint.port ()), latency, block_count, block_rate ());
+	}
 	--attempt->connections;
 }
 
@@ -136,10 +149,16 @@ void rai::bootstrap_client::run ()
 			{
 				BOOST_LOG (this_l->node->log) << boost::str (boost::format ("Connection established to %1%") % this_l->endpoint);
 			}
+			this_l->latency = std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::steady_clock::now () - this_l->start_time);
+			this_l->connected = true;
 			this_l->attempt->pool_connection (this_l->shared_from_this ());
 		}
 		else
 		{
+			if (ec != boost::asio::error::operation_aborted)
+			{
+				this_l->node->peers.bootstrap_failed (rai::endpoint (this_l->endpoint.address (), this_l->endpoint.port ()));
+			}
 			if (this_l->node->config.logging.network_logging ())
 			{
 				switch (ec.value ())
@@ -198,7 +217,8 @@ count (0),
 bulk_push_cost (0)
 {
 	rai::transaction transaction (connection->node->store.environment, nullptr, false);
-	next (transaction);
+	auto iterator (connection->node->store.latest_begin (transaction));
+	position (iterator);
 }
 
 rai::frontier_req_client::~frontier_req_client ()
@@ -226,11 +246,11 @@ void rai::frontier_req_client::receive_frontier ()
 	});
 }
 
-void rai::frontier_req_client::unsynced (MDB_txn * transaction_a, rai::block_hash const & head, rai::block_hash const & end)
+void rai::frontier_req_client::unsynced (rai::block_hash const & head, rai::block_hash const & end)
 {
 	if (bulk_push_cost < bulk_push_cost_limit)
 	{
-		connection->attempt->add_bulk_push_target (head, end);
+		bulk_push_targets.push_back (std::make_pair (head, end));
 		if (end.is_zero ())
 		{
 			bulk_push_cost += 2;
@@ -260,12 +280,14 @@ void rai::frontier_req_client::received_frontier (boost::system::error_code cons
 			start_time = std::chrono::steady_clock::now ();
 		}
 		++count;
+		++connection->attempt->frontiers_received;
 		std::chrono::duration<double> time_span = std::chrono::duration_cast<std::chrono::duration<double>> (std::chrono::steady_clock::now () - start_time);
 		double elapsed_sec = time_span.count ();
 		double blocks_per_sec = (double)count / elapsed_sec;
 		if (elapsed_sec > bootstrap_connection_warmup_time_sec && blocks_per_sec < bootstrap_minimum_frontier_blocks_per_sec)
 		{
 			BOOST_LOG (connection->node->log) << boost::str (boost::format ("Aborting frontier req because it was too slow"));
+			flush ();
 			promise.set_value (true);
 			return;
 		}
@@ -275,62 +297,71 @@ void rai::frontier_req_client::received_frontier (boost::system::error_code cons
 		}
 		if (!account.is_zero ())
 		{
-			while (!current.is_zero () && current < account)
-			{
-				// We know about an account they don't.
-				rai::transaction transaction (connection->node->store.environment, nullptr, true);
-				unsynced (transaction, info.head, 0);
-				next (transaction);
-			}
-			if (!current.is_zero ())
 			{
-				if (account == current)
+				// Each frontier is merged under its own snapshot so nothing is held while waiting on the peer
+				rai::transaction transaction (connection->node->store.environment, nullptr, false);
+				auto iterator (seek (transaction));
+				while (!current.is_zero () && current < account)
 				{
-					rai::transaction transaction (connection->node->store.environment, nullptr, true);
-					if (latest == info.head)
-					{
-						// In sync
-					}
-					else
+					// We know about an account they don't.
+					unsynced (info.head, 0);
+					next (iterator);
+				}
+				if (!current.is_zero ())
+				{
+					if (account == current)
 					{
-						if (connection->node->store.block_exists (transaction, latest))
+						if (latest == info.head)
 						{
-							// We know about a block they don't.
-							unsynced (transaction, info.head, latest);
+							// In sync
 						}
 						else
 						{
-							connection->attempt->add_pull (rai::pull_info (account, latest, info.head));
-							// Either we're behind or there's a fork we differ on
-							// Either way, bulk pushing will probably not be effective
-							bulk_push_cost += 5;
+							if (connection->node->store.block_exists (transaction, latest))
+							{
+								// We know about a block they don't.
+								unsynced (info.head, latest);
+							}
+							else
+							{
+								pulls.push_back (rai::pull_info (account, latest, info.head));
+								// Either we're behind or there's a fork we differ on
+								// Either way, bulk pushing will probably not be effective
+								bulk_push_cost += 5;
+							}
 						}
+						next (iterator);
+					}
+					else
+					{
+						assert (account < current);
+						pulls.push_back (rai::pull_info (account, latest, rai::block_hash (0)));
 					}
-					next (transaction);
 				}
 				else
 				{
-					assert (account < current);
-					connection->attempt->add_pull (rai::pull_info (account, latest, rai::block_hash (0)));
+					pulls.push_back (rai::pull_info (account, latest, rai::block_hash (0)));
 				}
 			}
-			else
+			if (pulls.size () + bulk_push_targets.size () >= frontier_req_client_flush_size)
 			{
-				connection->attempt->add_pull (rai::pull_info (account, latest, rai::block_hash (0)));
+				flush ();
 			}
 			receive_frontier ();
 		}
 		else
 		{
 			{
-				rai::transaction transaction (connection->node->store.environment, nullptr, true);
+				rai::transaction transaction (connection->node->store.environment, nullptr, false);
+				auto iterator (seek (transaction));
 				while (!current.is_zero ())
 				{
 					// We know about an account they don't.
-					unsynced (transaction, info.head, 0);
-					next (transaction);
+					unsynced (info.head, 0);
+					next (iterator);
 				}
 			}
+			flush ();
 			if (connection->node->config.logging.bulk_pull_logging ())
 			{
 				BOOST_LOG (connection->node->log) << "Bulk push cost: " << bulk_push_cost;
@@ -356,13 +387,25 @@ void rai::frontier_req_client::received_frontier (boost::system::error_code cons
 	}
 }
 
-void rai::frontier_req_client::next (MDB_txn * transaction_a)
+rai::store_iterator rai::frontier_req_client::seek (MDB_txn * transaction_a)
 {
-	auto iterator (connection->node->store.latest_begin (transaction_a, rai::uint256_union (current.number () + 1)));
-	if (iterator != connection->node->store.latest_end ())
+	auto result (current.is_zero () ? connection->node->store.latest_end () : connection->node->store.latest_begin (transaction_a, current));
+	position (result);
+	return result;
+}
+
+void rai::frontier_req_client::next (rai::store_iterator & iterator_a)
+{
+	++iterator_a;
+	position (iterator_a);
+}
+
+void rai::frontier_req_client::position (rai::store_iterator & iterator_a)
+{
+	if (iterator_a != connection->node->store.latest_end ())
 	{
-		current = rai::account (iterator->first.uint256 ());
-		info = rai::account_info (iterator->second);
+		current = rai::account (iterator_a->first.uint256 ());
+		info = rai::account_info (iterator_a->second);
 	}
 	else
 	{
@@ -370,10 +413,29 @@ void rai::frontier_req_client::next (MDB_txn * transaction_a)
 	}
 }
 
+void rai::frontier_req_client::flush ()
+{
+	if (!pulls.empty ())
+	{
+		connection->attempt->add_pulls (pulls);
+		pulls.clear ();
+	}
+	if (!bulk_push_targets.empty ())
+	{
+		connection->attempt->add_bulk_push_targets (bulk_push_targets);
+		bulk_push_targets.clear ();
+	}
+}
+
 rai::bulk_pull_client::bulk_pull_client (std::shared_ptr<rai::bootstrap_client> connection_a, rai::pull_info const & pull_a) :
 connection (connection_a),
-pull (pull_a)
+pull (pull_a),
+lazy_previous (0),
+lazy_link (0),
+lazy_balance (0),
+lazy_known (false)
 {
+	++connection->pulls_outstanding;
 	std::lock_guard<std::mutex> mutex (connection->attempt->mutex);
 	++connection->attempt->pulling;
 	connection->attempt->condition.notify_all ();
@@ -381,8 +443,13 @@ pull (pull_a)
 
 rai::bulk_pull_client::~bulk_pull_client ()
 {
+	ingest ();
 	// If received end block is not expected end block
-	if (expected != pull.end)
+	if (expected == pull.end)
+	{
+		++connection->attempt->pulls_completed;
+	}
+	else
 	{
 		pull.head = expected;
 		connection->attempt->requeue_pull (pull);
@@ -391,32 +458,19 @@ rai::bulk_pull_client::~bulk_pull_client ()
 			BOOST_LOG (connection->node->log) << boost::str (boost::format ("Bulk pull end block is not expected %1% for account %2%") % pull.end.to_string () % pull.account.to_account ());
 		}
 	}
+	--connection->pulls_outstanding;
 	std::lock_guard<std::mutex> mutex (connection->attempt->mutex);
 	--connection->attempt->pulling;
 	connection->attempt->condition.notify_all ();
 }
 
+/**
+ * Send this pull and its successors in one write, the server answers them in order on the same socket
+ */
 void rai::bulk_pull_client::request ()
 {
-	expected = pull.head;
-	rai::bulk_pull req;
-	req.start = pull.account;
-	req.end = pull.end;
 	auto buffer (std::make_shared<std::vector<uint8_t>> ());
-	{
-		rai::vectorstream stream (*buffer);
-		req.serialize (stream);
-	}
-	if (connection->node->config.logging.bulk_pull_logging ())
-	{
-		std::unique_lock<std::mutex> lock (connection->attempt->mutex);
-		BOOST_LOG (connection->node->log) << boost::str (boost::format ("Requesting account %1% from %2%. %3% accounts in queue") % req.start.to_account () % connection->endpoint % connection->attempt->pulls.size ());
-	}
-	else if (connection->node->config.logging.network_logging () && connection->attempt->should_log ())
-	{
-		std::unique_lock<std::mutex> lock (connection->attempt->mutex);
-		BOOST_LOG (connection->node->log) << boost::str (boost::format ("%1% accounts in pull queue") % connection->attempt->pulls.size ());
-	}
+	write_requests (*buffer);
 	auto this_l (shared_from_this ());
 	connection->socket->async_write (buffer, [this_l, buffer](boost::system::error_code const & ec, size_t size_a) {
 		if (!ec)
@@ -433,6 +487,87 @@ void rai::bulk_pull_client::request ()
 	});
 }
 
+void rai::bulk_pull_client::write_requests (std::vector<uint8_t> & buffer_a)
+{
+	for (auto client (this); client != nullptr; client = client->successor.get ())
+	{
+		client->expected = client->pull.head;
+		rai::bulk_pull req;
+		req.start = client->pull.account;
+		req.end = client->pull.end;
+		{
+			rai::vectorstream stream (buffer_a);
+			req.serialize (stream);
+		}
+		if (connection->node->config.logging.bulk_pull_logging ())
+		{
+			std::unique_lock<std::mutex> lock (connection->attempt->mutex);
+			BOOST_LOG (connection->node->log) << boost::str (boost::format ("Requesting account %1% from %2%. %3% accounts in queue") % req.start.to_account () % connection->endpoint % connection->attempt->pulls.size ());
+		}
+	}
+	if (!connection->node->config.logging.bulk_pull_logging () && connection->node->config.logging.network_logging () && connection->attempt->should_log ())
+	{
+		std::unique_lock<std::mutex> lock (connection->attempt->mutex);
+		BOOST_LOG (connection->node->log) << boost::str (boost::format ("%1% accounts in pull queue") % connection->attempt->pulls.size ());
+	}
+}
+
+/**
+ * Called as this pull's response ends with more pulls still in flight behind it. Queued pulls are appended after the last of them
+ * to bring the connection back up to the pipeline depth, and their requests are written before the next response is read so reads
+ * and writes never overlap on the socket. The next response is already on its way so the write costs no round trip.
+ */
+void rai::bulk_pull_client::refill ()
+{
+	assert (successor != nullptr);
+	std::vector<rai::pull_info> batch;
+	{
+		std::unique_lock<std::mutex> lock (connection->attempt->mutex);
+		if (!connection->attempt->stopped && !connection->pending_stop)
+		{
+			// This pull still counts as outstanding until it's destroyed
+			batch = connection->attempt->pipeline_pulls (lock, connection->pulls_outstanding - 1);
+		}
+	}
+	auto next (successor);
+	if (!batch.empty ())
+	{
+		std::shared_ptr<rai::bulk_pull_client> head;
+		for (auto i (batch.rbegin ()), n (batch.rend ()); i != n; ++i)
+		{
+			auto predecessor (std::make_shared<rai::bulk_pull_client> (connection, *i));
+			predecessor->successor = head;
+			head = predecessor;
+		}
+		auto tail (successor);
+		while (tail->successor != nullptr)
+		{
+			tail = tail->successor;
+		}
+		tail->successor = head;
+		auto buffer (std::make_shared<std::vector<uint8_t>> ());
+		head->write_requests (*buffer);
+		auto connection_l (connection);
+		connection->socket->async_write (buffer, [connection_l, next, buffer](boost::system::error_code const & ec, size_t size_a) {
+			if (!ec)
+			{
+				next->receive_block ();
+			}
+			else
+			{
+				if (connection_l->node->config.logging.bulk_pull_logging ())
+				{
+					BOOST_LOG (connection_l->node->log) << boost::str (boost::format ("Error sending bulk pull request to %1%: to %2%") % ec.message () % connection_l->endpoint);
+				}
+			}
+		});
+	}
+	else
+	{
+		next->receive_block ();
+	}
+}
+
 void rai::bulk_pull_client::receive_block ()
 {
 	auto this_l (shared_from_this ());
@@ -495,9 +630,18 @@ void rai::bulk_pull_client::received_type ()
 		case rai::block_type::not_a_block:
 		{
 			// Avoid re-using slow peers, or peers that sent the wrong blocks.
-			if (!connection->pending_stop && expected == pull.end)
+			ingest ();
+			if (expected == pull.end)
 			{
-				connection->attempt->pool_connection (connection);
+				if (successor != nullptr)
+				{
+					// The response to the next pipelined pull follows on the socket
+					refill ();
+				}
+				else if (!connection->pending_stop)
+				{
+					connection->attempt->pool_connection (connection);
+				}
 			}
 			break;
 		}
@@ -536,8 +680,18 @@ void rai::bulk_pull_client::received_block (boost::system::error_code const & ec
 				connection->start_time = std::chrono::steady_clock::now ();
 			}
 			connection->attempt->total_blocks++;
-			connection->attempt->node->block_processor.add (block);
-			if (!connection->hard_stop.load ())
+			if (!lazy_known)
+			{
+				blocks.push_back (block);
+			}
+			if (blocks.size () >= ingest_max)
+			{
+				// Bound memory on long chains, pieces pulled ahead of the ledger still wait in unchecked
+				ingest ();
+			}
+			// Once a lazy pull reaches the ledger the rest of its chain is ours, a pipelined successor's response still has to be read past it
+			auto lazy_done (lazy_known && successor == nullptr);
+			if (!connection->hard_stop.load () && !lazy_done)
 			{
 				receive_block ();
 			}
@@ -559,6 +713,108 @@ void rai::bulk_pull_client::received_block (boost::system::error_code const & ec
 	}
 }
 
+void rai::bulk_pull_client::ingest ()
+{
+	if (connection->attempt->lazy_mode && !lazy_known && !blocks.empty ())
+	{
+		// One read transaction for the whole batch, blocks from the first one the ledger holds onward are dropped
+		rai::transaction transaction (connection->node->store.environment, nullptr, false);
+		auto known (blocks.size ());
+		for (size_t i (0); i < blocks.size () && !lazy_known; ++i)
+		{
+			lazy_links (transaction, *blocks[i]);
+			if (lazy_known)
+			{
+				known = i;
+			}
+		}
+		blocks.resize (known);
+	}
+	if (!blocks.empty ())
+	{
+		connection->node->block_processor.add (blocks);
+		blocks.clear ();
+	}
+}
+
+/**
+ * Queue the sources this block depends on, blocks arrive newest first so a state block's
+ * predecessor is the next block received and tells us whether its link is a receive.
+ * The pull is done once it reaches a block the ledger already holds, the rest of the chain is skipped.
+ */
+void rai::bulk_pull_client::lazy_links (MDB_txn * transaction_a, rai::block const & block_a)
+{
+	auto hash (block_a.hash ());
+	auto exists (connection->node->store.block_exists (transaction_a, hash));
+	if (!lazy_previous.is_zero () && hash == lazy_previous)
+	{
+		// A link is only followed once the predecessor's balance shows the state block is a receive, otherwise it may be a send to an account
+		auto known (true);
+		rai::uint128_t balance (0);
+		switch (block_a.type ())
+		{
+			case rai::block_type::send:
+			{
+				balance = static_cast<rai::send_block const &> (block_a).hashables.balance.number ();
+				break;
+			}
+			case rai::block_type::state:
+			{
+				balance = static_cast<rai::state_block const &> (block_a).hashables.balance.number ();
+				break;
+			}
+			default:
+			{
+				// Legacy blocks don't carry a balance, it's only known once the ledger has them
+				known = exists;
+				balance = exists ? connection->node->ledger.balance (transaction_a, hash) : 0;
+				break;
+			}
+		}
+		if (known && lazy_balance.number () > balance)
+		{
+			connection->attempt->lazy_add (transaction_a, lazy_link);
+		}
+		lazy_previous.clear ();
+	}
+	if (exists)
+	{
+		lazy_known = true;
+		expected = pull.end;
+	}
+	else
+	{
+		switch (block_a.type ())
+		{
+			case rai::block_type::receive:
+			case rai::block_type::open:
+			{
+				connection->attempt->lazy_add (transaction_a, block_a.source ());
+				break;
+			}
+			case rai::block_type::state:
+			{
+				auto const & state (static_cast<rai::state_block const &> (block_a));
+				if (state.hashables.previous.is_zero ())
+				{
+					connection->attempt->lazy_add (transaction_a, state.hashables.link);
+				}
+				else if (!state.hashables.link.is_zero ())
+				{
+					lazy_previous = state.hashables.previous;
+					lazy_link = state.hashables.link;
+					lazy_balance = state.hashables.balance;
+				}
+				break;
+			}
+			default:
+			{
+				break;
+			}
+		}
+	}
+}
+
 rai::bulk_push_client::bulk_push_client (std::shared_ptr<rai::bootstrap_client> const & connection_a) :
 connection (connection_a)
 {
@@ -706,7 +962,16 @@ pulling (0),
 node (node_a),
 account_count (0),
 total_blocks (0),
-stopped (false)
+phase (rai::bootstrap_phase::frontiers),
+frontiers_received (0),
+pulls_completed (0),
+pulls_failed (0),
+start_time (std::chrono::steady_clock::now ()),
+stopped (false),
+lazy_mode (false),
+connections_adaptive (std::max (1U, node_a->config.bootstrap_connections)),
+rate_last (0.0),
+adapt_next (std::chrono::steady_clock::now ())
 {
 	BOOST_LOG (node->log) << "Starting bootstrap attempt";
 	node->bootstrap_initiator.notify_listeners (true);
@@ -772,17 +1037,38 @@ void rai::bootstrap_attempt::request_pull (std::unique_lock<std::mutex> & lock_a
 	auto connection_l (connection (lock_a));
 	if (connection_l)
 	{
-		auto pull (pulls.front ());
-		pulls.pop_front ();
+		auto batch (pipeline_pulls (lock_a, 0));
 		// The bulk_pull_client destructor attempt to requeue_pull which can cause a deadlock if this is the last reference
 		// Dispatch request in an external thread in case it needs to be destroyed
-		node->background ([connection_l, pull]() {
-			auto client (std::make_shared<rai::bulk_pull_client> (connection_l, pull));
+		node->background ([connection_l, batch]() {
+			std::shared_ptr<rai::bulk_pull_client> client;
+			for (auto i (batch.rbegin ()), n (batch.rend ()); i != n; ++i)
+			{
+				auto predecessor (std::make_shared<rai::bulk_pull_client> (connection_l, *i));
+				predecessor->successor = client;
+				client = predecessor;
+			}
 			client->request ();
 		});
 	}
 }
 
+/**
+ * Pipeline several pulls on one connection while there's enough queued to keep every connection busy
+ */
+std::vector<rai::pull_info> rai::bootstrap_attempt::pipeline_pulls (std::unique_lock<std::mutex> & lock_a, unsigned outstanding_a)
+{
+	assert (lock_a.owns_lock ());
+	auto depth (std::min (bootstrap_pull_pipeline_depth, std::max<size_t> (1, pulls.size () / std::max (1U, connections.load ()))));
+	std::vector<rai::pull_info> result;
+	while (result.size () + outstanding_a < depth && !pulls.empty ())
+	{
+		result.push_back (pulls.front ());
+		pulls.pop_front ();
+	}
+	return result;
+}
+
 void rai::bootstrap_attempt::request_push (std::unique_lock<std::mutex> & lock_a)
 {
 	bool error (false);
@@ -830,6 +1116,21 @@ void rai::bootstrap_attempt::run ()
 		auto k = rai::random_pool.GenerateWord32 (0, i);
 		std::swap (pulls[i], pulls[k]);
 	}
+	phase = rai::bootstrap_phase::pulls;
+	run_pulls (lock);
+	if (!stopped)
+	{
+		BOOST_LOG (node->log) << "Completed pulls";
+	}
+	phase = rai::bootstrap_phase::push;
+	request_push (lock);
+	stopped = true;
+	condition.notify_all ();
+	idle.clear ();
+}
+
+void rai::bootstrap_attempt::run_pulls (std::unique_lock<std::mutex> & lock)
+{
 	while (still_pulling ())
 	{
 		while (still_pulling ())
@@ -857,16 +1158,48 @@ void rai::bootstrap_attempt::run ()
 		lock.lock ();
 		BOOST_LOG (node->log) << "Finished flushing unchecked blocks";
 	}
+}
+
+/**
+ * Pull only what the requested hashes depend on, there's no frontier scan and nothing to push
+ */
+void rai::bootstrap_attempt::lazy_run ()
+{
+	phase = rai::bootstrap_phase::lazy;
+	populate_connections ();
+	std::unique_lock<std::mutex> lock (mutex);
+	run_pulls (lock);
 	if (!stopped)
 	{
-		BOOST_LOG (node->log) << "Completed pulls";
+		BOOST_LOG (node->log) << boost::str (boost::format ("Completed lazy pulls, %1% hashes requested") % lazy_keys.size ());
 	}
-	request_push (lock);
 	stopped = true;
 	condition.notify_all ();
 	idle.clear ();
 }
 
+bool rai::bootstrap_attempt::lazy_start (rai::block_hash const & hash_a, rai::block_hash const & end_a)
+{
+	std::lock_guard<std::mutex> lock (mutex);
+	// Pulls queued once the attempt has stopped pulling would never be requested
+	auto result (stopped || phase == rai::bootstrap_phase::push);
+	if (!result && lazy_keys.insert (hash_a).second)
+	{
+		// A pull keyed by block hash walks that block's chain back to end, or to its open block
+		pulls.push_back (rai::pull_info (hash_a, hash_a, end_a));
+		condition.notify_all ();
+	}
+	return result;
+}
+
+void rai::bootstrap_attempt::lazy_add (MDB_txn * transaction_a, rai::block_hash const & hash_a)
+{
+	if (!hash_a.is_zero () && !node->store.block_exists (transaction_a, hash_a))
+	{
+		lazy_start (hash_a);
+	}
+}
+
 std::shared_ptr<rai::bootstrap_client> rai::bootstrap_attempt::connection (std::unique_lock<std::mutex> & lock_a)
 {
 	while (!stopped && idle.empty ())
@@ -917,6 +1250,50 @@ unsigned rai::bootstrap_attempt::target_connections (size_t pulls_remaining)
 	return std::max (1U, (unsigned)(target + 0.5f));
 }
 
+/**
+ * Add connections while the aggregate block rate keeps rising and give them back once it falls off
+ */
+unsigned rai::bootstrap_attempt::adapt_connections (unsigned ceiling_a, double rate_a)
+{
+	std::lock_guard<std::mutex> lock (mutex);
+	auto now (std::chrono::steady_clock::now ());
+	if (now >= adapt_next)
+	{
+		if (connections >= connections_adaptive && rate_a > rate_last * 1.05)
+		{
+			connections_adaptive = std::min (ceiling_a, connections_adaptive + std::max (1U, connections_adaptive / 4));
+		}
+		else if (rate_a < rate_last * 0.8 && connections_adaptive > node->config.bootstrap_connections)
+		{
+			--connections_adaptive;
+		}
+		rate_last = rate_a;
+		adapt_next = now + std::chrono::milliseconds (static_cast<int64_t> (bootstrap_connection_adapt_interval_sec * 1000));
+	}
+	return std::max (1U, std::min (ceiling_a, connections_adaptive));
+}
+
+std::string rai::bootstrap_attempt::phase_string ()
+{
+	std::string result;
+	switch (phase)
+	{
+		case rai::bootstrap_phase::frontiers:
+			result = "frontiers";
+			break;
+		case rai::bootstrap_phase::pulls:
+			result = "pulls";
+			break;
+		case rai::bootstrap_phase::push:
+			result = "push";
+			break;
+		case rai::bootstrap_phase::lazy:
+			result = "lazy";
+			break;
+	}
+	return result;
+}
+
 void rai::bootstrap_attempt::populate_connections ()
 {
 	double rate_sum = 0.0;
@@ -951,7 +1328,9 @@ void rai::bootstrap_attempt::populate_connections ()
 		}
 	}
 
-	auto target = target_connections (num_pulls);
+	auto target = adapt_connections (target_connections (num_pulls), rate_sum);
+	// Sampled once a second so the stat time series tracks sync throughput
+	node->stats.add (rai::stat::type::bootstrap, rai::stat::detail::block_rate, rai::stat::dir::in, static_cast<uint64_t> (rate_sum), true);
 
 	// We only want to drop slow peers when more than 2/3 are active. 2/3 because 1/2 is too aggressive, and 100% rarely happens.
 	// Probably needs more tuning.
@@ -1076,6 +1455,8 @@ void rai::bootstrap_attempt::add_pull (rai::pull_info const & pull)
 
 void rai::bootstrap_attempt::requeue_pull (rai::pull_info const & pull_a)
 {
+	++pulls_failed;
+	node->stats.inc (rai::stat::type::bootstrap, rai::stat::detail::pull_failed, rai::stat::dir::in);
 	auto pull (pull_a);
 	if (++pull.attempts < bootstrap_frontier_retry_limit)
 	{
@@ -1108,10 +1489,17 @@ void rai::bootstrap_attempt::requeue_pull (rai::pull_info const & pull_a)
 	}
 }
 
-void rai::bootstrap_attempt::add_bulk_push_target (rai::block_hash const & head, rai::block_hash const & end)
+void rai::bootstrap_attempt::add_pulls (std::vector<rai::pull_info> const & pulls_a)
+{
+	std::lock_guard<std::mutex> lock (mutex);
+	pulls.insert (pulls.end (), pulls_a.begin (), pulls_a.end ());
+	condition.notify_all ();
+}
+
+void rai::bootstrap_attempt::add_bulk_push_targets (std::vector<std::pair<rai::block_hash, rai::block_hash>> const & targets_a)
 {
 	std::lock_guard<std::mutex> lock (mutex);
-	bulk_push_targets.push_back (std::make_pair (head, end));
+	bulk_push_targets.insert (bulk_push_targets.end (), targets_a.begin (), targets_a.end ());
 }
 
 rai::bootstrap_initiator::bootstrap_initiator (rai::node & node_a) :
@@ -1138,6 +1526,26 @@ void rai::bootstrap_initiator::bootstrap ()
 	}
 }
 
+void rai::bootstrap_initiator::bootstrap_lazy (rai::block_hash const & hash_a, rai::block_hash const & end_a)
+{
+	std::unique_lock<std::mutex> lock (mutex);
+	if (!stopped)
+	{
+		if (attempt == nullptr)
+		{
+			node.stats.inc (rai::stat::type::bootstrap, rai::stat::detail::initiate_lazy, rai::stat::dir::out);
+			attempt = std::make_shared<rai::bootstrap_attempt> (node.shared ());
+			attempt->lazy_mode = true;
+			condition.notify_all ();
+		}
+		// A running frontier attempt picks the hash up as an extra pull
+		if (attempt->lazy_start (hash_a, end_a))
+		{
+			lazy_pending.push_back (std::make_pair (hash_a, end_a));
+		}
+	}
+}
+
 void rai::bootstrap_initiator::bootstrap (rai::endpoint const & endpoint_a, bool add_to_peers)
 {
 	if (add_to_peers)
@@ -1167,9 +1575,27 @@ void rai::bootstrap_initiator::run_bootstrap ()
 		if (attempt != nullptr)
 		{
 			lock.unlock ();
-			attempt->run ();
+			if (attempt->lazy_mode)
+			{
+				attempt->lazy_run ();
+			}
+			else
+			{
+				attempt->run ();
+			}
 			lock.lock ();
 			attempt = nullptr;
+			if (!stopped && !lazy_pending.empty ())
+			{
+				node.stats.inc (rai::stat::type::bootstrap, rai::stat::detail::initiate_lazy, rai::stat::dir::out);
+				attempt = std::make_shared<rai::bootstrap_attempt> (node.shared ());
+				attempt->lazy_mode = true;
+				for (auto & i : lazy_pending)
+				{
+					attempt->lazy_start (i.first, i.second);
+				}
+				lazy_pending.clear ();
+			}
 			condition.notify_all ();
 		}
 		else
@@ -1530,12 +1956,13 @@ void rai::bootstrap_server::run_next ()
  * Handle a request for the pull of all blocks associated with an account
  * The account is supplied as the "start" member, and the final block to
  * send is the "end" member
+ * If "start" isn't an account but a block hash, the chain is sent from that block down
  */
 void rai::bulk_pull_server::set_current_end ()
 {
 	assert (request != nullptr);
-	rai::transaction transaction (connection->node->store.environment, nullptr, false);
-	if (!connection->node->store.block_exists (transaction, request->end))
+	rai::transaction transaction_l (connection->node->store.environment, nullptr, false);
+	if (!connection->node->store.block_exists (transaction_l, request->end))
 	{
 		if (connection->node->config.logging.bulk_pull_logging ())
 		{
@@ -1544,8 +1971,12 @@ void rai::bulk_pull_server::set_current_end ()
 		request->end.clear ();
 	}
 	rai::account_info info;
-	auto no_address (connection->node->store.account_get (transaction, request->start, info));
-	if (no_address)
+	auto no_address (connection->node->store.account_get (transaction_l, request->start, info));
+	if (no_address && connection->node->store.block_exists (transaction_l, request->start))
+	{
+		current = request->start;
+	}
+	else if (no_address)
 	{
 		if (connection->node->config.logging.bulk_pull_logging ())
 		{
@@ -1557,7 +1988,7 @@ void rai::bulk_pull_server::set_current_end ()
 	{
 		if (!request->end.is_zero ())
 		{
-			auto account (connection->node->ledger.account (transaction, request->end));
+			auto account (connection->node->ledger.account (transaction_l, request->end));
 			if (account == request->start)
 			{
 				current = info.head;
@@ -1574,41 +2005,73 @@ void rai::bulk_pull_server::set_current_end ()
 	}
 }
 
+/**
+ * Serialize up to a batch of blocks into a single write, the not_a_block terminator rides along with the last batch.
+ * Each batch is read under its own snapshot which is closed before the write, so a slow peer never pins old pages.
+ */
 void rai::bulk_pull_server::send_next ()
 {
-	std::unique_ptr<rai::block> block (get_next ());
-	if (block != nullptr)
+	send_buffer->clear ();
+	auto finished (false);
 	{
+		rai::transaction transaction (connection->node->store.environment, nullptr, false);
+		for (unsigned count (0); !finished && count < bulk_pull_batch_blocks && send_buffer->size () < bulk_pull_batch_bytes; ++count)
 		{
-			send_buffer->clear ();
+			auto block (get_next_view (transaction));
 			rai::vectorstream stream (*send_buffer);
-			rai::serialize_block (stream, *block);
-		}
-		auto this_l (shared_from_this ());
-		if (connection->node->config.logging.bulk_pull_logging ())
-		{
-			BOOST_LOG (connection->node->log) << boost::str (boost::format ("Sending block: %1%") % block->hash ().to_string ());
+			if (block.type != rai::block_type::invalid)
+			{
+				if (connection->node->config.logging.bulk_pull_logging ())
+				{
+					BOOST_LOG (connection->node->log) << boost::str (boost::format ("Sending block: %1%") % block.hash ().to_string ());
+				}
+				// Blocks are stored in their wire format so the bytes are copied across without building the block
+				rai::write (stream, block.type);
+				auto written (stream.sputn (static_cast<uint8_t const *> (block.value.mv_data), block.size ()));
+				assert (static_cast<size_t> (written) == block.size ());
+				(void)written;
+			}
+			else
+			{
+				if (connection->node->config.logging.bulk_pull_logging ())
+				{
+					BOOST_LOG (connection->node->log) << "Bulk sending finished";
+				}
+				rai::write (stream, static_cast<uint8_t> (rai::block_type::not_a_block));
+				finished = true;
+			}
 		}
+	}
+	auto this_l (shared_from_this ());
+	if (!finished)
+	{
 		connection->socket->async_write (send_buffer, [this_l](boost::system::error_code const & ec, size_t size_a) {
 			this_l->sent_action (ec, size_a);
 		});
 	}
 	else
 	{
-		send_finished ();
+		connection->socket->async_write (send_buffer, [this_l](boost::system::error_code const & ec, size_t size_a) {
+			this_l->no_block_sent (ec, size_a);
+		});
 	}
 }
 
 std::unique_ptr<rai::block> rai::bulk_pull_server::get_next ()
 {
-	std::unique_ptr<rai::block> result;
+	rai::transaction transaction (connection->node->store.environment, nullptr, false);
+	return get_next_view (transaction).block ();
+}
+
+rai::block_view rai::bulk_pull_server::get_next_view (MDB_txn * transaction_a)
+{
+	rai::block_view result;
 	if (current != request->end)
 	{
-		rai::transaction transaction (connection->node->store.environment, nullptr, false);
-		result = connection->node->store.block_get (transaction, current);
-		if (result != nullptr)
+		result = connection->node->store.block_get_view (transaction_a, current);
+		if (result.type != rai::block_type::invalid)
 		{
-			auto previous (result->previous ());
+			auto previous (result.previous ());
 			if (!previous.is_zero ())
 			{
 				current = previous;
@@ -1641,25 +2104,11 @@ void rai::bulk_pull_server::sent_action (boost::system::error_code const & ec, s
 	}
 }
 
-void rai::bulk_pull_server::send_finished ()
-{
-	send_buffer->clear ();
-	send_buffer->push_back (static_cast<uint8_t> (rai::block_type::not_a_block));
-	auto this_l (shared_from_this ());
-	if (connection->node->config.logging.bulk_pull_logging ())
-	{
-		BOOST_LOG (connection->node->log) << "Bulk sending finished";
-	}
-	connection->socket->async_write (send_buffer, [this_l](boost::system::error_code const & ec, size_t size_a) {
-		this_l->no_block_sent (ec, size_a);
-	});
-}
-
 void rai::bulk_pull_server::no_block_sent (boost::system::error_code const & ec, size_t size_a)
 {
 	if (!ec)
 	{
-		assert (size_a == 1);
+		assert (size_a == send_buffer->size ());
 		connection->finish_request ();
 	}
 	else
@@ -1965,7 +2414,7 @@ void rai::bulk_push_server::received_block (boost::system::error_code const & ec
 		auto block (rai::deserialize_block (stream, type_a));
 		if (block != nullptr && !rai::work_validate (*block))
 		{
-			connection->node->process_active (std::move (block));
+			connection->node->process_active (std::move (block), rai::block_origin::bootstrap);
 			receive ();
 		}
 		else
@@ -1983,73 +2432,72 @@ connection (connection_a),
 current (request_a->start.number () - 1),
 info (0, 0, 0, 0, 0, 0),
 request (std::move (request_a)),
-send_buffer (std::make_shared<std::vector<uint8_t>> ())
+send_buffer (std::make_shared<std::vector<uint8_t>> ()),
+count (0),
+start_time (std::chrono::steady_clock::now ()),
+sent (0)
 {
 	next ();
-	skip_old ();
-}
-
-void rai::frontier_req_server::skip_old ()
-{
-	if (request->age != std::numeric_limits<decltype (request->age)>::max ())
-	{
-		auto now (rai::seconds_since_epoch ());
-		while (!current.is_zero () && (now - info.modified) >= request->age)
-		{
-			next ();
-		}
-	}
 }
 
+/**
+ * Write a batch of (account, head) pairs at a time, the zero terminator is appended to the last batch.
+ * Each batch is read under its own transaction that seeks back to current, so a slow peer never holds a snapshot across a write.
+ */
 void rai::frontier_req_server::send_next ()
 {
-	if (!current.is_zero ())
+	send_buffer->clear ();
+	unsigned batch (0);
 	{
+		rai::transaction transaction (connection->node->store.environment, nullptr, false);
+		auto iterator (current.is_zero () ? connection->node->store.latest_end () : connection->node->store.latest_begin (transaction, current));
+		load (iterator);
+		rai::vectorstream stream (*send_buffer);
+		for (; !current.is_zero () && batch < frontier_req_batch_frontiers; ++batch)
 		{
-			send_buffer->clear ();
-			rai::vectorstream stream (*send_buffer);
+			if (connection->node->config.logging.bulk_pull_logging ())
+			{
+				BOOST_LOG (connection->node->log) << boost::str (boost::format ("Sending frontier for %1% %2%") % current.to_account () % info.head.to_string ());
+			}
 			write (stream, current.bytes);
 			write (stream, info.head.bytes);
+			++iterator;
+			load (iterator);
 		}
-		auto this_l (shared_from_this ());
-		if (connection->node->config.logging.bulk_pull_logging ())
+		if (current.is_zero ())
 		{
-			BOOST_LOG (connection->node->log) << boost::str (boost::format ("Sending frontier for %1% %2%") % current.to_account () % info.head.to_string ());
+			rai::uint256_union zero (0);
+			write (stream, zero.bytes);
+			write (stream, zero.bytes);
 		}
-		next ();
+	}
+	sent += batch;
+	connection->node->stats.add (rai::stat::type::bootstrap, rai::stat::detail::frontiers_sent, rai::stat::dir::out, batch);
+	auto this_l (shared_from_this ());
+	if (!current.is_zero ())
+	{
 		connection->socket->async_write (send_buffer, [this_l](boost::system::error_code const & ec, size_t size_a) {
 			this_l->sent_action (ec, size_a);
 		});
 	}
 	else
 	{
-		send_finished ();
-	}
-}
-
-void rai::frontier_req_server::send_finished ()
-{
-	{
-		send_buffer->clear ();
-		rai::vectorstream stream (*send_buffer);
-		rai::uint256_union zero (0);
-		write (stream, zero.bytes);
-		write (stream, zero.bytes);
-	}
-	auto this_l (shared_from_this ());
-	if (connection->node->config.logging.network_logging ())
-	{
-		BOOST_LOG (connection->node->log) << "Frontier sending finished";
+		if (connection->node->config.logging.network_logging ())
+		{
+			BOOST_LOG (connection->node->log) << "Frontier sending finished";
+		}
+		connection->socket->async_write (send_buffer, [this_l](boost::system::error_code const & ec, size_t size_a) {
+			this_l->no_block_sent (ec, size_a);
+		});
 	}
-	connection->socket->async_write (send_buffer, [this_l](boost::system::error_code const & ec, size_t size_a) {
-		this_l->no_block_sent (ec, size_a);
-	});
 }
 
 void rai::frontier_req_server::no_block_sent (boost::system::error_code const & ec, size_t size_a)
 {
 	if (!ec)
 	{
+		auto elapsed (std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::steady_clock::now () - start_time).count ());
+		connection->node->stats.add (rai::stat::type::bootstrap, rai::stat::detail::frontier_rate, rai::stat::dir::out, sent * 1000 / std::max<uint64_t> (elapsed, 1), true);
 		connection->finish_request ();
 	}
 	else
@@ -2076,17 +2524,32 @@ void rai::frontier_req_server::sent_action (boost::system::error_code const & ec
 	}
 }
 
+// Move to the first account after current
 void rai::frontier_req_server::next ()
 {
 	rai::transaction transaction (connection->node->store.environment, nullptr, false);
 	auto iterator (connection->node->store.latest_begin (transaction, current.number () + 1));
-	if (iterator != connection->node->store.latest_end ())
-	{
-		current = rai::uint256_union (iterator->first.uint256 ());
-		info = rai::account_info (iterator->second);
-	}
-	else
+	load (iterator);
+}
+
+// Take current and info from the first account at or past the iterator that was modified within the requested age, current is zero past the last account
+void rai::frontier_req_server::load (rai::store_iterator & iterator_a)
+{
+	auto now (rai::seconds_since_epoch ());
+	auto all (request->age == std::numeric_limits<decltype (request->age)>::max ());
+	auto n (connection->node->store.latest_end ());
+	current.clear ();
+	while (current.is_zero () && iterator_a != n)
 	{
-		current.clear ();
+		rai::account_info info_l (iterator_a->second);
+		if (all || (now - info_l.modified) < request->age)
+		{
+			current = rai::uint256_union (iterator_a->first.uint256 ());
+			info = info_l;
+		}
+		else
+		{
+			++iterator_a;
+		}
 	}
 }
@@ -23,6 +23,13 @@ enum class sync_result
 	error,
 	fork
 };
+enum class bootstrap_phase : uint8_t
+{
+	frontiers,
+	pulls,
+	push,
+	lazy
+};
 class socket : public std::enable_shared_from_this<rai::socket>
 {
 public:
@@ -66,11 +73,18 @@ public:
 	bootstrap_attempt (std::shared_ptr<rai::node> node_a);
 	~bootstrap_attempt ();
 	void run ();
+	void run_pulls (std::unique_lock<std::mutex> &);
+	void lazy_run ();
+	// Queue a pull for the chain ending in hash, back to end if we hold part of it. Returns true if the attempt is past its pulls
+	bool lazy_start (rai::block_hash const &, rai::block_hash const & = rai::block_hash (0));
+	void lazy_add (MDB_txn *, rai::block_hash const &);
 	std::shared_ptr<rai::bootstrap_client> connection (std::unique_lock<std::mutex> &);
 	bool consume_future (std::future<bool> &);
 	void populate_connections ();
 	bool request_frontier (std::unique_lock<std::mutex> &);
 	void request_pull (std::unique_lock<std::mutex> &);
+	// Pulls to pipeline on a connection that already has the given number outstanding
+	std::vector<rai::pull_info> pipeline_pulls (std::unique_lock<std::mutex> &, unsigned);
 	void request_push (std::unique_lock<std::mutex> &);
 	void add_connection (rai::endpoint const &);
 	void pool_connection (std::shared_ptr<rai::bootstrap_client>);
@@ -79,8 +93,11 @@ public:
 	void add_pull (rai::pull_info const &);
 	bool still_pulling ();
 	unsigned target_connections (size_t pulls_remaining);
+	unsigned adapt_connections (unsigned, double);
+	std::string phase_string ();
 	bool should_log ();
-	void add_bulk_push_target (rai::block_hash const &, rai::block_hash const &);
+	void add_pulls (std::vector<rai::pull_info> const &);
+	void add_bulk_push_targets (std::vector<std::pair<rai::block_hash, rai::block_hash>> const &);
 	std::chrono::steady_clock::time_point next_log;
 	std::deque<std::weak_ptr<rai::bootstrap_client>> clients;
 	std::weak_ptr<rai::bootstrap_client> connection_frontier_request;
@@ -93,8 +110,20 @@ public:
 	std::shared_ptr<rai::node> node;
 	std::atomic<unsigned> account_count;
 	std::atomic<uint64_t> total_blocks;
+	std::atomic<rai::bootstrap_phase> phase;
+	std::atomic<uint64_t> frontiers_received;
+	std::atomic<uint64_t> pulls_completed;
+	std::atomic<uint64_t> pulls_failed;
+	std::chrono::steady_clock::time_point start_time;
 	std::vector<std::pair<rai::block_hash, rai::block_hash>> bulk_push_targets;
 	bool stopped;
+	/** Lazy attempts skip the frontier request and pull backwards from the given hashes, following source links as blocks arrive */
+	bool lazy_mode;
+	std::unordered_set<rai::block_hash> lazy_keys;
+	/** Connection target grown while the aggregate block rate keeps rising, capped by target_connections */
+	unsigned connections_adaptive;
+	double rate_last;
+	std::chrono::steady_clock::time_point adapt_next;
 	std::mutex mutex;
 	std::condition_variable condition;
 };
@@ -107,8 +136,13 @@ public:
 	void receive_frontier ();
 	void received_frontier (boost::system::error_code const &, size_t);
 	void request_account (rai::account const &, rai::block_hash const &);
-	void unsynced (MDB_txn *, rai::block_hash const &, rai::block_hash const &);
-	void next (MDB_txn *);
+	void unsynced (rai::block_hash const &, rai::block_hash const &);
+	// Local accounts from current on, current and info are reloaded in case the account changed since the last frontier
+	rai::store_iterator seek (MDB_txn *);
+	void next (rai::store_iterator &);
+	// Load current and info from the cursor, or clear current at the end of the table
+	void position (rai::store_iterator &);
+	void flush ();
 	void insert_pull (rai::pull_info const &);
 	std::shared_ptr<rai::bootstrap_client> connection;
 	rai::account current;
@@ -120,6 +154,9 @@ public:
 	std::promise<bool> promise;
 	/** A very rough estimate of the cost of `bulk_push`ing missing blocks */
 	uint64_t bulk_push_cost;
+	/** Pulls and push targets found since the last flush to the attempt */
+	std::vector<rai::pull_info> pulls;
+	std::vector<std::pair<rai::block_hash, rai::block_hash>> bulk_push_targets;
 };
 class bulk_pull_client : public std::enable_shared_from_this<rai::bulk_pull_client>
 {
@@ -127,13 +164,28 @@ public:
 	bulk_pull_client (std::shared_ptr<rai::bootstrap_client>, rai::pull_info const &);
 	~bulk_pull_client ();
 	void request ();
+	void write_requests (std::vector<uint8_t> &);
+	void refill ();
 	void receive_block ();
 	void received_type ();
 	void received_block (boost::system::error_code const &, size_t, rai::block_type);
+	void lazy_links (MDB_txn *, rai::block const &);
+	void ingest ();
 	rai::block_hash first ();
 	std::shared_ptr<rai::bootstrap_client> connection;
 	rai::block_hash expected;
 	rai::pull_info pull;
+	/** Last state block seen in lazy mode, its link is a source only if its predecessor shows a lower balance */
+	rai::block_hash lazy_previous;
+	rai::uint256_union lazy_link;
+	rai::amount lazy_balance;
+	/** Set once a lazy pull reaches a block already in the ledger, everything older than it is ours */
+	bool lazy_known;
+	/** Pull whose response follows this one on the socket */
+	std::shared_ptr<rai::bulk_pull_client> successor;
+	/** Pulled blocks, newest first, held until the chain ends so they're processed oldest first instead of going through unchecked */
+	std::vector<std::shared_ptr<rai::block>> blocks;
+	static size_t const ingest_max = 4096;
 };
 class bootstrap_client : public std::enable_shared_from_this<bootstrap_client>
 {
@@ -154,6 +206,10 @@ public:
 	std::atomic<uint64_t> block_count;
 	std::atomic<bool> pending_stop;
 	std::atomic<bool> hard_stop;
+	std::atomic<bool> connected;
+	std::chrono::milliseconds latency;
+	/** Pulls requested on this connection whose responses haven't finished */
+	std::atomic<unsigned> pulls_outstanding;
 };
 class bulk_push_client : public std::enable_shared_from_this<rai::bulk_push_client>
 {
@@ -175,6 +231,7 @@ public:
 	~bootstrap_initiator ();
 	void bootstrap (rai::endpoint const &, bool add_to_peers = true);
 	void bootstrap ();
+	void bootstrap_lazy (rai::block_hash const &, rai::block_hash const & = rai::block_hash (0));
 	void run_bootstrap ();
 	void notify_listeners (bool);
 	void add_observer (std::function<void(bool)> const &);
@@ -185,6 +242,8 @@ public:
 private:
 	rai::node & node;
 	std::shared_ptr<rai::bootstrap_attempt> attempt;
+	// Lazy hashes and pull ends that came in while the current attempt was winding down, they start the next attempt
+	std::vector<std::pair<rai::block_hash, rai::block_hash>> lazy_pending;
 	bool stopped;
 	std::mutex mutex;
 	std::condition_variable condition;
@@ -236,10 +295,11 @@ class bulk_pull_server : public std::enable_shared_from_this<rai::bulk_pull_serv
 public:
 	bulk_pull_server (std::shared_ptr<rai::bootstrap_server> const &, std::unique_ptr<rai::bulk_pull>);
 	void set_current_end ();
+	// Next block in the chain as stored, only valid while the transaction is open
+	rai::block_view get_next_view (MDB_txn *);
 	std::unique_ptr<rai::block> get_next ();
 	void send_next ();
 	void sent_action (boost::system::error_code const &, size_t);
-	void send_finished ();
 	void no_block_sent (boost::system::error_code const &, size_t);
 	std::shared_ptr<rai::bootstrap_server> connection;
 	std::unique_ptr<rai::bulk_pull> request;
@@ -281,17 +341,18 @@ class frontier_req_server : public std::enable_shared_from_this<rai::frontier_re
 {
 public:
 	frontier_req_server (std::shared_ptr<rai::bootstrap_server> const &, std::unique_ptr<rai::frontier_req>);
-	void skip_old ();
 	void send_next ();
 	void sent_action (boost::system::error_code const &, size_t);
-	void send_finished ();
 	void no_block_sent (boost::system::error_code const &, size_t);
 	void next ();
+	void load (rai::store_iterator &);
 	std::shared_ptr<rai::bootstrap_server> connection;
 	rai::account current;
 	rai::account_info info;
 	std::unique_ptr<rai::frontier_req> request;
 	std::shared_ptr<std::vector<uint8_t>> send_buffer;
 	size_t count;
+	std::chrono::steady_clock::time_point start_time;
+	uint64_t sent;
 };
 }
@@ -298,7 +298,7 @@ block (block_a)
 bool rai::publish::deserialize (rai::stream & stream_a)
 {
 	assert (header.type == rai::message_type::publish);
-	block = rai::deserialize_block (stream_a, header.block_type ());
+	block = rai::deserialize_block_pooled (stream_a, header.block_type ());
 	auto result (block == nullptr);
 	return result;
 }
@@ -339,7 +339,7 @@ block (block_a)
 bool rai::confirm_req::deserialize (rai::stream & stream_a)
 {
 	assert (header.type == rai::message_type::confirm_req);
-	block = rai::deserialize_block (stream_a, header.block_type ());
+	block = rai::deserialize_block_pooled (stream_a, header.block_type ());
 	auto result (block == nullptr);
 	return result;
 }
@@ -363,7 +363,7 @@ bool rai::confirm_req::operator== (rai::confirm_req const & other_a) const
 
 rai::confirm_ack::confirm_ack (bool & error_a, rai::stream & stream_a, rai::message_header const & header_a) :
 message (header_a),
-vote (std::make_shared<rai::vote> (error_a, stream_a, header.block_type ()))
+vote (std::allocate_shared<rai::vote> (rai::pool_allocator<rai::vote> (), error_a, stream_a, header.block_type ()))
 {
 }
 
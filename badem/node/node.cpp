@@ -3,8 +3,10 @@
 #include <badem/lib/interface.h>
 #include <badem/node/common.hpp>
 #include <badem/node/rpc.hpp>
+#include <badem/snapshot.hpp>
 
 #include <algorithm>
+#include <fstream>
 #include <future>
 #include <memory>
 #include <sstream>
@@ -33,6 +35,8 @@ int constexpr rai::port_mapping::check_timeout;
 unsigned constexpr rai::active_transactions::announce_interval_ms;
 size_t constexpr rai::block_arrival::arrival_size_min;
 std::chrono::seconds constexpr rai::block_arrival::arrival_time_min;
+unsigned constexpr rai::callback_dispatcher::max_attempts;
+std::chrono::seconds constexpr rai::callback_dispatcher::retry_interval;
 
 rai::network::network (rai::node & node_a, uint16_t port) :
 socket (node_a.service, rai::endpoint (boost::asio::ip::address_v6::any (), port)),
@@ -66,7 +70,7 @@ void rai::network::send_keepalive (rai::endpoint const & endpoint_a)
 	assert (endpoint_a.address ().is_v6 ());
 	rai::keepalive message;
 	node.peers.random_fill (message.peers);
-	std::shared_ptr<std::vector<uint8_t>> bytes (new std::vector<uint8_t>);
+	auto bytes (rai::buffer_pool::get ());
 	{
 		rai::vectorstream stream (*bytes);
 		message.serialize (stream);
@@ -146,7 +150,7 @@ bool confirm_block (MDB_txn * transaction_a, rai::node & node_a, T & list_a, std
 			result = true;
 			auto vote (node_a.store.vote_generate (transaction_a, pub_a, prv_a, block_a));
 			rai::confirm_ack confirm (vote);
-			std::shared_ptr<std::vector<uint8_t>> bytes (new std::vector<uint8_t>);
+			auto bytes (rai::buffer_pool::get ());
 			{
 				rai::vectorstream stream (*bytes);
 				confirm.serialize (stream);
@@ -177,7 +181,7 @@ void rai::network::republish_block (MDB_txn * transaction, std::shared_ptr<rai::
 	if (!confirm_block (transaction, node, list, block))
 	{
 		rai::publish message (block);
-		std::shared_ptr<std::vector<uint8_t>> bytes (new std::vector<uint8_t>);
+		auto bytes (rai::buffer_pool::get ());
 		{
 			rai::vectorstream stream (*bytes);
 			message.serialize (stream);
@@ -211,7 +215,7 @@ void rai::network::republish_block (MDB_txn * transaction, std::shared_ptr<rai::
 void rai::network::republish_vote (std::shared_ptr<rai::vote> vote_a)
 {
 	rai::confirm_ack confirm (vote_a);
-	std::shared_ptr<std::vector<uint8_t>> bytes (new std::vector<uint8_t>);
+	auto bytes (rai::buffer_pool::get ());
 	{
 		rai::vectorstream stream (*bytes);
 		confirm.serialize (stream);
@@ -257,7 +261,7 @@ void rai::network::broadcast_confirm_req_base (std::shared_ptr<rai::block> block
 void rai::network::send_confirm_req (rai::endpoint const & endpoint_a, std::shared_ptr<rai::block> block)
 {
 	rai::confirm_req message (block);
-	std::shared_ptr<std::vector<uint8_t>> bytes (new std::vector<uint8_t>);
+	auto bytes (rai::buffer_pool::get ());
 	{
 		rai::vectorstream stream (*bytes);
 		message.serialize (stream);
@@ -790,7 +794,12 @@ enable_voting (true),
 bootstrap_connections (4),
 bootstrap_connections_max (64),
 callback_port (0),
-lmdb_max_dbs (128)
+callback_connections (4),
+callback_queue_max (16384),
+callback_batch_max (1),
+lmdb_max_dbs (128),
+unchecked_cache_max (rai::block_store::unchecked_cache_default),
+unchecked_cutoff_time (4 * 60 * 60)
 {
 	switch (rai::badem_network)
 	{
@@ -809,7 +818,7 @@ lmdb_max_dbs (128)
 
 void rai::node_config::serialize_json (boost::property_tree::ptree & tree_a) const
 {
-	tree_a.put ("version", "12");
+	tree_a.put ("version", "14");
 	tree_a.put ("peering_port", std::to_string (peering_port));
 	tree_a.put ("bootstrap_fraction_numerator", std::to_string (bootstrap_fraction_numerator));
 	tree_a.put ("receive_minimum", receive_minimum.to_string_dec ());
@@ -851,7 +860,12 @@ void rai::node_config::serialize_json (boost::property_tree::ptree & tree_a) con
 	tree_a.put ("callback_address", callback_address);
 	tree_a.put ("callback_port", std::to_string (callback_port));
 	tree_a.put ("callback_target", callback_target);
+	tree_a.put ("callback_connections", callback_connections);
+	tree_a.put ("callback_queue_max", callback_queue_max);
+	tree_a.put ("callback_batch_max", callback_batch_max);
 	tree_a.put ("lmdb_max_dbs", lmdb_max_dbs);
+	tree_a.put ("unchecked_cache_max", unchecked_cache_max);
+	tree_a.put ("unchecked_cutoff_time", unchecked_cutoff_time);
 	tree_a.put ("state_block_parse_canary", state_block_parse_canary.to_string ());
 	tree_a.put ("state_block_generate_canary", state_block_generate_canary.to_string ());
 }
@@ -950,6 +964,19 @@ bool rai::node_config::upgrade_json (unsigned version, boost::property_tree::ptr
 			result = true;
 		}
 		case 12:
+			tree_a.put ("callback_connections", callback_connections);
+			tree_a.put ("callback_queue_max", callback_queue_max);
+			tree_a.put ("callback_batch_max", callback_batch_max);
+			tree_a.erase ("version");
+			tree_a.put ("version", "13");
+			result = true;
+		case 13:
+			tree_a.put ("unchecked_cache_max", unchecked_cache_max);
+			tree_a.put ("unchecked_cutoff_time", unchecked_cutoff_time);
+			tree_a.erase ("version");
+			tree_a.put ("version", "14");
+			result = true;
+		case 14:
 			break;
 		default:
 			throw std::runtime_error ("Unknown node_config version");
@@ -1033,7 +1060,12 @@ bool rai::node_config::deserialize_json (bool & upgraded_a, boost::property_tree
 		callback_address = tree_a.get<std::string> ("callback_address");
 		auto callback_port_l (tree_a.get<std::string> ("callback_port"));
 		callback_target = tree_a.get<std::string> ("callback_target");
+		auto callback_connections_l (tree_a.get<std::string> ("callback_connections"));
+		auto callback_queue_max_l (tree_a.get<std::string> ("callback_queue_max"));
+		auto callback_batch_max_l (tree_a.get<std::string> ("callback_batch_max"));
 		auto lmdb_max_dbs_l = tree_a.get<std::string> ("lmdb_max_dbs");
+		auto unchecked_cache_max_l (tree_a.get<std::string> ("unchecked_cache_max"));
+		auto unchecked_cutoff_time_l (tree_a.get<std::string> ("unchecked_cutoff_time"));
 		result |= parse_port (callback_port_l, callback_port);
 		auto state_block_parse_canary_l = tree_a.get<std::string> ("state_block_parse_canary");
 		auto state_block_generate_canary_l = tree_a.get<std::string> ("state_block_generate_canary");
@@ -1046,7 +1078,12 @@ bool rai::node_config::deserialize_json (bool & upgraded_a, boost::property_tree
 			work_threads = std::stoul (work_threads_l);
 			bootstrap_connections = std::stoul (bootstrap_connections_l);
 			bootstrap_connections_max = std::stoul (bootstrap_connections_max_l);
+			callback_connections = std::stoul (callback_connections_l);
+			callback_queue_max = std::stoul (callback_queue_max_l);
+			callback_batch_max = std::stoul (callback_batch_max_l);
 			lmdb_max_dbs = std::stoi (lmdb_max_dbs_l);
+			unchecked_cache_max = std::stoull (unchecked_cache_max_l);
+			unchecked_cutoff_time = std::stoull (unchecked_cutoff_time_l);
 			online_weight_quorum = std::stoul (online_weight_quorum_l);
 			result |= peering_port > std::numeric_limits<uint16_t>::max ();
 			result |= logging.deserialize_json (upgraded_a, logging_l);
@@ -1056,6 +1093,9 @@ bool rai::node_config::deserialize_json (bool & upgraded_a, boost::property_tree
 			result |= password_fanout < 16;
 			result |= password_fanout > 1024 * 1024;
 			result |= io_threads == 0;
+			result |= callback_connections == 0;
+			result |= callback_batch_max == 0;
+			result |= unchecked_cutoff_time == 0;
 			result |= state_block_parse_canary.decode_hex (state_block_parse_canary_l);
 			result |= state_block_generate_canary.decode_hex (state_block_generate_canary_l);
 		}
@@ -1110,7 +1150,7 @@ rai::vote_code rai::vote_processor::vote (std::shared_ptr<rai::vote> vote_a, rai
 				if (max_vote->sequence > vote_a->sequence + 10000)
 				{
 					rai::confirm_ack confirm (max_vote);
-					std::shared_ptr<std::vector<uint8_t>> bytes (new std::vector<uint8_t>);
+					auto bytes (rai::buffer_pool::get ());
 					{
 						rai::vectorstream stream (*bytes);
 						confirm.serialize (stream);
@@ -1162,11 +1202,18 @@ bool rai::rep_crawler::exists (rai::block_hash const & hash_a)
 	return active.count (hash_a) != 0;
 }
 
+std::chrono::milliseconds constexpr rai::block_processor::batch_target;
+
 rai::block_processor::block_processor (rai::node & node_a) :
 stopped (false),
 active (false),
 node (node_a),
-next_log (std::chrono::steady_clock::now ())
+next_log (std::chrono::steady_clock::now ()),
+batch_size (256),
+lane (0),
+lane_taken (0),
+local_active (0),
+checker (std::max (1u, std::thread::hardware_concurrency ()) - 1)
 {
 }
 
@@ -1177,15 +1224,27 @@ rai::block_processor::~block_processor ()
 
 void rai::block_processor::stop ()
 {
-	std::lock_guard<std::mutex> lock (mutex);
-	stopped = true;
-	condition.notify_all ();
+	{
+		std::lock_guard<std::mutex> lock (mutex);
+		stopped = true;
+		condition.notify_all ();
+	}
+	checker.stop ();
 }
 
 void rai::block_processor::flush ()
 {
 	std::unique_lock<std::mutex> lock (mutex);
-	while (!stopped && (!blocks.empty () || active))
+	while (!stopped && (have_blocks () || active))
+	{
+		condition.wait (lock);
+	}
+}
+
+void rai::block_processor::flush_local ()
+{
+	std::unique_lock<std::mutex> lock (mutex);
+	while (!stopped && (!lanes[static_cast<size_t> (rai::block_origin::local)].empty () || local_active != 0))
 	{
 		condition.wait (lock);
 	}
@@ -1194,15 +1253,99 @@ void rai::block_processor::flush ()
 bool rai::block_processor::full ()
 {
 	std::unique_lock<std::mutex> lock (mutex);
-	return blocks.size () > 16384;
+	return lanes[static_cast<size_t> (rai::block_origin::bootstrap)].size () > 16384;
 }
 
-void rai::block_processor::add (std::shared_ptr<rai::block> block_a)
+size_t rai::block_processor::size ()
+{
+	std::unique_lock<std::mutex> lock (mutex);
+	return queued ();
+}
+
+size_t rai::block_processor::lane_size (rai::block_origin origin_a)
+{
+	std::unique_lock<std::mutex> lock (mutex);
+	return lanes[static_cast<size_t> (origin_a)].size ();
+}
+
+size_t rai::block_processor::queued ()
+{
+	assert (!mutex.try_lock ());
+	auto result (forced.size ());
+	for (auto & i : lanes)
+	{
+		result += i.size ();
+	}
+	return result;
+}
+
+size_t rai::block_processor::lane_max (rai::block_origin origin_a)
+{
+	size_t result (0);
+	switch (origin_a)
+	{
+		case rai::block_origin::local:
+			result = 4096;
+			break;
+		case rai::block_origin::live:
+			result = 16384;
+			break;
+		case rai::block_origin::bootstrap:
+		case rai::block_origin::unchecked:
+			result = std::numeric_limits<size_t>::max ();
+			break;
+	}
+	return result;
+}
+
+size_t rai::block_processor::lane_weight (rai::block_origin origin_a)
+{
+	size_t result (0);
+	switch (origin_a)
+	{
+		case rai::block_origin::local:
+			result = 32;
+			break;
+		case rai::block_origin::live:
+			result = 16;
+			break;
+		case rai::block_origin::bootstrap:
+			result = 4;
+			break;
+		case rai::block_origin::unchecked:
+			result = 4;
+			break;
+	}
+	return result;
+}
+
+/**
+ * Queue a block in its lane, returns true and counts the drop if the lane is already full.
+ * Lanes are taken from the front so the newest block is processed first.
+ */
+bool rai::block_processor::push (std::shared_ptr<rai::block> block_a, rai::block_origin origin_a)
+{
+	assert (!mutex.try_lock ());
+	auto & lane_l (lanes[static_cast<size_t> (origin_a)]);
+	auto result (lane_l.size () >= lane_max (origin_a));
+	if (!result)
+	{
+		lane_l.push_front (block_a);
+	}
+	else
+	{
+		assert (origin_a == rai::block_origin::local || origin_a == rai::block_origin::live);
+		node.stats.inc (rai::stat::type::block_processor, origin_a == rai::block_origin::local ? rai::stat::detail::drop_local : rai::stat::detail::drop_live, rai::stat::dir::in);
+	}
+	return result;
+}
+
+void rai::block_processor::add (std::shared_ptr<rai::block> block_a, rai::block_origin origin_a)
 {
 	if (!rai::work_validate (block_a->root (), block_a->block_work ()))
 	{
 		std::lock_guard<std::mutex> lock (mutex);
-		blocks.push_front (block_a);
+		push (block_a, origin_a);
 		condition.notify_all ();
 	}
 	else
@@ -1212,6 +1355,32 @@ void rai::block_processor::add (std::shared_ptr<rai::block> block_a)
 	}
 }
 
+void rai::block_processor::add (std::vector<std::shared_ptr<rai::block>> const & blocks_a)
+{
+	// Work is checked before taking the lock so a long batch doesn't stall the processing thread
+	std::vector<std::shared_ptr<rai::block>> valid;
+	valid.reserve (blocks_a.size ());
+	for (auto & i : blocks_a)
+	{
+		if (!rai::work_validate (i->root (), i->block_work ()))
+		{
+			valid.push_back (i);
+		}
+		else
+		{
+			BOOST_LOG (node.log) << "rai::block_processor::add called for hash " << i->hash ().to_string () << " with invalid work " << rai::to_string_hex (i->block_work ());
+			assert (false && "rai::block_processor::add called with invalid work");
+		}
+	}
+	std::lock_guard<std::mutex> lock (mutex);
+	for (auto & i : valid)
+	{
+		// Blocks are taken from the front so the last one pushed, the oldest, is processed first
+		push (i, rai::block_origin::bootstrap);
+	}
+	condition.notify_all ();
+}
+
 void rai::block_processor::force (std::shared_ptr<rai::block> block_a)
 {
 	std::lock_guard<std::mutex> lock (mutex);
@@ -1231,6 +1400,8 @@ void rai::block_processor::process_blocks ()
 			process_receive_many (lock);
 			lock.lock ();
 			active = false;
+			local_active = 0;
+			condition.notify_all ();
 		}
 		else
 		{
@@ -1255,38 +1426,109 @@ bool rai::block_processor::should_log ()
 bool rai::block_processor::have_blocks ()
 {
 	assert (!mutex.try_lock ());
-	return !blocks.empty () || !forced.empty ();
+	auto result (!forced.empty ());
+	for (auto & i : lanes)
+	{
+		result = result || !i.empty ();
+	}
+	return result;
 }
 
-void rai::block_processor::process_receive_many (std::unique_lock<std::mutex> & lock_a)
+std::vector<std::pair<std::shared_ptr<rai::block>, bool>> rai::block_processor::next_batch (size_t count_a)
+{
+	std::lock_guard<std::mutex> lock (mutex);
+	return dequeue (count_a);
+}
+
+/**
+ * Forced blocks go first, then lanes take turns giving up to their weight in blocks so bootstrap can't starve local and live blocks and vice versa
+ */
+std::vector<std::pair<std::shared_ptr<rai::block>, bool>> rai::block_processor::dequeue (size_t count_a)
 {
+	assert (!mutex.try_lock ());
+	std::vector<std::pair<std::shared_ptr<rai::block>, bool>> result;
+	while (have_blocks () && result.size () < count_a)
 	{
-		rai::transaction transaction (node.store.environment, nullptr, true);
-		auto cutoff (std::chrono::steady_clock::now () + rai::transaction_timeout);
-		lock_a.lock ();
-		auto count (0);
-		while (have_blocks () && count < 16384)
+		auto & lane_l (lanes[lane]);
+		if (!forced.empty ())
 		{
-			if (blocks.size () > 64 && should_log ())
-			{
-				BOOST_LOG (node.log) << boost::str (boost::format ("%1% blocks in processing queue") % blocks.size ());
-			}
-			std::shared_ptr<rai::block> block;
-			bool force (false);
-			if (forced.empty ())
-			{
-				block = blocks.front ();
-				blocks.pop_front ();
-			}
-			else
+			result.push_back (std::make_pair (forced.front (), true));
+			forced.pop_front ();
+		}
+		else if (!lane_l.empty () && lane_taken < lane_weight (static_cast<rai::block_origin> (lane)))
+		{
+			result.push_back (std::make_pair (lane_l.front (), false));
+			lane_l.pop_front ();
+			++lane_taken;
+			if (lane == static_cast<size_t> (rai::block_origin::local))
 			{
-				block = forced.front ();
-				forced.pop_front ();
-				force = true;
+				++local_active;
 			}
-			lock_a.unlock ();
+		}
+		else
+		{
+			lane = (lane + 1) % lane_count;
+			lane_taken = 0;
+		}
+	}
+	return result;
+}
+
+size_t rai::block_processor::next_batch_size ()
+{
+	std::lock_guard<std::mutex> lock (mutex);
+	return batch_size_locked ();
+}
+
+size_t rai::block_processor::batch_size_locked ()
+{
+	assert (!mutex.try_lock ());
+	size_t const live_batch_max_l (live_batch_max);
+	auto urgent (!lanes[static_cast<size_t> (rai::block_origin::local)].empty () || !lanes[static_cast<size_t> (rai::block_origin::live)].empty ());
+	return urgent ? std::min (batch_size, live_batch_max_l) : batch_size;
+}
+
+/**
+ * Halve the batch when a commit holds the write lock past batch_target, double it while full batches commit in under half of it
+ */
+void rai::block_processor::adapt (std::chrono::steady_clock::duration const & held_a, bool full_a)
+{
+	std::lock_guard<std::mutex> lock (mutex);
+	size_t const batch_min_l (batch_min);
+	size_t const batch_max_l (batch_max);
+	if (held_a > batch_target)
+	{
+		batch_size = std::max (batch_size / 2, batch_min_l);
+	}
+	else if (held_a < batch_target / 2 && full_a)
+	{
+		batch_size = std::min (batch_size * 2, batch_max_l);
+	}
+}
+
+void rai::block_processor::process_receive_many (std::unique_lock<std::mutex> & lock_a)
+{
+	lock_a.lock ();
+	auto count (batch_size_locked ());
+	if (queued () > 64 && should_log ())
+	{
+		BOOST_LOG (node.log) << boost::str (boost::format ("%1% blocks in processing queue") % queued ());
+	}
+	// Blocks paired with whether they were forced
+	auto batch (dequeue (count));
+	auto backlog (have_blocks ());
+	lock_a.unlock ();
+	auto verified (verify_signatures (batch));
+	auto requested (std::chrono::steady_clock::now ());
+	std::chrono::steady_clock::time_point acquired;
+	{
+		rai::transaction transaction (node.store.environment, nullptr, true);
+		acquired = std::chrono::steady_clock::now ();
+		for (size_t i (0); i < batch.size (); ++i)
+		{
+			auto & block (batch[i].first);
 			auto hash (block->hash ());
-			if (force)
+			if (batch[i].second)
 			{
 				auto successor (node.ledger.successor (transaction, block->root ()));
 				if (successor != nullptr && successor->hash () != hash)
@@ -1296,20 +1538,160 @@ void rai::block_processor::process_receive_many (std::unique_lock<std::mutex> &
 					node.ledger.rollback (transaction, successor->hash ());
 				}
 			}
-			auto process_result (process_receive_one (transaction, block));
+			auto process_result (process_receive_one (transaction, block, verified[i] != 0));
 			(void)process_result;
-			lock_a.lock ();
-			++count;
 		}
 	}
-	lock_a.unlock ();
+	auto committed (std::chrono::steady_clock::now ());
+	auto held (committed - acquired);
+	adapt (held, batch.size () == count && backlog);
+	node.stats.update_histogram (rai::stat::type::block_processor, rai::stat::detail::batch_size, rai::stat::dir::in, batch.size ());
+	node.stats.update_histogram (rai::stat::type::block_processor, rai::stat::detail::lock_wait, rai::stat::dir::in, std::chrono::duration_cast<std::chrono::microseconds> (acquired - requested).count ());
+	node.stats.update_histogram (rai::stat::type::block_processor, rai::stat::detail::commit, rai::stat::dir::in, std::chrono::duration_cast<std::chrono::microseconds> (held).count ());
+	// Only this thread's hits are taken, which covers the hashing done while processing the batch
+	node.stats.add (rai::stat::type::block, rai::stat::detail::hash_cached, rai::stat::dir::in, rai::block::hash_cache_hits);
+	rai::block::hash_cache_hits = 0;
+}
+
+/**
+ * Check a batch's signatures on every core while only a read transaction is held, so the writer is left with the ledger rules.
+ * Legacy blocks are checked against the account of their previous block, found among earlier blocks in the batch or in the frontiers table.
+ * Blocks whose account isn't known yet are left unverified and the ledger checks them as usual.
+ */
+std::vector<uint8_t> rai::block_processor::verify_signatures (std::vector<std::pair<std::shared_ptr<rai::block>, bool>> const & batch_a)
+{
+	std::vector<uint8_t> result (batch_a.size (), 0);
+	if (batch_a.size () >= verify_threshold)
+	{
+		std::vector<rai::account> accounts (batch_a.size ());
+		{
+			rai::transaction transaction (node.store.environment, nullptr, false);
+			std::unordered_map<rai::block_hash, rai::account> batch_accounts;
+			for (size_t i (0); i < batch_a.size (); ++i)
+			{
+				auto & block (*batch_a[i].first);
+				rai::account account (0);
+				switch (block.type ())
+				{
+					case rai::block_type::open:
+						account = static_cast<rai::open_block const &> (block).hashables.account;
+						break;
+					case rai::block_type::state:
+						account = static_cast<rai::state_block const &> (block).hashables.account;
+						break;
+					default:
+					{
+						auto existing (batch_accounts.find (block.previous ()));
+						account = existing != batch_accounts.end () ? existing->second : node.store.frontier_get (transaction, block.previous ());
+						break;
+					}
+				}
+				if (!account.is_zero ())
+				{
+					batch_accounts[block.hash ()] = account;
+				}
+				accounts[i] = account;
+			}
+		}
+		checker.run (batch_a.size (), [&batch_a, &accounts, &result](size_t begin_a, size_t end_a) {
+			for (auto i (begin_a); i < end_a; ++i)
+			{
+				auto & block (*batch_a[i].first);
+				result[i] = !accounts[i].is_zero () && !rai::validate_message (accounts[i], block.hash (), block.block_signature ());
+			}
+		});
+	}
+	return result;
 }
 
-rai::process_return rai::block_processor::process_receive_one (MDB_txn * transaction_a, std::shared_ptr<rai::block> block_a)
+rai::signature_checker::signature_checker (unsigned threads_a) :
+pending (0),
+stopped (false)
+{
+	for (auto i (0u); i < threads_a; ++i)
+	{
+		threads.push_back (std::thread ([this]() { loop (); }));
+	}
+}
+
+rai::signature_checker::~signature_checker ()
+{
+	stop ();
+}
+
+void rai::signature_checker::run (size_t size_a, std::function<void(size_t, size_t)> const & task_a)
+{
+	auto slice ((size_a + threads.size ()) / (threads.size () + 1));
+	std::unique_lock<std::mutex> lock (mutex);
+	if (!stopped && slice > 0)
+	{
+		for (auto begin (slice); begin < size_a; begin += slice)
+		{
+			auto end (std::min (size_a, begin + slice));
+			tasks.push_back ([&task_a, begin, end]() { task_a (begin, end); });
+			++pending;
+		}
+		condition.notify_all ();
+		lock.unlock ();
+		task_a (0, std::min (size_a, slice));
+		lock.lock ();
+		while (pending > 0)
+		{
+			condition.wait (lock);
+		}
+	}
+	else
+	{
+		// Stopped threads take no more slices
+		lock.unlock ();
+		task_a (0, size_a);
+	}
+}
+
+void rai::signature_checker::stop ()
+{
+	{
+		std::lock_guard<std::mutex> lock (mutex);
+		stopped = true;
+		condition.notify_all ();
+	}
+	for (auto & i : threads)
+	{
+		if (i.joinable ())
+		{
+			i.join ();
+		}
+	}
+}
+
+void rai::signature_checker::loop ()
+{
+	std::unique_lock<std::mutex> lock (mutex);
+	// Slices already queued are finished before stopping so run () never waits on them forever
+	while (!stopped || !tasks.empty ())
+	{
+		if (!tasks.empty ())
+		{
+			auto task (std::move (tasks.front ()));
+			tasks.pop_front ();
+			lock.unlock ();
+			task ();
+			lock.lock ();
+			--pending;
+			condition.notify_all ();
+		}
+		else
+		{
+			condition.wait (lock);
+		}
+	}
+}
+
+rai::process_return rai::block_processor::process_receive_one (MDB_txn * transaction_a, std::shared_ptr<rai::block> block_a, bool valid_signature_a)
 {
 	rai::process_return result;
 	auto hash (block_a->hash ());
-	result = node.ledger.process (transaction_a, *block_a);
+	result = node.ledger.process (transaction_a, *block_a, valid_signature_a);
 	switch (result.code)
 	{
 		case rai::process_result::progress:
@@ -1334,6 +1716,7 @@ rai::process_return rai::block_processor::process_receive_one (MDB_txn * transac
 				BOOST_LOG (node.log) << boost::str (boost::format ("Gap previous for: %1%") % hash.to_string ());
 			}
 			node.store.unchecked_put (transaction_a, block_a->previous (), block_a);
+			node.stats.inc (rai::stat::type::unchecked, rai::stat::detail::gap_previous);
 			node.gap_cache.add (transaction_a, block_a);
 			break;
 		}
@@ -1344,6 +1727,7 @@ rai::process_return rai::block_processor::process_receive_one (MDB_txn * transac
 				BOOST_LOG (node.log) << boost::str (boost::format ("Gap source for: %1%") % hash.to_string ());
 			}
 			node.store.unchecked_put (transaction_a, node.ledger.block_source (transaction_a, *block_a), block_a);
+			node.stats.inc (rai::stat::type::unchecked, rai::stat::detail::gap_source);
 			node.gap_cache.add (transaction_a, block_a);
 			break;
 		}
@@ -1424,7 +1808,10 @@ void rai::block_processor::queue_unchecked (MDB_txn * transaction_a, rai::block_
 	for (auto i (cached.begin ()), n (cached.end ()); i != n; ++i)
 	{
 		node.store.unchecked_del (transaction_a, hash_a, **i);
-		add (*i);
+		std::lock_guard<std::mutex> lock (mutex);
+		auto error (push (*i, rai::block_origin::unchecked));
+		assert (!error);
+		(void)error;
 	}
 	std::lock_guard<std::mutex> lock (node.gap_cache.mutex);
 	node.gap_cache.blocks.get<1> ().erase (hash_a);
@@ -1456,8 +1843,14 @@ warmed_up (0),
 block_processor (*this),
 block_processor_thread ([this]() { this->block_processor.process_blocks (); }),
 online_reps (*this),
-stats (config.stat_config)
-{
+stats (config.stat_config),
+callback (*this)
+{
+	store.unchecked_cache_max = config.unchecked_cache_max;
+	unchecked_cleanup_cursor.clear ();
+	stats.define_histogram (rai::stat::type::block_processor, rai::stat::detail::batch_size, rai::stat::dir::in, { 1, 16, 64, 256, 1024, 4096, 16384 });
+	stats.define_histogram (rai::stat::type::block_processor, rai::stat::detail::lock_wait, rai::stat::dir::in, { 100, 1000, 10000, 100000, 1000000 });
+	stats.define_histogram (rai::stat::type::block_processor, rai::stat::detail::commit, rai::stat::dir::in, { 1000, 10000, 100000, 250000, 1000000 });
 	wallets.observer = [this](bool active) {
 		observers.wallet (active);
 	};
@@ -1468,107 +1861,23 @@ stats (config.stat_config)
 		observers.disconnect ();
 	};
 	observers.blocks.add ([this](std::shared_ptr<rai::block> block_a, rai::account const & account_a, rai::amount const & amount_a, bool is_state_send_a) {
-		if (this->block_arrival.recent (block_a->hash ()))
-		{
-			auto node_l (shared_from_this ());
-			background ([node_l, block_a, account_a, amount_a, is_state_send_a]() {
-				if (!node_l->config.callback_address.empty ())
-				{
-					boost::property_tree::ptree event;
-					event.add ("account", account_a.to_account ());
-					event.add ("hash", block_a->hash ().to_string ());
-					std::string block_text;
-					block_a->serialize_json (block_text);
-					event.add ("block", block_text);
-					event.add ("amount", amount_a.to_string_dec ());
-					if (is_state_send_a)
-					{
-						event.add ("is_send", is_state_send_a);
-					}
-					std::stringstream ostream;
-					boost::property_tree::write_json (ostream, event);
-					ostream.flush ();
-					auto body (std::make_shared<std::string> (ostream.str ()));
-					auto address (node_l->config.callback_address);
-					auto port (node_l->config.callback_port);
-					auto target (std::make_shared<std::string> (node_l->config.callback_target));
-					auto resolver (std::make_shared<boost::asio::ip::tcp::resolver> (node_l->service));
-					resolver->async_resolve (boost::asio::ip::tcp::resolver::query (address, std::to_string (port)), [node_l, address, port, target, body, resolver](boost::system::error_code const & ec, boost::asio::ip::tcp::resolver::iterator i_a) {
-						if (!ec)
-						{
-							for (auto i (i_a), n (boost::asio::ip::tcp::resolver::iterator{}); i != n; ++i)
-							{
-								auto sock (std::make_shared<boost::asio::ip::tcp::socket> (node_l->service));
-								sock->async_connect (i->endpoint (), [node_l, target, body, sock, address, port](boost::system::error_code const & ec) {
-									if (!ec)
-									{
-										auto req (std::make_shared<boost::beast::http::request<boost::beast::http::string_body>> ());
-										req->method (boost::beast::http::verb::post);
-										req->target (*target);
-										req->version (11);
-										req->insert (boost::beast::http::field::host, address);
-										req->insert (boost::beast::http::field::content_type, "application/json");
-										req->body () = *body;
-										//req->prepare (*req);
-										//boost::beast::http::prepare(req);
-										req->prepare_payload ();
-										boost::beast::http::async_write (*sock, *req, [node_l, sock, address, port, req](boost::system::error_code const & ec, size_t bytes_transferred) {
-											if (!ec)
-											{
-												auto sb (std::make_shared<boost::beast::flat_buffer> ());
-												auto resp (std::make_shared<boost::beast::http::response<boost::beast::http::string_body>> ());
-												boost::beast::http::async_read (*sock, *sb, *resp, [node_l, sb, resp, sock, address, port](boost::system::error_code const & ec, size_t bytes_transferred) {
-													if (!ec)
-													{
-														if (resp->result () == boost::beast::http::status::ok)
-														{
-														}
-														else
-														{
-															if (node_l->config.logging.callback_logging ())
-															{
-																BOOST_LOG (node_l->log) << boost::str (boost::format ("Callback to %1%:%2% failed with status: %3%") % address % port % resp->result ());
-															}
-														}
-													}
-													else
-													{
-														if (node_l->config.logging.callback_logging ())
-														{
-															BOOST_LOG (node_l->log) << boost::str (boost::format ("Unable complete callback: %1%:%2%: %3%") % address % port % ec.message ());
-														}
-													};
-												});
-											}
-											else
-											{
-												if (node_l->config.logging.callback_logging ())
-												{
-													BOOST_LOG (node_l->log) << boost::str (boost::format ("Unable to send callback: %1%:%2%: %3%") % address % port % ec.message ());
-												}
-											}
-										});
-									}
-									else
-									{
-										if (node_l->config.logging.callback_logging ())
-										{
-											BOOST_LOG (node_l->log) << boost::str (boost::format ("Unable to connect to callback address: %1%:%2%: %3%") % address % port % ec.message ());
-										}
-									}
-								});
-							}
-						}
-						else
-						{
-							if (node_l->config.logging.callback_logging ())
-							{
-								BOOST_LOG (node_l->log) << boost::str (boost::format ("Error resolving callback: %1%:%2%: %3%") % address % port % ec.message ());
-							}
-						}
-					});
-				}
-			});
+		if (!config.callback_address.empty () && this->block_arrival.recent (block_a->hash ()))
+		{
+			boost::property_tree::ptree event;
+			event.add ("account", account_a.to_account ());
+			event.add ("hash", block_a->hash ().to_string ());
+			std::string block_text;
+			block_a->serialize_json (block_text);
+			event.add ("block", block_text);
+			event.add ("amount", amount_a.to_string_dec ());
+			if (is_state_send_a)
+			{
+				event.add ("is_send", is_state_send_a);
+			}
+			std::stringstream ostream;
+			boost::property_tree::write_json (ostream, event);
+			ostream.flush ();
+			callback.add (ostream.str ());
 		}
 	});
 	observers.endpoint.add ([this](rai::endpoint const & endpoint_a) {
@@ -1625,6 +1934,26 @@ stats (config.stat_config)
 			rai::genesis genesis;
 			genesis.initialize (transaction, store);
 		}
+		std::vector<rai::endpoint_key> unreadable;
+		for (auto i (store.bootstrap_score_begin (transaction)), n (store.bootstrap_score_end ()); i != n; ++i)
+		{
+			rai::endpoint_key key (i->first);
+			rai::bootstrap_score score;
+			rai::bufferstream stream (reinterpret_cast<uint8_t const *> (i->second.data ()), i->second.size ());
+			auto error (score.deserialize (stream));
+			if (!error)
+			{
+				peers.bootstrap_scores[rai::endpoint (boost::asio::ip::address_v6 (key.address), key.port)] = score;
+			}
+			else
+			{
+				unreadable.push_back (key);
+			}
+		}
+		for (auto & i : unreadable)
+		{
+			store.bootstrap_score_del (transaction, i);
+		}
 	}
 	if (rai::badem_network == rai::badem_networks::badem_live_network)
 	{
@@ -1755,13 +2084,14 @@ void rai::gap_cache::vote (std::shared_ptr<rai::vote> vote_a)
 	auto existing (blocks.get<1> ().find (hash));
 	if (existing != blocks.get<1> ().end ())
 	{
-		existing->votes->vote (vote_a);
+		existing->votes->vote (vote_a, node.ledger.weight (transaction, vote_a->account));
 		auto winner (node.ledger.winner (transaction, *existing->votes));
 		if (winner.first > bootstrap_threshold (transaction))
 		{
 			auto node_l (node.shared ());
+			auto block (vote_a->block);
 			auto now (std::chrono::steady_clock::now ());
-			node.alarm.add (rai::badem_network == rai::badem_networks::badem_test_network ? now + std::chrono::milliseconds (5) : now + std::chrono::seconds (5), [node_l, hash]() {
+			node.alarm.add (rai::badem_network == rai::badem_networks::badem_test_network ? now + std::chrono::milliseconds (5) : now + std::chrono::seconds (5), [node_l, hash, block]() {
 				rai::transaction transaction (node_l->store.environment, nullptr, false);
 				if (!node_l->store.block_exists (transaction, hash))
 				{
@@ -1769,7 +2099,15 @@ void rai::gap_cache::vote (std::shared_ptr<rai::vote> vote_a)
 					{
 						BOOST_LOG (node_l->log) << boost::str (boost::format ("Missing confirmed block %1%") % hash.to_string ());
 					}
-					node_l->bootstrap_initiator.bootstrap ();
+					// State blocks name their account, the pull stops at our head for it instead of refetching what we hold
+					rai::block_hash end (0);
+					rai::account_info info;
+					if (block->type () == rai::block_type::state && !node_l->store.account_get (transaction, static_cast<rai::state_block const &> (*block).hashables.account, info))
+					{
+						end = info.head;
+					}
+					// Pull just this block's dependencies instead of waiting on a full frontier pass
+					node_l->bootstrap_initiator.bootstrap_lazy (hash, end);
 				}
 			});
 		}
@@ -1823,11 +2161,11 @@ void rai::network::confirm_send (rai::confirm_ack const & confirm_a, std::shared
 	});
 }
 
-void rai::node::process_active (std::shared_ptr<rai::block> incoming)
+void rai::node::process_active (std::shared_ptr<rai::block> incoming, rai::block_origin origin_a)
 {
 	if (!block_arrival.add (incoming->hash ()))
 	{
-		block_processor.add (incoming);
+		block_processor.add (incoming, origin_a);
 	}
 }
 
@@ -1873,27 +2211,117 @@ std::map<rai::endpoint, unsigned> rai::peer_container::list_version ()
 	return result;
 }
 
-rai::endpoint rai::peer_container::bootstrap_peer ()
+rai::endpoint rai::peer_container::bootstrap_peer ()
+{
+	rai::endpoint result (boost::asio::ip::address_v6::any (), 0);
+	std::lock_guard<std::mutex> lock (mutex);
+	auto best (peers.get<4> ().end ());
+	double best_score (-1.0);
+	size_t candidates (0);
+	for (auto i (peers.get<4> ().begin ()), n (peers.get<4> ().end ()); i != n && candidates < bootstrap_candidates; ++i)
+	{
+		if (i->network_version >= 0x5)
+		{
+			++candidates;
+			auto existing (bootstrap_scores.find (i->endpoint));
+			auto score (existing != bootstrap_scores.end () ? existing->second.score () : rai::bootstrap_score ().score ());
+			if (score > best_score)
+			{
+				best = i;
+				best_score = score;
+			}
+		}
+	}
+	if (best != peers.get<4> ().end ())
+	{
+		result = best->endpoint;
+		peers.get<4> ().modify (best, [](rai::peer_information & peer_a) {
+			peer_a.last_bootstrap_attempt = std::chrono::steady_clock::now ();
+		});
+	}
+	return result;
+}
+
+void rai::peer_container::bootstrap_completed (rai::endpoint const & endpoint_a, std::chrono::milliseconds const & latency_a, uint64_t blocks_a, double rate_a)
+{
+	std::lock_guard<std::mutex> lock (mutex);
+	bootstrap_scores[endpoint_a].completed (latency_a, blocks_a, rate_a);
+	bootstrap_scores_dirty.insert (endpoint_a);
+}
+
+void rai::peer_container::bootstrap_failed (rai::endpoint const & endpoint_a)
+{
+	std::lock_guard<std::mutex> lock (mutex);
+	bootstrap_scores[endpoint_a].failed ();
+	bootstrap_scores_dirty.insert (endpoint_a);
+}
+
+double rai::peer_container::bootstrap_score (rai::endpoint const & endpoint_a)
+{
+	std::lock_guard<std::mutex> lock (mutex);
+	auto existing (bootstrap_scores.find (endpoint_a));
+	return existing != bootstrap_scores.end () ? existing->second.score () : rai::bootstrap_score ().score ();
+}
+
+std::unordered_map<rai::endpoint, rai::bootstrap_score> rai::peer_container::bootstrap_scores_list ()
+{
+	std::lock_guard<std::mutex> lock (mutex);
+	return bootstrap_scores;
+}
+
+void rai::peer_container::bootstrap_scores_changes (std::unordered_map<rai::endpoint, rai::bootstrap_score> & changed_a, std::vector<rai::endpoint> & evicted_a)
+{
+	std::lock_guard<std::mutex> lock (mutex);
+	for (auto & i : bootstrap_scores_dirty)
+	{
+		auto existing (bootstrap_scores.find (i));
+		if (existing != bootstrap_scores.end ())
+		{
+			changed_a[i] = existing->second;
+		}
+		else
+		{
+			evicted_a.push_back (i);
+		}
+	}
+	bootstrap_scores_dirty.clear ();
+}
+
+/**
+ * Drop scores not updated within the cutoff, then the least recently updated ones past the size bound. Caller holds the mutex
+ */
+void rai::peer_container::bootstrap_scores_evict ()
 {
-	rai::endpoint result (boost::asio::ip::address_v6::any (), 0);
-	std::lock_guard<std::mutex> lock (mutex);
-	;
-	for (auto i (peers.get<4> ().begin ()), n (peers.get<4> ().end ()); i != n;)
+	auto cutoff (rai::seconds_since_epoch () - bootstrap_score_cutoff);
+	for (auto i (bootstrap_scores.begin ()), n (bootstrap_scores.end ()); i != n;)
 	{
-		if (i->network_version >= 0x5)
+		if (i->second.last_update < cutoff)
 		{
-			result = i->endpoint;
-			peers.get<4> ().modify (i, [](rai::peer_information & peer_a) {
-				peer_a.last_bootstrap_attempt = std::chrono::steady_clock::now ();
-			});
-			i = n;
+			bootstrap_scores_dirty.insert (i->first);
+			i = bootstrap_scores.erase (i);
 		}
 		else
 		{
 			++i;
 		}
 	}
-	return result;
+	auto max (bootstrap_scores_max);
+	if (bootstrap_scores.size () > max)
+	{
+		std::vector<std::pair<uint64_t, rai::endpoint>> ages;
+		ages.reserve (bootstrap_scores.size ());
+		for (auto & i : bootstrap_scores)
+		{
+			ages.push_back (std::make_pair (i.second.last_update, i.first));
+		}
+		auto excess (ages.size () - max);
+		std::nth_element (ages.begin (), ages.begin () + excess, ages.end ());
+		for (auto i (ages.begin ()), n (ages.begin () + excess); i != n; ++i)
+		{
+			bootstrap_scores_dirty.insert (i->second);
+			bootstrap_scores.erase (i->second);
+		}
+	}
 }
 
 bool rai::parse_port (std::string const & string_a, uint16_t & port_a)
@@ -1984,6 +2412,7 @@ void rai::node::start ()
 	ongoing_keepalive ();
 	ongoing_bootstrap ();
 	ongoing_store_flush ();
+	ongoing_unchecked_cleanup ();
 	ongoing_rep_crawl ();
 	bootstrap.start ();
 	backup_wallet ();
@@ -1998,6 +2427,7 @@ void rai::node::stop ()
 {
 	BOOST_LOG (log) << "Node stopping";
 	block_processor.stop ();
+	callback.stop ();
 	if (block_processor_thread.joinable ())
 	{
 		block_processor_thread.join ();
@@ -2071,6 +2501,7 @@ void rai::node::ongoing_keepalive ()
 	{
 		network.send_keepalive (i->endpoint);
 	}
+	bootstrap_scores_store ();
 	std::weak_ptr<rai::node> node_w (shared_from_this ());
 	alarm.add (std::chrono::steady_clock::now () + period, [node_w]() {
 		if (auto node_l = node_w.lock ())
@@ -2080,6 +2511,30 @@ void rai::node::ongoing_keepalive ()
 	});
 }
 
+/**
+ * Write the bootstrap scores changed since the last write and delete the rows of evicted ones
+ */
+void rai::node::bootstrap_scores_store ()
+{
+	std::unordered_map<rai::endpoint, rai::bootstrap_score> changed;
+	std::vector<rai::endpoint> evicted;
+	peers.bootstrap_scores_changes (changed, evicted);
+	if (!changed.empty () || !evicted.empty ())
+	{
+		rai::transaction transaction (store.environment, nullptr, true);
+		for (auto & i : evicted)
+		{
+			assert (i.address ().is_v6 ());
+			store.bootstrap_score_del (transaction, rai::endpoint_key (i.address ().to_v6 ().to_bytes (), i.port ()));
+		}
+		for (auto & i : changed)
+		{
+			assert (i.first.address ().is_v6 ());
+			store.bootstrap_score_put (transaction, rai::endpoint_key (i.first.address ().to_v6 ().to_bytes (), i.first.port ()), i.second);
+		}
+	}
+}
+
 void rai::node::ongoing_rep_crawl ()
 {
 	auto now (std::chrono::steady_clock::now ());
@@ -2134,6 +2589,30 @@ void rai::node::ongoing_store_flush ()
 	});
 }
 
+/**
+ * A sweep of the unchecked table starts every 5 minutes and is done in passes of unchecked_cleanup_batch entries a second apart,
+ * so the write lock is never held for long however large the table grows during bootstrap
+ */
+void rai::node::ongoing_unchecked_cleanup ()
+{
+	auto delay (unchecked_cleanup_cursor.is_zero () ? std::chrono::seconds (300) : std::chrono::seconds (1));
+	std::weak_ptr<rai::node> node_w (shared_from_this ());
+	alarm.add (std::chrono::steady_clock::now () + delay, [node_w]() {
+		if (auto node_l = node_w.lock ())
+		{
+			node_l->unchecked_cleanup ();
+			node_l->ongoing_unchecked_cleanup ();
+		}
+	});
+}
+
+void rai::node::unchecked_cleanup ()
+{
+	rai::transaction transaction (store.environment, nullptr, true);
+	auto evicted (store.unchecked_cleanup (transaction, rai::seconds_since_epoch () - config.unchecked_cutoff_time, unchecked_cleanup_cursor, unchecked_cleanup_batch));
+	stats.add (rai::stat::type::unchecked, rai::stat::detail::evict, rai::stat::dir::in, evicted);
+}
+
 void rai::node::backup_wallet ()
 {
 	rai::transaction transaction (store.environment, nullptr, false);
@@ -2612,6 +3091,324 @@ bool rai::block_arrival::recent (rai::block_hash const & hash_a)
 	return arrival.get<1> ().find (hash_a) != arrival.get<1> ().end ();
 }
 
+namespace rai
+{
+class callback_connection : public std::enable_shared_from_this<rai::callback_connection>
+{
+public:
+	callback_connection (std::shared_ptr<rai::node> const & node_a) :
+	socket (node_a->service),
+	node (node_a)
+	{
+	}
+	void connect (boost::asio::ip::tcp::resolver::iterator i_a)
+	{
+		auto this_l (shared_from_this ());
+		if (i_a != boost::asio::ip::tcp::resolver::iterator{})
+		{
+			socket.async_connect (i_a->endpoint (), [this_l, i_a](boost::system::error_code const & ec) {
+				if (!ec)
+				{
+					this_l->node->callback.connection_ready (this_l);
+				}
+				else
+				{
+					if (this_l->node->config.logging.callback_logging ())
+					{
+						BOOST_LOG (this_l->node->log) << boost::str (boost::format ("Unable to connect to callback address: %1%:%2%: %3%") % this_l->node->config.callback_address % this_l->node->config.callback_port % ec.message ());
+					}
+					boost::system::error_code ignored;
+					this_l->socket.close (ignored);
+					auto next (i_a);
+					this_l->connect (++next);
+				}
+			});
+		}
+		else
+		{
+			node->callback.connection_failed (this_l, std::vector<rai::callback_event> ());
+		}
+	}
+	void send (std::vector<rai::callback_event> const & events_a)
+	{
+		auto this_l (shared_from_this ());
+		auto events_l (std::make_shared<std::vector<rai::callback_event>> (events_a));
+		auto request (std::make_shared<boost::beast::http::request<boost::beast::http::string_body>> ());
+		request->method (boost::beast::http::verb::post);
+		request->target (node->config.callback_target);
+		request->version (11);
+		request->keep_alive (true);
+		request->insert (boost::beast::http::field::host, node->config.callback_address);
+		request->insert (boost::beast::http::field::content_type, "application/json");
+		if (node->config.callback_batch_max > 1)
+		{
+			// Batched delivery always posts a JSON array so receivers see a single format
+			std::string body ("[");
+			for (auto i (events_l->begin ()), n (events_l->end ()); i != n; ++i)
+			{
+				if (i != events_l->begin ())
+				{
+					body += ",";
+				}
+				body += i->body;
+			}
+			body += "]";
+			request->body () = body;
+		}
+		else
+		{
+			assert (events_l->size () == 1);
+			request->body () = events_l->front ().body;
+		}
+		request->prepare_payload ();
+		boost::beast::http::async_write (socket, *request, [this_l, request, events_l](boost::system::error_code const & ec, size_t bytes_transferred) {
+			if (!ec)
+			{
+				this_l->response = boost::beast::http::response<boost::beast::http::string_body> ();
+				boost::beast::http::async_read (this_l->socket, this_l->buffer, this_l->response, [this_l, events_l](boost::system::error_code const & ec, size_t bytes_transferred) {
+					if (!ec)
+					{
+						if (boost::beast::http::to_status_class (this_l->response.result ()) != boost::beast::http::status_class::successful && this_l->node->config.logging.callback_logging ())
+						{
+							BOOST_LOG (this_l->node->log) << boost::str (boost::format ("Callback to %1%:%2% failed with status: %3%") % this_l->node->config.callback_address % this_l->node->config.callback_port % this_l->response.result ());
+						}
+						this_l->node->callback.delivered (this_l, *events_l);
+					}
+					else
+					{
+						if (this_l->node->config.logging.callback_logging ())
+						{
+							BOOST_LOG (this_l->node->log) << boost::str (boost::format ("Unable complete callback: %1%:%2%: %3%") % this_l->node->config.callback_address % this_l->node->config.callback_port % ec.message ());
+						}
+						this_l->node->callback.connection_failed (this_l, *events_l);
+					}
+				});
+			}
+			else
+			{
+				if (this_l->node->config.logging.callback_logging ())
+				{
+					BOOST_LOG (this_l->node->log) << boost::str (boost::format ("Unable to send callback: %1%:%2%: %3%") % this_l->node->config.callback_address % this_l->node->config.callback_port % ec.message ());
+				}
+				this_l->node->callback.connection_failed (this_l, *events_l);
+			}
+		});
+	}
+	void close ()
+	{
+		boost::system::error_code ignored;
+		socket.close (ignored);
+	}
+	boost::asio::ip::tcp::socket socket;
+	boost::beast::flat_buffer buffer;
+	boost::beast::http::response<boost::beast::http::string_body> response;
+	// Handlers reach the node through this so it outlives any connect, write or read still in flight
+	std::shared_ptr<rai::node> node;
+};
+}
+
+rai::callback_dispatcher::callback_dispatcher (rai::node & node_a) :
+dropped (0),
+connections (0),
+stopped (false),
+node (node_a)
+{
+}
+
+void rai::callback_dispatcher::add (std::string const & body_a)
+{
+	std::unique_lock<std::mutex> lock (mutex);
+	if (!stopped)
+	{
+		if (events.size () < node.config.callback_queue_max)
+		{
+			events.push_back (rai::callback_event{ std::chrono::steady_clock::now (), body_a, 0 });
+			dispatch (lock);
+		}
+		else
+		{
+			++dropped;
+			node.stats.inc (rai::stat::type::http_callback, rai::stat::detail::overflow, rai::stat::dir::out);
+		}
+	}
+}
+
+void rai::callback_dispatcher::stop ()
+{
+	std::lock_guard<std::mutex> lock (mutex);
+	stopped = true;
+	events.clear ();
+	for (auto & i : idle)
+	{
+		i->close ();
+	}
+	idle.clear ();
+}
+
+size_t rai::callback_dispatcher::size ()
+{
+	std::lock_guard<std::mutex> lock (mutex);
+	return events.size ();
+}
+
+void rai::callback_dispatcher::dispatch (std::unique_lock<std::mutex> & lock_a)
+{
+	assert (lock_a.owns_lock ());
+	while (!events.empty () && !idle.empty ())
+	{
+		auto connection (idle.back ());
+		idle.pop_back ();
+		std::vector<rai::callback_event> batch;
+		while (!events.empty () && batch.size () < node.config.callback_batch_max)
+		{
+			batch.push_back (events.front ());
+			events.pop_front ();
+		}
+		node.background ([connection, batch]() {
+			connection->send (batch);
+		});
+	}
+	if (!events.empty () && connections < node.config.callback_connections)
+	{
+		++connections;
+		open_connection ();
+	}
+}
+
+void rai::callback_dispatcher::open_connection ()
+{
+	auto connection (std::make_shared<rai::callback_connection> (node.shared ()));
+	auto resolver (std::make_shared<boost::asio::ip::tcp::resolver> (node.service));
+	auto address (node.config.callback_address);
+	auto port (node.config.callback_port);
+	resolver->async_resolve (boost::asio::ip::tcp::resolver::query (address, std::to_string (port)), [connection, resolver, address, port](boost::system::error_code const & ec, boost::asio::ip::tcp::resolver::iterator i_a) {
+		if (!ec)
+		{
+			connection->connect (i_a);
+		}
+		else
+		{
+			if (connection->node->config.logging.callback_logging ())
+			{
+				BOOST_LOG (connection->node->log) << boost::str (boost::format ("Error resolving callback: %1%:%2%: %3%") % address % port % ec.message ());
+			}
+			connection->node->callback.connection_failed (connection, std::vector<rai::callback_event> ());
+		}
+	});
+}
+
+void rai::callback_dispatcher::connection_ready (std::shared_ptr<rai::callback_connection> connection_a)
+{
+	std::unique_lock<std::mutex> lock (mutex);
+	if (!stopped)
+	{
+		idle.push_back (connection_a);
+		dispatch (lock);
+	}
+	else
+	{
+		--connections;
+		connection_a->close ();
+	}
+}
+
+void rai::callback_dispatcher::delivered (std::shared_ptr<rai::callback_connection> connection_a, std::vector<rai::callback_event> const & events_a)
+{
+	auto now (std::chrono::steady_clock::now ());
+	// The target was reached, events it answered with an error status aren't retried but count as failed
+	auto success (boost::beast::http::to_status_class (connection_a->response.result ()) == boost::beast::http::status_class::successful);
+	for (auto & i : events_a)
+	{
+		if (success)
+		{
+			node.stats.inc (rai::stat::type::http_callback, rai::stat::detail::delivered, rai::stat::dir::out);
+			node.stats.add (rai::stat::type::http_callback, rai::stat::detail::latency_ms, rai::stat::dir::out, std::chrono::duration_cast<std::chrono::milliseconds> (now - i.arrival).count (), true);
+		}
+		else
+		{
+			++dropped;
+			node.stats.inc (rai::stat::type::http_callback, rai::stat::detail::failed, rai::stat::dir::out);
+		}
+	}
+	if (connection_a->response.keep_alive ())
+	{
+		connection_ready (connection_a);
+	}
+	else
+	{
+		connection_a->close ();
+		std::unique_lock<std::mutex> lock (mutex);
+		assert (connections > 0);
+		--connections;
+		if (!stopped)
+		{
+			dispatch (lock);
+		}
+	}
+}
+
+void rai::callback_dispatcher::connection_failed (std::shared_ptr<rai::callback_connection> connection_a, std::vector<rai::callback_event> const & events_a)
+{
+	connection_a->close ();
+	std::unique_lock<std::mutex> lock (mutex);
+	assert (connections > 0);
+	--connections;
+	if (!stopped)
+	{
+		if (!events_a.empty ())
+		{
+			// Servers commonly close idle keep-alive connections, put the events back and reconnect straight away
+			for (auto i (events_a.rbegin ()), n (events_a.rend ()); i != n; ++i)
+			{
+				requeue (*i);
+			}
+			dispatch (lock);
+		}
+		else
+		{
+			// Resolving or connecting failed, charge the oldest event so an unreachable target can't hold the queue forever
+			if (connections == 0 && !events.empty ())
+			{
+				auto event (events.front ());
+				events.pop_front ();
+				requeue (event);
+			}
+			std::weak_ptr<rai::node> node_w (node.shared ());
+			node.alarm.add (std::chrono::steady_clock::now () + retry_interval, [node_w]() {
+				if (auto node_l = node_w.lock ())
+				{
+					node_l->callback.retry ();
+				}
+			});
+		}
+	}
+}
+
+void rai::callback_dispatcher::requeue (rai::callback_event const & event_a)
+{
+	if (event_a.attempts + 1 < max_attempts)
+	{
+		auto event (event_a);
+		++event.attempts;
+		events.push_front (event);
+		node.stats.inc (rai::stat::type::http_callback, rai::stat::detail::retry, rai::stat::dir::out);
+	}
+	else
+	{
+		++dropped;
+		node.stats.inc (rai::stat::type::http_callback, rai::stat::detail::failed, rai::stat::dir::out);
+	}
+}
+
+void rai::callback_dispatcher::retry ()
+{
+	std::unique_lock<std::mutex> lock (mutex);
+	if (!stopped)
+	{
+		dispatch (lock);
+	}
+}
+
 rai::online_reps::online_reps (rai::node & node) :
 node (node)
 {
@@ -2755,6 +3552,7 @@ std::vector<rai::peer_information> rai::peer_container::purge_list (std::chrono:
 		std::lock_guard<std::mutex> lock (mutex);
 		auto pivot (peers.get<1> ().lower_bound (cutoff));
 		result.assign (pivot, peers.get<1> ().end ());
+		bootstrap_scores_evict ();
 		// Remove peers that haven't been heard from past the cutoff
 		peers.get<1> ().erase (peers.get<1> ().begin (), pivot);
 		for (auto i (peers.begin ()), n (peers.end ()); i != n; ++i)
@@ -3111,7 +3909,7 @@ void rai::election::compute_rep_votes (MDB_txn * transaction_a, std::shared_ptr<
 void rai::election::broadcast_winner ()
 {
 	rai::transaction transaction (node.store.environment, nullptr, false);
-	auto tally_l (node.ledger.tally (transaction, votes));
+	auto tally_l (votes.tally ());
 	auto winner_l (tally_l.begin ());
 	auto block_l (status.winner);
 	if (winner_l != tally_l.end ())
@@ -3149,7 +3947,7 @@ bool rai::election::have_quorum (rai::tally_t const & tally_a)
 
 void rai::election::confirm_if_quorum (MDB_txn * transaction_a)
 {
-	auto tally_l (node.ledger.tally (transaction_a, votes));
+	auto tally_l (votes.tally ());
 	assert (tally_l.size () > 0);
 	auto winner (tally_l.begin ());
 	auto block_l (winner->second);
@@ -3231,7 +4029,7 @@ bool rai::election::vote (std::shared_ptr<rai::vote> vote_a)
 		{
 			last_votes[vote_a->account] = { std::chrono::steady_clock::now (), vote_a->sequence, vote_a->block->hash () };
 			node.network.republish_vote (vote_a);
-			votes.vote (vote_a);
+			votes.vote (vote_a, weight);
 			confirm_if_quorum (transaction);
 		}
 	}
@@ -3454,6 +4252,8 @@ void rai::add_node_options (boost::program_options::options_description & descri
 		("account_key", "Get the public key for <account>")
 		("vacuum", "Compact database. If data_path is missing, the database in data directory is compacted.")
 		("snapshot", "Compact database and create snapshot, functions similar to vacuum but does not replace the existing database")
+		("snapshot_export", "Write the ledger to <file> as a portable, checksummed snapshot")
+		("snapshot_import", "Verify the snapshot in <file> and load it in to a ledger holding only genesis")
 		("data_path", boost::program_options::value<std::string> (), "Use the supplied path as the data directory")
 		("diagnostics", "Run internal diagnostics")
 		("key_create", "Generates a adhoc random keypair and prints it to stdout")
@@ -3624,6 +4424,85 @@ bool rai::handle_node_options (boost::program_options::variables_map & vm)
 			std::cerr << "Snapshot Failed" << std::endl;
 		}
 	}
+	else if (vm.count ("snapshot_export"))
+	{
+		if (vm.count ("file") == 1)
+		{
+			boost::filesystem::path path (vm["file"].as<std::string> ());
+			std::ofstream stream (path.string (), std::ios::binary | std::ios::trunc);
+			if (stream.is_open ())
+			{
+				inactive_node node (data_path);
+				rai::snapshot snapshot (node.node->ledger);
+				std::cout << "Exporting ledger, this may take a while..." << std::endl;
+				auto error (false);
+				{
+					rai::transaction transaction (node.node->store.environment, nullptr, false);
+					error = snapshot.write (transaction, stream);
+				}
+				if (!error)
+				{
+					std::cout << boost::str (boost::format ("Exported %1% accounts, %2% blocks and %3% pending entries\n") % snapshot.accounts % snapshot.blocks % snapshot.pending);
+				}
+				else
+				{
+					// A partial snapshot would only fail to import later
+					stream.close ();
+					boost::system::error_code ec;
+					boost::filesystem::remove (path, ec);
+					std::cerr << "Snapshot export failed\n";
+					result = true;
+				}
+			}
+			else
+			{
+				std::cerr << "Unable to open <file>\n";
+				result = true;
+			}
+		}
+		else
+		{
+			std::cerr << "snapshot_export command requires one <file> option\n";
+			result = true;
+		}
+	}
+	else if (vm.count ("snapshot_import"))
+	{
+		if (vm.count ("file") == 1)
+		{
+			std::ifstream stream (vm["file"].as<std::string> (), std::ios::binary);
+			if (stream.is_open ())
+			{
+				inactive_node node (data_path);
+				rai::snapshot snapshot (node.node->ledger);
+				std::cout << boost::str (boost::format ("Verifying and importing snapshot with %1% threads, this may take a while...\n") % snapshot.threads);
+				auto error (false);
+				{
+					rai::transaction transaction (node.node->store.environment, nullptr, true);
+					error = snapshot.read (transaction, stream);
+				}
+				if (!error)
+				{
+					std::cout << boost::str (boost::format ("Imported %1% accounts, %2% blocks and %3% pending entries\n") % snapshot.accounts % snapshot.blocks % snapshot.pending);
+				}
+				else
+				{
+					std::cerr << "Snapshot import failed, the ledger must hold only genesis and the snapshot must match this network\n";
+					result = true;
+				}
+			}
+			else
+			{
+				std::cerr << "Unable to open <file>\n";
+				result = true;
+			}
+		}
+		else
+		{
+			std::cerr << "snapshot_import command requires one <file> option\n";
+			result = true;
+		}
+	}
 	else if (vm.count ("diagnostics"))
 	{
 		inactive_node node (data_path);
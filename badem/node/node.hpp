@@ -6,6 +6,7 @@
 #include <badem/node/stats.hpp>
 #include <badem/node/wallet.hpp>
 
+#include <array>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
@@ -208,8 +209,14 @@ public:
 	std::map<rai::endpoint, unsigned> list_version ();
 	// A list of random peers sized for the configured rebroadcast fanout
 	std::deque<rai::endpoint> list_fanout ();
-	// Get the next peer for attempting bootstrap
+	// Get the best scoring of the peers least recently used for bootstrap
 	rai::endpoint bootstrap_peer ();
+	void bootstrap_completed (rai::endpoint const &, std::chrono::milliseconds const &, uint64_t, double);
+	void bootstrap_failed (rai::endpoint const &);
+	double bootstrap_score (rai::endpoint const &);
+	std::unordered_map<rai::endpoint, rai::bootstrap_score> bootstrap_scores_list ();
+	// Take the scores changed and the endpoints evicted since the last call
+	void bootstrap_scores_changes (std::unordered_map<rai::endpoint, rai::bootstrap_score> &, std::vector<rai::endpoint> &);
 	// Purge any peer where last_contact < time_point and return what was left
 	std::vector<rai::peer_information> purge_list (std::chrono::steady_clock::time_point const &);
 	std::vector<rai::endpoint> rep_crawl ();
@@ -239,11 +246,23 @@ public:
 	boost::multi_index::hashed_unique<boost::multi_index::member<peer_attempt, rai::endpoint, &peer_attempt::endpoint>>,
 	boost::multi_index::ordered_non_unique<boost::multi_index::member<peer_attempt, std::chrono::steady_clock::time_point, &peer_attempt::last_attempt>>>>
 	attempts;
+	// Scores outlive purges so a returning peer keeps its history, they're evicted by age and count instead
+	std::unordered_map<rai::endpoint, rai::bootstrap_score> bootstrap_scores;
+	// Endpoints whose score changed or was evicted since the last bootstrap_scores_changes
+	std::unordered_set<rai::endpoint> bootstrap_scores_dirty;
 	// Called when a new peer is observed
 	std::function<void(rai::endpoint const &)> peer_observer;
 	std::function<void()> disconnect_observer;
 	// Number of peers to crawl for being a rep every period
 	static size_t constexpr peers_per_crawl = 8;
+	// Number of least recently used peers compared when picking a bootstrap peer
+	static size_t constexpr bootstrap_candidates = 16;
+	// Seconds a bootstrap score is kept without being updated
+	static uint64_t constexpr bootstrap_score_cutoff = 7 * 24 * 60 * 60;
+	static size_t constexpr bootstrap_scores_max = 4096;
+
+private:
+	void bootstrap_scores_evict ();
 };
 class send_info
 {
@@ -445,7 +464,12 @@ public:
 	std::string callback_address;
 	uint16_t callback_port;
 	std::string callback_target;
+	unsigned callback_connections;
+	unsigned callback_queue_max;
+	unsigned callback_batch_max;
 	int lmdb_max_dbs;
+	size_t unchecked_cache_max;
+	uint64_t unchecked_cutoff_time;
 	rai::stat_config stat_config;
 	rai::block_hash state_block_parse_canary;
 	rai::block_hash state_block_generate_canary;
@@ -464,6 +488,43 @@ public:
 	rai::observer_set<> disconnect;
 	rai::observer_set<> started;
 };
+class callback_connection;
+class callback_event
+{
+public:
+	std::chrono::steady_clock::time_point arrival;
+	std::string body;
+	unsigned attempts;
+};
+// Delivers block callbacks to the configured HTTP endpoint
+// Events are queued up to a fixed bound and sent over a small pool of keep-alive connections, optionally several events per POST
+class callback_dispatcher
+{
+public:
+	callback_dispatcher (rai::node &);
+	void add (std::string const &);
+	void stop ();
+	size_t size ();
+	void connection_ready (std::shared_ptr<rai::callback_connection>);
+	void connection_failed (std::shared_ptr<rai::callback_connection>, std::vector<rai::callback_event> const &);
+	void delivered (std::shared_ptr<rai::callback_connection>, std::vector<rai::callback_event> const &);
+	void retry ();
+	// Events given up on, whether the queue was full, the target was unreachable or it answered with an error status
+	std::atomic<uint64_t> dropped;
+	static unsigned constexpr max_attempts = 3;
+	static std::chrono::seconds constexpr retry_interval = std::chrono::seconds (1);
+
+private:
+	void dispatch (std::unique_lock<std::mutex> &);
+	void open_connection ();
+	void requeue (rai::callback_event const &);
+	std::deque<rai::callback_event> events;
+	std::vector<std::shared_ptr<rai::callback_connection>> idle;
+	unsigned connections;
+	bool stopped;
+	std::mutex mutex;
+	rai::node & node;
+};
 class vote_processor
 {
 public:
@@ -481,6 +542,38 @@ public:
 	std::mutex mutex;
 	std::unordered_set<rai::block_hash> active;
 };
+// Where a block came from, each has its own queue in the block processor and they're listed from highest priority to lowest
+enum class block_origin : uint8_t
+{
+	// Created by one of our wallets
+	local,
+	// Published to us over the network
+	live,
+	// Pulled or pushed during bootstrap
+	bootstrap,
+	// Taken from the unchecked table once the block it depended on was processed
+	unchecked
+};
+// Threads kept for the whole life of the node to check the signatures of large block processor batches
+class signature_checker
+{
+public:
+	signature_checker (unsigned);
+	~signature_checker ();
+	// Split [0, size) into slices and call task on each, the calling thread takes a slice too. Returns once every slice is done
+	void run (size_t, std::function<void(size_t, size_t)> const &);
+	void stop ();
+
+private:
+	void loop ();
+	std::deque<std::function<void()>> tasks;
+	// Slices handed out and not yet finished
+	size_t pending;
+	bool stopped;
+	std::condition_variable condition;
+	std::mutex mutex;
+	std::vector<std::thread> threads;
+};
 // Processing blocks is a potentially long IO operation
 // This class isolates block insertion from other operations like servicing network operations
 class block_processor
@@ -490,25 +583,67 @@ public:
 	~block_processor ();
 	void stop ();
 	void flush ();
+	// Wait for blocks queued by our wallets, without waiting on the rest of the queue
+	void flush_local ();
 	bool full ();
-	void add (std::shared_ptr<rai::block>);
+	size_t size ();
+	// Queue a block in its origin's lane, local and live blocks are taken in small batches so they aren't held up
+	void add (std::shared_ptr<rai::block>, rai::block_origin = rai::block_origin::live);
+	// Queue a bootstrap chain given newest first, as it's pulled, so its oldest block is processed first
+	void add (std::vector<std::shared_ptr<rai::block>> const &);
 	void force (std::shared_ptr<rai::block>);
 	bool should_log ();
 	bool have_blocks ();
 	void process_blocks ();
-	rai::process_return process_receive_one (MDB_txn *, std::shared_ptr<rai::block>);
+	rai::process_return process_receive_one (MDB_txn *, std::shared_ptr<rai::block>, bool = false);
+	// Most blocks taken from the queue for one write transaction
+	static size_t const batch_max = 16384;
+	// Fewest blocks the adaptive batch size shrinks to
+	static size_t const batch_min = 64;
+	// Most blocks taken for one write transaction while local or live blocks are waiting
+	static size_t const live_batch_max = 256;
+	static size_t const lane_count = 4;
+	// Most blocks queued in a lane, further blocks are dropped. Bootstrap and unchecked blocks are never dropped, full () throttles bootstrap and the unchecked table bounds re-queued blocks
+	static size_t lane_max (rai::block_origin);
+	// Blocks taken from a lane on each turn before moving to the next
+	static size_t lane_weight (rai::block_origin);
+	size_t lane_size (rai::block_origin);
+	// Take up to the given number of blocks in processing order, paired with whether they were forced
+	std::vector<std::pair<std::shared_ptr<rai::block>, bool>> next_batch (size_t);
+	// Blocks to take for the next write transaction, capped at live_batch_max while local or live blocks are waiting
+	size_t next_batch_size ();
+	// Adjust the batch size after a commit held the write lock for the given time, full is whether the batch was full and left a backlog
+	void adapt (std::chrono::steady_clock::duration const &, bool);
+	// Write lock hold time the batch size is adjusted towards
+	static std::chrono::milliseconds constexpr batch_target = std::chrono::milliseconds (250);
+	// Smallest batch worth checking signatures for on several threads before it's written
+	static size_t const verify_threshold = 64;
 
 private:
 	void queue_unchecked (MDB_txn *, rai::block_hash const &);
+	bool push (std::shared_ptr<rai::block>, rai::block_origin);
+	std::vector<std::pair<std::shared_ptr<rai::block>, bool>> dequeue (size_t);
+	size_t queued ();
+	size_t batch_size_locked ();
 	void process_receive_many (std::unique_lock<std::mutex> &);
+	std::vector<uint8_t> verify_signatures (std::vector<std::pair<std::shared_ptr<rai::block>, bool>> const &);
 	bool stopped;
 	bool active;
 	std::chrono::steady_clock::time_point next_log;
-	std::deque<std::shared_ptr<rai::block>> blocks;
+	// Blocks to take for the next write transaction, halved when a commit holds the write lock past batch_target and doubled while the queue stays full and commits are quick
+	size_t batch_size;
+	// Indexed by block_origin
+	std::array<std::deque<std::shared_ptr<rai::block>>, lane_count> lanes;
+	// Lane being taken from and how many blocks it has given on this turn
+	size_t lane;
+	size_t lane_taken;
+	// Local blocks taken for the batch being written
+	size_t local_active;
 	std::deque<std::shared_ptr<rai::block>> forced;
 	std::condition_variable condition;
 	rai::node & node;
 	std::mutex mutex;
+	rai::signature_checker checker;
 };
 class node : public std::enable_shared_from_this<rai::node>
 {
@@ -530,7 +665,7 @@ public:
 	int store_version ();
 	void process_confirmed (std::shared_ptr<rai::block>);
 	void process_message (rai::message &, rai::endpoint const &);
-	void process_active (std::shared_ptr<rai::block>);
+	void process_active (std::shared_ptr<rai::block>, rai::block_origin = rai::block_origin::live);
 	rai::process_return process (rai::block const &);
 	void keepalive_preconfigured (std::vector<std::string> const &);
 	rai::block_hash latest (rai::account const &);
@@ -540,9 +675,12 @@ public:
 	rai::uint128_t weight (rai::account const &);
 	rai::account representative (rai::account const &);
 	void ongoing_keepalive ();
+	void bootstrap_scores_store ();
 	void ongoing_rep_crawl ();
 	void ongoing_bootstrap ();
 	void ongoing_store_flush ();
+	void ongoing_unchecked_cleanup ();
+	void unchecked_cleanup ();
 	void backup_wallet ();
 	int price (rai::uint128_t const &, int);
 	void work_generate_blocking (rai::block &);
@@ -577,6 +715,11 @@ public:
 	rai::block_arrival block_arrival;
 	rai::online_reps online_reps;
 	rai::stat stats;
+	rai::callback_dispatcher callback;
+	// Key the next unchecked cleanup pass resumes from, zero when a sweep is complete
+	rai::block_hash unchecked_cleanup_cursor;
+	// Most unchecked entries examined in one write transaction
+	static size_t const unchecked_cleanup_batch = 16384;
 	static double constexpr price_max = 16.0;
 	static double constexpr free_cutoff = 1024.0;
 	static std::chrono::seconds constexpr period = std::chrono::seconds (60);
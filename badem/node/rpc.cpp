@@ -223,6 +223,43 @@ bool decode_unsigned (std::string const & text, uint64_t & number)
 	result = result || end != text.size ();
 	return result;
 }
+
+/*
+ * Paged RPCs return a "cursor" when results were cut short, passing it back resumes from where the page ended.
+ * Cursors are the hex encoded key the next page starts at and are opaque to clients.
+ */
+std::string cursor_encode (rai::uint256_union const & key_a)
+{
+	return key_a.to_string ();
+}
+
+std::string cursor_encode (rai::uint128_union const & balance_a, rai::account const & account_a)
+{
+	std::string result;
+	balance_a.encode_hex (result);
+	result += account_a.to_string ();
+	return result;
+}
+
+bool cursor_decode (std::string const & text_a, rai::uint256_union & key_a)
+{
+	auto result (text_a.size () != 64);
+	if (!result)
+	{
+		result = key_a.decode_hex (text_a);
+	}
+	return result;
+}
+
+bool cursor_decode (std::string const & text_a, rai::uint128_union & balance_a, rai::account & account_a)
+{
+	auto result (text_a.size () != 96);
+	if (!result)
+	{
+		result = balance_a.decode_hex (text_a.substr (0, 32)) || account_a.decode_hex (text_a.substr (32));
+	}
+	return result;
+}
 }
 
 void rai::rpc_handler::account_balance ()
@@ -705,6 +742,73 @@ void rai::rpc_handler::accounts_balances ()
 	response (response_l);
 }
 
+void rai::rpc_handler::accounts_balance_range ()
+{
+	rai::uint128_union min (0);
+	rai::uint128_union max (std::numeric_limits<rai::uint128_t>::max ());
+	boost::optional<std::string> min_text (request.get_optional<std::string> ("min"));
+	boost::optional<std::string> max_text (request.get_optional<std::string> ("max"));
+	auto error (min_text.is_initialized () && min.decode_dec (min_text.get ()));
+	error = error || (max_text.is_initialized () && max.decode_dec (max_text.get ()));
+	if (!error)
+	{
+		accounts_by_balance (min.number (), max.number ());
+	}
+	else
+	{
+		error_response (response, "Bad amount number");
+	}
+}
+
+// Walks the balance index from the largest balance down, returning accounts with a balance in [min, max]
+void rai::rpc_handler::accounts_by_balance (rai::uint128_t const & min_a, rai::uint128_t const & max_a)
+{
+	uint64_t count (rpc.config.frontier_request_limit);
+	boost::optional<std::string> count_text (request.get_optional<std::string> ("count"));
+	auto error (count_text.is_initialized () && decode_unsigned (count_text.get (), count));
+	if (!error)
+	{
+		count = std::min (count, rpc.config.frontier_request_limit);
+		rai::balance_key start (max_a, rai::account (0));
+		boost::optional<std::string> cursor_text (request.get_optional<std::string> ("cursor"));
+		if (cursor_text.is_initialized ())
+		{
+			rai::uint128_union balance;
+			rai::account account;
+			error = cursor_decode (cursor_text.get (), balance, account) || balance.number () > max_a;
+			start = rai::balance_key (balance.number (), account);
+		}
+		if (!error)
+		{
+			boost::property_tree::ptree response_l;
+			boost::property_tree::ptree accounts;
+			rai::transaction transaction (node.store.environment, nullptr, false);
+			auto i (node.store.balance_begin (transaction, start));
+			auto n (node.store.balance_end ());
+			for (; i != n && accounts.size () < count && rai::balance_key (i->first).balance () >= min_a; ++i)
+			{
+				rai::balance_key key (i->first);
+				accounts.put (key.account.to_account (), key.balance ().convert_to<std::string> ());
+			}
+			response_l.add_child ("accounts", accounts);
+			if (i != n && rai::balance_key (i->first).balance () >= min_a)
+			{
+				rai::balance_key key (i->first);
+				response_l.put ("cursor", cursor_encode (key.balance (), key.account));
+			}
+			response (response_l);
+		}
+		else
+		{
+			error_response (response, "Invalid cursor");
+		}
+	}
+	else
+	{
+		error_response (response, "Invalid count limit");
+	}
+}
+
 void rai::rpc_handler::accounts_create ()
 {
 	if (rpc.config.enable_control)
@@ -819,21 +923,22 @@ void rai::rpc_handler::accounts_pending ()
 		if (!account.decode_account (account_text))
 		{
 			boost::property_tree::ptree peers_l;
-			rai::account end (account.number () + 1);
-			for (auto i (node.store.pending_begin (transaction, rai::pending_key (account, 0))), n (node.store.pending_begin (transaction, rai::pending_key (end, 0))); i != n && peers_l.size () < count; ++i)
+			// Accounts with nothing pending above the threshold are answered from their totals alone
+			auto totals (node.store.pending_totals_get (transaction, account));
+			if (totals.count != 0 && totals.sum.number () >= threshold.number ())
 			{
-				rai::pending_key key (i->first);
-				if (threshold.is_zero () && !source)
-				{
-					boost::property_tree::ptree entry;
-					entry.put ("", key.hash.to_string ());
-					peers_l.push_back (std::make_pair ("", entry));
-				}
-				else
+				for (rai::pending_iterator i (transaction, node.store, account, threshold.number ()); !i.done () && peers_l.size () < count; ++i)
 				{
-					rai::pending_info info (i->second);
-					if (info.amount.number () >= threshold.number ())
+					auto key (i.key ());
+					if (threshold.is_zero () && !source)
+					{
+						boost::property_tree::ptree entry;
+						entry.put ("", key.hash.to_string ());
+						peers_l.push_back (std::make_pair ("", entry));
+					}
+					else
 					{
+						auto info (i.info ());
 						if (source)
 						{
 							boost::property_tree::ptree pending_tree;
@@ -859,6 +964,11 @@ void rai::rpc_handler::accounts_pending ()
 	response (response_l);
 }
 
+void rai::rpc_handler::accounts_top ()
+{
+	accounts_by_balance (0, std::numeric_limits<rai::uint128_t>::max ());
+}
+
 void rai::rpc_handler::available_supply ()
 {
 	auto genesis_balance (node.balance (rai::genesis_account)); // Cold storage genesis
@@ -1062,6 +1172,7 @@ void rai::rpc_handler::block_count ()
 	boost::property_tree::ptree response_l;
 	response_l.put ("count", std::to_string (node.store.block_count (transaction).sum ()));
 	response_l.put ("unchecked", std::to_string (node.store.unchecked_count (transaction)));
+	response_l.put ("pending", std::to_string (node.store.pending_count (transaction)));
 	response (response_l);
 }
 
@@ -1488,6 +1599,87 @@ void rai::rpc_handler::bootstrap_any ()
 	response (response_l);
 }
 
+void rai::rpc_handler::bootstrap_lazy ()
+{
+	std::string hash_text (request.get<std::string> ("hash"));
+	rai::block_hash hash;
+	if (!hash.decode_hex (hash_text))
+	{
+		auto existing (false);
+		{
+			rai::transaction transaction (node.store.environment, nullptr, false);
+			existing = node.store.block_exists (transaction, hash);
+		}
+		if (!existing)
+		{
+			node.bootstrap_initiator.bootstrap_lazy (hash);
+		}
+		boost::property_tree::ptree response_l;
+		response_l.put ("started", existing ? "0" : "1");
+		response (response_l);
+	}
+	else
+	{
+		error_response (response, "Bad hash number");
+	}
+}
+
+void rai::rpc_handler::bootstrap_status ()
+{
+	boost::property_tree::ptree response_l;
+	auto attempt (node.bootstrap_initiator.current_attempt ());
+	response_l.put ("running", attempt != nullptr ? "1" : "0");
+	if (attempt != nullptr)
+	{
+		auto elapsed (std::chrono::duration_cast<std::chrono::seconds> (std::chrono::steady_clock::now () - attempt->start_time).count ());
+		response_l.put ("phase", attempt->phase_string ());
+		response_l.put ("elapsed_seconds", std::to_string (elapsed));
+		response_l.put ("frontiers_received", std::to_string (attempt->frontiers_received));
+		response_l.put ("total_blocks", std::to_string (attempt->total_blocks));
+		size_t queued (0);
+		double rate (0.0);
+		boost::property_tree::ptree connections;
+		{
+			std::lock_guard<std::mutex> lock (attempt->mutex);
+			queued = attempt->pulls.size ();
+			for (auto & i : attempt->clients)
+			{
+				if (auto client = i.lock ())
+				{
+					boost::property_tree::ptree entry;
+					entry.put ("endpoint", boost::str (boost::format ("%1%") % client->endpoint));
+					entry.put ("blocks", std::to_string (client->block_count));
+					entry.put ("block_rate", std::to_string (client->block_rate ()));
+					entry.put ("elapsed_seconds", std::to_string (client->elapsed_seconds ()));
+					connections.push_back (std::make_pair ("", entry));
+					rate += client->block_rate ();
+				}
+			}
+		}
+		auto in_flight (attempt->pulling.load ());
+		auto completed (attempt->pulls_completed.load ());
+		response_l.put ("pulls_queued", std::to_string (queued));
+		response_l.put ("pulls_in_flight", std::to_string (in_flight));
+		response_l.put ("pulls_completed", std::to_string (completed));
+		response_l.put ("pulls_failed", std::to_string (attempt->pulls_failed));
+		response_l.put ("block_rate", std::to_string (rate));
+		// Estimated from the pull completion rate so far, left empty until a pull has completed
+		std::string eta;
+		if (completed > 0 && elapsed > 0)
+		{
+			eta = std::to_string (static_cast<uint64_t> ((queued + in_flight) * static_cast<double> (elapsed) / completed));
+		}
+		response_l.put ("eta_seconds", eta);
+		response_l.add_child ("connections", connections);
+	}
+	{
+		rai::transaction transaction (node.store.environment, nullptr, false);
+		response_l.put ("unchecked", std::to_string (node.store.unchecked_count (transaction)));
+	}
+	response_l.put ("block_processor_queue", std::to_string (node.block_processor.size ()));
+	response (response_l);
+}
+
 void rai::rpc_handler::chain ()
 {
 	std::string block_text (request.get<std::string> ("block"));
@@ -1561,9 +1753,9 @@ void rai::rpc_handler::delegators ()
 		for (auto i (node.store.latest_begin (transaction)), n (node.store.latest_end ()); i != n; ++i)
 		{
 			rai::account_info info (i->second);
-			auto block (node.store.block_get (transaction, info.rep_block));
-			assert (block != nullptr);
-			if (block->representative () == account)
+			auto block (node.store.block_get_view (transaction, info.rep_block));
+			assert (block.type != rai::block_type::invalid);
+			if (block.representative () == account)
 			{
 				std::string balance;
 				rai::uint128_union (info.balance).encode_dec (balance);
@@ -1647,22 +1839,30 @@ void rai::rpc_handler::deterministic_key ()
 
 void rai::rpc_handler::frontiers ()
 {
-	std::string account_text (request.get<std::string> ("account"));
 	std::string count_text (request.get<std::string> ("count"));
+	boost::optional<std::string> cursor_text (request.get_optional<std::string> ("cursor"));
 	rai::account start;
-	if (!start.decode_account (account_text))
+	auto error (cursor_text.is_initialized () ? cursor_decode (cursor_text.get (), start) : start.decode_account (request.get<std::string> ("account")));
+	if (!error)
 	{
 		uint64_t count;
 		if (!decode_unsigned (count_text, count))
 		{
+			count = std::min (count, rpc.config.frontier_request_limit);
 			boost::property_tree::ptree response_l;
 			boost::property_tree::ptree frontiers;
 			rai::transaction transaction (node.store.environment, nullptr, false);
-			for (auto i (node.store.latest_begin (transaction, start)), n (node.store.latest_end ()); i != n && frontiers.size () < count; ++i)
+			auto i (node.store.latest_begin (transaction, start));
+			auto n (node.store.latest_end ());
+			for (; i != n && frontiers.size () < count; ++i)
 			{
 				frontiers.put (rai::account (i->first.uint256 ()).to_account (), rai::account_info (i->second).head.to_string ());
 			}
 			response_l.add_child ("frontiers", frontiers);
+			if (i != n)
+			{
+				response_l.put ("cursor", cursor_encode (i->first.uint256 ()));
+			}
 			response (response_l);
 		}
 		else
@@ -1971,125 +2171,154 @@ void rai::rpc_handler::ledger ()
 {
 	if (rpc.config.enable_control)
 	{
+		auto error (false);
 		rai::account start (0);
 		uint64_t count (std::numeric_limits<uint64_t>::max ());
 		boost::optional<std::string> account_text (request.get_optional<std::string> ("account"));
 		if (account_text.is_initialized ())
 		{
-			auto error (start.decode_account (account_text.get ()));
+			error = start.decode_account (account_text.get ());
 			if (error)
 			{
 				error_response (response, "Invalid starting account");
 			}
 		}
 		boost::optional<std::string> count_text (request.get_optional<std::string> ("count"));
-		if (count_text.is_initialized ())
+		if (count_text.is_initialized () && !error)
 		{
-			auto error_count (decode_unsigned (count_text.get (), count));
-			if (error_count)
+			error = decode_unsigned (count_text.get (), count);
+			if (error)
 			{
 				error_response (response, "Invalid count limit");
 			}
 		}
-		uint64_t modified_since (0);
-		boost::optional<std::string> modified_since_text (request.get_optional<std::string> ("modified_since"));
-		if (modified_since_text.is_initialized ())
+		count = std::min (count, rpc.config.frontier_request_limit);
+		const bool sorting = request.get<bool> ("sorting", false);
+		// Sorted pages resume at a (balance, account) pair in the balance index, unsorted pages resume at an account
+		boost::optional<std::pair<rai::uint128_union, rai::account>> sorted_cursor;
+		boost::optional<std::string> cursor_text (request.get_optional<std::string> ("cursor"));
+		if (cursor_text.is_initialized () && !error)
 		{
-			modified_since = strtoul (modified_since_text.get ().c_str (), NULL, 10);
+			if (sorting)
+			{
+				std::pair<rai::uint128_union, rai::account> cursor_l;
+				error = cursor_decode (cursor_text.get (), cursor_l.first, cursor_l.second);
+				sorted_cursor = cursor_l;
+			}
+			else
+			{
+				error = cursor_decode (cursor_text.get (), start);
+			}
+			if (error)
+			{
+				error_response (response, "Invalid cursor");
+			}
 		}
-		const bool sorting = request.get<bool> ("sorting", false);
-		const bool representative = request.get<bool> ("representative", false);
-		const bool weight = request.get<bool> ("weight", false);
-		const bool pending = request.get<bool> ("pending", false);
-		boost::property_tree::ptree response_a;
-		boost::property_tree::ptree response_l;
-		boost::property_tree::ptree accounts;
-		rai::transaction transaction (node.store.environment, nullptr, false);
-		if (!sorting) // Simple
+		if (!error)
 		{
-			for (auto i (node.store.latest_begin (transaction, start)), n (node.store.latest_end ()); i != n && accounts.size () < count; ++i)
+			uint64_t modified_since (0);
+			boost::optional<std::string> modified_since_text (request.get_optional<std::string> ("modified_since"));
+			if (modified_since_text.is_initialized ())
+			{
+				modified_since = strtoul (modified_since_text.get ().c_str (), NULL, 10);
+			}
+			const bool representative = request.get<bool> ("representative", false);
+			const bool weight = request.get<bool> ("weight", false);
+			const bool pending = request.get<bool> ("pending", false);
+			boost::property_tree::ptree response_a;
+			boost::property_tree::ptree response_l;
+			boost::property_tree::ptree accounts;
+			rai::transaction transaction (node.store.environment, nullptr, false);
+			if (!sorting) // Simple
 			{
-				rai::account_info info (i->second);
-				if (info.modified >= modified_since)
+				auto i (node.store.latest_begin (transaction, start));
+				auto n (node.store.latest_end ());
+				for (; i != n && accounts.size () < count; ++i)
 				{
-					rai::account account (i->first.uint256 ());
-					boost::property_tree::ptree response_l;
-					response_l.put ("frontier", info.head.to_string ());
-					response_l.put ("open_block", info.open_block.to_string ());
-					response_l.put ("representative_block", info.rep_block.to_string ());
-					std::string balance;
-					rai::uint128_union (info.balance).encode_dec (balance);
-					response_l.put ("balance", balance);
-					response_l.put ("modified_timestamp", std::to_string (info.modified));
-					response_l.put ("block_count", std::to_string (info.block_count));
-					if (representative)
-					{
-						auto block (node.store.block_get (transaction, info.rep_block));
-						assert (block != nullptr);
-						response_l.put ("representative", block->representative ().to_account ());
-					}
-					if (weight)
-					{
-						auto account_weight (node.ledger.weight (transaction, account));
-						response_l.put ("weight", account_weight.convert_to<std::string> ());
-					}
-					if (pending)
+					rai::account_info info (i->second);
+					if (info.modified >= modified_since)
 					{
-						auto account_pending (node.ledger.account_pending (transaction, account));
-						response_l.put ("pending", account_pending.convert_to<std::string> ());
+						rai::account account (i->first.uint256 ());
+						boost::property_tree::ptree response_l;
+						response_l.put ("frontier", info.head.to_string ());
+						response_l.put ("open_block", info.open_block.to_string ());
+						response_l.put ("representative_block", info.rep_block.to_string ());
+						std::string balance;
+						rai::uint128_union (info.balance).encode_dec (balance);
+						response_l.put ("balance", balance);
+						response_l.put ("modified_timestamp", std::to_string (info.modified));
+						response_l.put ("block_count", std::to_string (info.block_count));
+						if (representative)
+						{
+							auto block (node.store.block_get (transaction, info.rep_block));
+							assert (block != nullptr);
+							response_l.put ("representative", block->representative ().to_account ());
+						}
+						if (weight)
+						{
+							auto account_weight (node.ledger.weight (transaction, account));
+							response_l.put ("weight", account_weight.convert_to<std::string> ());
+						}
+						if (pending)
+						{
+							auto account_pending (node.ledger.account_pending (transaction, account));
+							response_l.put ("pending", account_pending.convert_to<std::string> ());
+						}
+						accounts.push_back (std::make_pair (account.to_account (), response_l));
 					}
-					accounts.push_back (std::make_pair (account.to_account (), response_l));
 				}
-			}
-		}
-		else // Sorting
-		{
-			std::vector<std::pair<rai::uint128_union, rai::account>> ledger_l;
-			for (auto i (node.store.latest_begin (transaction, start)), n (node.store.latest_end ()); i != n; ++i)
-			{
-				rai::account_info info (i->second);
-				rai::uint128_union balance (info.balance);
-				if (info.modified >= modified_since)
+				if (i != n)
 				{
-					ledger_l.push_back (std::make_pair (balance, rai::account (i->first.uint256 ())));
+					response_a.put ("cursor", cursor_encode (i->first.uint256 ()));
 				}
 			}
-			std::sort (ledger_l.begin (), ledger_l.end ());
-			std::reverse (ledger_l.begin (), ledger_l.end ());
-			rai::account_info info;
-			for (auto i (ledger_l.begin ()), n (ledger_l.end ()); i != n && accounts.size () < count; ++i)
+			else // Sorting
 			{
-				node.store.account_get (transaction, i->second, info);
-				rai::account account (i->second);
-				response_l.put ("frontier", info.head.to_string ());
-				response_l.put ("open_block", info.open_block.to_string ());
-				response_l.put ("representative_block", info.rep_block.to_string ());
-				std::string balance;
-				(i->first).encode_dec (balance);
-				response_l.put ("balance", balance);
-				response_l.put ("modified_timestamp", std::to_string (info.modified));
-				response_l.put ("block_count", std::to_string (info.block_count));
-				if (representative)
+				auto i (sorted_cursor ? node.store.balance_begin (transaction, rai::balance_key (sorted_cursor->first.number (), sorted_cursor->second)) : node.store.balance_begin (transaction));
+				auto n (node.store.balance_end ());
+				for (; i != n && accounts.size () < count; ++i)
 				{
-					auto block (node.store.block_get (transaction, info.rep_block));
-					assert (block != nullptr);
-					response_l.put ("representative", block->representative ().to_account ());
-				}
-				if (weight)
-				{
-					auto account_weight (node.ledger.weight (transaction, account));
-					response_l.put ("weight", account_weight.convert_to<std::string> ());
+					rai::balance_key key (i->first);
+					rai::account account (key.account);
+					rai::account_info info;
+					if (!(account < start) && !node.store.account_get (transaction, account, info) && info.modified >= modified_since)
+					{
+						response_l.put ("frontier", info.head.to_string ());
+						response_l.put ("open_block", info.open_block.to_string ());
+						response_l.put ("representative_block", info.rep_block.to_string ());
+						std::string balance;
+						rai::uint128_union (key.balance ()).encode_dec (balance);
+						response_l.put ("balance", balance);
+						response_l.put ("modified_timestamp", std::to_string (info.modified));
+						response_l.put ("block_count", std::to_string (info.block_count));
+						if (representative)
+						{
+							auto block (node.store.block_get (transaction, info.rep_block));
+							assert (block != nullptr);
+							response_l.put ("representative", block->representative ().to_account ());
+						}
+						if (weight)
+						{
+							auto account_weight (node.ledger.weight (transaction, account));
+							response_l.put ("weight", account_weight.convert_to<std::string> ());
+						}
+						if (pending)
+						{
+							auto account_pending (node.ledger.account_pending (transaction, account));
+							response_l.put ("pending", account_pending.convert_to<std::string> ());
+						}
+						accounts.push_back (std::make_pair (account.to_account (), response_l));
+					}
 				}
-				if (pending)
+				if (i != n)
 				{
-					auto account_pending (node.ledger.account_pending (transaction, account));
-					response_l.put ("pending", account_pending.convert_to<std::string> ());
+					rai::balance_key key (i->first);
+					response_a.put ("cursor", cursor_encode (key.balance (), key.account));
 				}
-				accounts.push_back (std::make_pair (account.to_account (), response_l));
 			}
+			response_a.add_child ("accounts", accounts);
+			response (response_a);
 		}
-		response_a.add_child ("accounts", accounts);
-		response (response_a);
 	}
 	else
 	{
@@ -2255,46 +2484,58 @@ void rai::rpc_handler::pending ()
 	rai::account account;
 	if (!account.decode_account (account_text))
 	{
+		auto error (false);
 		uint64_t count (std::numeric_limits<uint64_t>::max ());
 		rai::uint128_union threshold (0);
 		boost::optional<std::string> count_text (request.get_optional<std::string> ("count"));
 		if (count_text.is_initialized ())
 		{
-			auto error (decode_unsigned (count_text.get (), count));
+			error = decode_unsigned (count_text.get (), count);
 			if (error)
 			{
 				error_response (response, "Invalid count limit");
 			}
 		}
 		boost::optional<std::string> threshold_text (request.get_optional<std::string> ("threshold"));
-		if (threshold_text.is_initialized ())
+		if (threshold_text.is_initialized () && !error)
 		{
-			auto error_threshold (threshold.decode_dec (threshold_text.get ()));
-			if (error_threshold)
+			error = threshold.decode_dec (threshold_text.get ());
+			if (error)
 			{
 				error_response (response, "Bad threshold number");
 			}
 		}
-		const bool source = request.get<bool> ("source", false);
-		boost::property_tree::ptree response_l;
-		boost::property_tree::ptree peers_l;
+		count = std::min (count, rpc.config.chain_request_limit);
+		rai::block_hash start (0);
+		boost::optional<std::string> cursor_text (request.get_optional<std::string> ("cursor"));
+		if (cursor_text.is_initialized () && !error)
 		{
-			rai::transaction transaction (node.store.environment, nullptr, false);
-			rai::account end (account.number () + 1);
-			for (auto i (node.store.pending_begin (transaction, rai::pending_key (account, 0))), n (node.store.pending_begin (transaction, rai::pending_key (end, 0))); i != n && peers_l.size () < count; ++i)
+			error = cursor_decode (cursor_text.get (), start);
+			if (error)
 			{
-				rai::pending_key key (i->first);
-				if (threshold.is_zero () && !source)
-				{
-					boost::property_tree::ptree entry;
-					entry.put ("", key.hash.to_string ());
-					peers_l.push_back (std::make_pair ("", entry));
-				}
-				else
+				error_response (response, "Invalid cursor");
+			}
+		}
+		if (!error)
+		{
+			const bool source = request.get<bool> ("source", false);
+			boost::property_tree::ptree response_l;
+			boost::property_tree::ptree peers_l;
+			{
+				rai::transaction transaction (node.store.environment, nullptr, false);
+				rai::pending_iterator i (transaction, node.store, account, threshold.number (), start);
+				for (; !i.done () && peers_l.size () < count; ++i)
 				{
-					rai::pending_info info (i->second);
-					if (info.amount.number () >= threshold.number ())
+					auto key (i.key ());
+					if (threshold.is_zero () && !source)
 					{
+						boost::property_tree::ptree entry;
+						entry.put ("", key.hash.to_string ());
+						peers_l.push_back (std::make_pair ("", entry));
+					}
+					else
+					{
+						auto info (i.info ());
 						if (source)
 						{
 							boost::property_tree::ptree pending_tree;
@@ -2308,10 +2549,14 @@ void rai::rpc_handler::pending ()
 						}
 					}
 				}
+				if (!i.done ())
+				{
+					response_l.put ("cursor", cursor_encode (i.key ().hash));
+				}
 			}
+			response_l.add_child ("blocks", peers_l);
+			response (response_l);
 		}
-		response_l.add_child ("blocks", peers_l);
-		response (response_l);
 	}
 	else
 	{
@@ -3202,6 +3447,10 @@ void rai::rpc_handler::stats ()
 	{
 		node.stats.log_samples (*sink);
 	}
+	else if (type == "histograms")
+	{
+		node.stats.log_histograms (*sink);
+	}
 	else
 	{
 		error = true;
@@ -3232,29 +3481,53 @@ void rai::rpc_handler::stop ()
 
 void rai::rpc_handler::unchecked ()
 {
+	auto error (false);
 	uint64_t count (std::numeric_limits<uint64_t>::max ());
 	boost::optional<std::string> count_text (request.get_optional<std::string> ("count"));
 	if (count_text.is_initialized ())
 	{
-		auto error (decode_unsigned (count_text.get (), count));
+		error = decode_unsigned (count_text.get (), count);
 		if (error)
 		{
 			error_response (response, "Invalid count limit");
 		}
 	}
-	boost::property_tree::ptree response_l;
-	boost::property_tree::ptree unchecked;
-	rai::transaction transaction (node.store.environment, nullptr, false);
-	for (auto i (node.store.unchecked_begin (transaction)), n (node.store.unchecked_end ()); i != n && unchecked.size () < count; ++i)
+	count = std::min (count, rpc.config.chain_request_limit);
+	rai::block_hash start (0);
+	boost::optional<std::string> cursor_text (request.get_optional<std::string> ("cursor"));
+	if (cursor_text.is_initialized () && !error)
 	{
-		rai::bufferstream stream (reinterpret_cast<uint8_t const *> (i->second.data ()), i->second.size ());
-		auto block (rai::deserialize_block (stream));
-		std::string contents;
-		block->serialize_json (contents);
-		unchecked.put (block->hash ().to_string (), contents);
+		error = cursor_decode (cursor_text.get (), start);
+		if (error)
+		{
+			error_response (response, "Invalid cursor");
+		}
+	}
+	if (!error)
+	{
+		boost::property_tree::ptree response_l;
+		boost::property_tree::ptree unchecked;
+		rai::transaction transaction (node.store.environment, nullptr, false);
+		auto i (node.store.unchecked_begin (transaction, start));
+		auto n (node.store.unchecked_end ());
+		rai::block_hash last (0);
+		// Pages only end between dependencies so all blocks waiting on the same hash are returned together
+		for (; i != n && (unchecked.size () < count || rai::block_hash (i->first.uint256 ()) == last); ++i)
+		{
+			last = i->first.uint256 ();
+			rai::bufferstream stream (reinterpret_cast<uint8_t const *> (i->second.data ()), i->second.size ());
+			auto block (rai::deserialize_block (stream));
+			std::string contents;
+			block->serialize_json (contents);
+			unchecked.put (block->hash ().to_string (), contents);
+		}
+		response_l.add_child ("blocks", unchecked);
+		if (i != n)
+		{
+			response_l.put ("cursor", cursor_encode (i->first.uint256 ()));
+		}
+		response (response_l);
 	}
-	response_l.add_child ("blocks", unchecked);
-	response (response_l);
 }
 
 void rai::rpc_handler::unchecked_clear ()
@@ -3808,6 +4081,7 @@ void rai::rpc_handler::wallet_key_valid ()
 
 void rai::rpc_handler::wallet_ledger ()
 {
+	auto error (false);
 	const bool representative = request.get<bool> ("representative", false);
 	const bool weight = request.get<bool> ("weight", false);
 	const bool pending = request.get<bool> ("pending", false);
@@ -3817,66 +4091,95 @@ void rai::rpc_handler::wallet_ledger ()
 	{
 		modified_since = strtoul (modified_since_text.get ().c_str (), NULL, 10);
 	}
-	std::string wallet_text (request.get<std::string> ("wallet"));
-	rai::uint256_union wallet;
-	auto error (wallet.decode_hex (wallet_text));
+	uint64_t count (std::numeric_limits<uint64_t>::max ());
+	boost::optional<std::string> count_text (request.get_optional<std::string> ("count"));
+	if (count_text.is_initialized ())
+	{
+		error = decode_unsigned (count_text.get (), count);
+		if (error)
+		{
+			error_response (response, "Invalid count limit");
+		}
+	}
+	count = std::min (count, rpc.config.frontier_request_limit);
+	rai::account start (rai::wallet_store::special_count);
+	boost::optional<std::string> cursor_text (request.get_optional<std::string> ("cursor"));
+	if (cursor_text.is_initialized () && !error)
+	{
+		error = cursor_decode (cursor_text.get (), start) || start.number () < rai::wallet_store::special_count;
+		if (error)
+		{
+			error_response (response, "Invalid cursor");
+		}
+	}
 	if (!error)
 	{
-		auto existing (node.wallets.items.find (wallet));
-		if (existing != node.wallets.items.end ())
+		std::string wallet_text (request.get<std::string> ("wallet"));
+		rai::uint256_union wallet;
+		if (!wallet.decode_hex (wallet_text))
 		{
-			boost::property_tree::ptree response_l;
-			boost::property_tree::ptree accounts;
-			rai::transaction transaction (node.store.environment, nullptr, false);
-			for (auto i (existing->second->store.begin (transaction)), n (existing->second->store.end ()); i != n; ++i)
+			auto existing (node.wallets.items.find (wallet));
+			if (existing != node.wallets.items.end ())
 			{
-				rai::account account (i->first.uint256 ());
-				rai::account_info info;
-				if (!node.store.account_get (transaction, account, info))
+				boost::property_tree::ptree response_l;
+				boost::property_tree::ptree accounts;
+				rai::transaction transaction (node.store.environment, nullptr, false);
+				auto i (existing->second->store.begin (transaction, start));
+				auto n (existing->second->store.end ());
+				for (; i != n && accounts.size () < count; ++i)
 				{
-					if (info.modified >= modified_since)
+					rai::account account (i->first.uint256 ());
+					rai::account_info info;
+					if (!node.store.account_get (transaction, account, info))
 					{
-						boost::property_tree::ptree entry;
-						entry.put ("frontier", info.head.to_string ());
-						entry.put ("open_block", info.open_block.to_string ());
-						entry.put ("representative_block", info.rep_block.to_string ());
-						std::string balance;
-						rai::uint128_union (info.balance).encode_dec (balance);
-						entry.put ("balance", balance);
-						entry.put ("modified_timestamp", std::to_string (info.modified));
-						entry.put ("block_count", std::to_string (info.block_count));
-						if (representative)
+						if (info.modified >= modified_since)
 						{
-							auto block (node.store.block_get (transaction, info.rep_block));
-							assert (block != nullptr);
-							entry.put ("representative", block->representative ().to_account ());
-						}
-						if (weight)
-						{
-							auto account_weight (node.ledger.weight (transaction, account));
-							entry.put ("weight", account_weight.convert_to<std::string> ());
-						}
-						if (pending)
-						{
-							auto account_pending (node.ledger.account_pending (transaction, account));
-							entry.put ("pending", account_pending.convert_to<std::string> ());
+							boost::property_tree::ptree entry;
+							entry.put ("frontier", info.head.to_string ());
+							entry.put ("open_block", info.open_block.to_string ());
+							entry.put ("representative_block", info.rep_block.to_string ());
+							std::string balance;
+							rai::uint128_union (info.balance).encode_dec (balance);
+							entry.put ("balance", balance);
+							entry.put ("modified_timestamp", std::to_string (info.modified));
+							entry.put ("block_count", std::to_string (info.block_count));
+							if (representative)
+							{
+								auto block (node.store.block_get (transaction, info.rep_block));
+								assert (block != nullptr);
+								entry.put ("representative", block->representative ().to_account ());
+							}
+							if (weight)
+							{
+								auto account_weight (node.ledger.weight (transaction, account));
+								entry.put ("weight", account_weight.convert_to<std::string> ());
+							}
+							if (pending)
+							{
+								auto account_pending (node.ledger.account_pending (transaction, account));
+								entry.put ("pending", account_pending.convert_to<std::string> ());
+							}
+							accounts.push_back (std::make_pair (account.to_account (), entry));
 						}
-						accounts.push_back (std::make_pair (account.to_account (), entry));
 					}
 				}
+				response_l.add_child ("accounts", accounts);
+				if (i != n)
+				{
+					response_l.put ("cursor", cursor_encode (i->first.uint256 ()));
+				}
+				response (response_l);
+			}
+			else
+			{
+				error_response (response, "Wallet not found");
 			}
-			response_l.add_child ("accounts", accounts);
-			response (response_l);
 		}
 		else
 		{
-			error_response (response, "Wallet not found");
+			error_response (response, "Bad wallet number");
 		}
 	}
-	else
-	{
-		error_response (response, "Bad wallet number");
-	}
 }
 
 void rai::rpc_handler::wallet_lock ()
@@ -3952,21 +4255,21 @@ void rai::rpc_handler::wallet_pending ()
 			{
 				rai::account account (i->first.uint256 ());
 				boost::property_tree::ptree peers_l;
-				rai::account end (account.number () + 1);
-				for (auto ii (node.store.pending_begin (transaction, rai::pending_key (account, 0))), nn (node.store.pending_begin (transaction, rai::pending_key (end, 0))); ii != nn && peers_l.size () < count; ++ii)
+				auto totals (node.store.pending_totals_get (transaction, account));
+				if (totals.count != 0 && totals.sum.number () >= threshold.number ())
 				{
-					rai::pending_key key (ii->first);
-					if (threshold.is_zero () && !source)
-					{
-						boost::property_tree::ptree entry;
-						entry.put ("", key.hash.to_string ());
-						peers_l.push_back (std::make_pair ("", entry));
-					}
-					else
+					for (rai::pending_iterator ii (transaction, node.store, account, threshold.number ()); !ii.done () && peers_l.size () < count; ++ii)
 					{
-						rai::pending_info info (ii->second);
-						if (info.amount.number () >= threshold.number ())
+						auto key (ii.key ());
+						if (threshold.is_zero () && !source)
+						{
+							boost::property_tree::ptree entry;
+							entry.put ("", key.hash.to_string ());
+							peers_l.push_back (std::make_pair ("", entry));
+						}
+						else
 						{
+							auto info (ii.info ());
 							if (source)
 							{
 								boost::property_tree::ptree pending_tree;
@@ -4623,6 +4926,10 @@ void rai::rpc_handler::process_request ()
 		{
 			accounts_balances ();
 		}
+		else if (action == "accounts_balance_range")
+		{
+			accounts_balance_range ();
+		}
 		else if (action == "accounts_create")
 		{
 			accounts_create ();
@@ -4635,6 +4942,10 @@ void rai::rpc_handler::process_request ()
 		{
 			accounts_pending ();
 		}
+		else if (action == "accounts_top")
+		{
+			accounts_top ();
+		}
 		else if (action == "available_supply")
 		{
 			available_supply ();
@@ -4687,6 +4998,14 @@ void rai::rpc_handler::process_request ()
 		{
 			bootstrap_any ();
 		}
+		else if (action == "bootstrap_lazy")
+		{
+			bootstrap_lazy ();
+		}
+		else if (action == "bootstrap_status")
+		{
+			bootstrap_status ();
+		}
 		else if (action == "chain")
 		{
 			chain ();
@@ -129,7 +129,10 @@ public:
 	void account_representative_set ();
 	void account_weight ();
 	void accounts_balances ();
+	void accounts_balance_range ();
+	void accounts_by_balance (rai::uint128_t const &, rai::uint128_t const &);
 	void accounts_create ();
+	void accounts_top ();
 	void accounts_frontiers ();
 	void accounts_pending ();
 	void available_supply ();
@@ -144,6 +147,8 @@ public:
 	void block_hash ();
 	void bootstrap ();
 	void bootstrap_any ();
+	void bootstrap_lazy ();
+	void bootstrap_status ();
 	void chain ();
 	void confirmation_history ();
 	void delegators ();
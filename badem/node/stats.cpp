@@ -78,6 +78,17 @@ public:
 		entries.push_back (std::make_pair ("", entry));
 	}
 
+	void write_bin (std::string type, std::string detail, std::string dir, uint64_t bound, uint64_t count) override
+	{
+		boost::property_tree::ptree entry;
+		entry.put ("type", type);
+		entry.put ("detail", detail);
+		entry.put ("dir", dir);
+		entry.put ("bound", bound);
+		entry.put ("count", count);
+		entries.push_back (std::make_pair ("", entry));
+	}
+
 	void finalize () override
 	{
 		tree.add_child ("entries", entries);
@@ -131,6 +142,11 @@ public:
 		log << boost::format ("%02d:%02d:%02d") % tm.tm_hour % tm.tm_min % tm.tm_sec << "," << type << "," << detail << "," << dir << "," << value << std::endl;
 	}
 
+	void write_bin (std::string type, std::string detail, std::string dir, uint64_t bound, uint64_t count) override
+	{
+		log << type << "," << detail << "," << dir << "," << bound << "," << count << std::endl;
+	}
+
 	void rotate () override
 	{
 		log.close ();
@@ -216,6 +232,29 @@ void rai::stat::log_counters_impl (stat_log_sink & sink)
 	sink.finalize ();
 }
 
+void rai::stat::log_histograms (stat_log_sink & sink)
+{
+	std::unique_lock<std::mutex> lock (stat_mutex);
+	sink.begin ();
+	if (config.log_headers)
+	{
+		auto walltime (std::chrono::system_clock::now ());
+		sink.write_header ("histograms", walltime);
+	}
+	for (auto & it : histograms)
+	{
+		auto key = it.first;
+		std::string type = type_to_string (key);
+		std::string detail = detail_to_string (key);
+		std::string dir = dir_to_string (key);
+		for (size_t i (0); i < it.second.bounds.size (); ++i)
+		{
+			sink.write_bin (type, detail, dir, it.second.bounds[i], it.second.counts[i]);
+		}
+	}
+	sink.finalize ();
+}
+
 void rai::stat::log_samples (stat_log_sink & sink)
 {
 	std::unique_lock<std::mutex> lock (stat_mutex);
@@ -341,6 +380,15 @@ std::string rai::stat::type_to_string (uint32_t key)
 		case rai::stat::type::message:
 			res = "message";
 			break;
+		case rai::stat::type::http_callback:
+			res = "http_callback";
+			break;
+		case rai::stat::type::unchecked:
+			res = "unchecked";
+			break;
+		case rai::stat::type::block_processor:
+			res = "block_processor";
+			break;
 	}
 	return res;
 }
@@ -378,12 +426,55 @@ std::string rai::stat::detail_to_string (uint32_t key)
 		case rai::stat::detail::frontier_req:
 			res = "frontier_req";
 			break;
+		case rai::stat::detail::frontiers_sent:
+			res = "frontiers_sent";
+			break;
+		case rai::stat::detail::frontier_rate:
+			res = "frontier_rate";
+			break;
+		case rai::stat::detail::block_rate:
+			res = "block_rate";
+			break;
+		case rai::stat::detail::pull_failed:
+			res = "pull_failed";
+			break;
 		case rai::stat::detail::handshake:
 			res = "handshake";
 			break;
+		case rai::stat::detail::hash_cached:
+			res = "hash_cached";
+			break;
+		case rai::stat::detail::gap_previous:
+			res = "gap_previous";
+			break;
+		case rai::stat::detail::gap_source:
+			res = "gap_source";
+			break;
+		case rai::stat::detail::evict:
+			res = "evict";
+			break;
+		case rai::stat::detail::batch_size:
+			res = "batch_size";
+			break;
+		case rai::stat::detail::lock_wait:
+			res = "lock_wait";
+			break;
+		case rai::stat::detail::commit:
+			res = "commit";
+			break;
+		case rai::stat::detail::drop_local:
+			res = "drop_local";
+			break;
+		case rai::stat::detail::drop_live:
+			res = "drop_live";
+			break;
+
 		case rai::stat::detail::initiate:
 			res = "initiate";
 			break;
+		case rai::stat::detail::initiate_lazy:
+			res = "initiate_lazy";
+			break;
 		case rai::stat::detail::insufficient_work:
 			res = "insufficient_work";
 			break;
@@ -417,6 +508,21 @@ std::string rai::stat::detail_to_string (uint32_t key)
 		case rai::stat::detail::vote_invalid:
 			res = "vote_invalid";
 			break;
+		case rai::stat::detail::delivered:
+			res = "delivered";
+			break;
+		case rai::stat::detail::latency_ms:
+			res = "latency_ms";
+			break;
+		case rai::stat::detail::retry:
+			res = "retry";
+			break;
+		case rai::stat::detail::overflow:
+			res = "overflow";
+			break;
+		case rai::stat::detail::failed:
+			res = "failed";
+			break;
 	}
 	return res;
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <boost/circular_buffer.hpp>
 #include <boost/property_tree/ptree.hpp>
@@ -10,6 +11,7 @@
 #include <badem/lib/utility.hpp>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace rai
 {
@@ -105,6 +107,30 @@ public:
 	rai::observer_set<uint64_t, uint64_t> count_observers;
 };
 
+/** Counts of values falling in to fixed bins, each bin holding values up to its bound and a final bin holding everything larger */
+class stat_histogram
+{
+public:
+	/** Bounds must be in ascending order */
+	stat_histogram (std::initializer_list<uint64_t> bounds_a) :
+	bounds (bounds_a), counts (bounds_a.size () + 1, 0)
+	{
+		bounds.push_back (std::numeric_limits<uint64_t>::max ());
+	}
+
+	inline void add (uint64_t value)
+	{
+		auto bin (std::lower_bound (bounds.begin (), bounds.end (), value) - bounds.begin ());
+		++counts[bin];
+	}
+
+	/** Upper bound of each bin, the last one being the largest uint64_t */
+	std::vector<uint64_t> bounds;
+
+	/** Number of values added to each bin */
+	std::vector<uint64_t> counts;
+};
+
 /** Log sink interface */
 class stat_log_sink
 {
@@ -134,6 +160,11 @@ public:
 	{
 	}
 
+	/** Write one histogram bin to the log */
+	virtual void write_bin (std::string type, std::string detail, std::string dir, uint64_t bound, uint64_t count)
+	{
+	}
+
 	/** Rotates the log (e.g. empty file). This is a no-op for sinks where rotation is not supported. */
 	virtual void rotate ()
 	{
@@ -184,7 +215,10 @@ public:
 		rollback,
 		bootstrap,
 		vote,
-		peering
+		peering,
+		http_callback,
+		unchecked,
+		block_processor
 	};
 
 	/** Optional detail type */
@@ -202,6 +236,7 @@ public:
 		open,
 		change,
 		state_block,
+		hash_cached,
 
 		// message specific
 		keepalive,
@@ -212,10 +247,15 @@ public:
 
 		// bootstrap specific
 		initiate,
+		initiate_lazy,
 		bulk_pull,
 		bulk_push,
 		bulk_pull_blocks,
 		frontier_req,
+		frontiers_sent,
+		frontier_rate,
+		block_rate,
+		pull_failed,
 
 		// vote specific
 		vote_valid,
@@ -224,6 +264,25 @@ public:
 
 		// peering
 		handshake,
+
+		// http callback
+		delivered,
+		latency_ms,
+		retry,
+		overflow,
+		failed,
+
+		// unchecked
+		gap_previous,
+		gap_source,
+		evict,
+
+		// block processor
+		batch_size,
+		lock_wait,
+		commit,
+		drop_local,
+		drop_live
 	};
 
 	/** Direction of the stat. If the direction is irrelevant, use in */
@@ -354,9 +413,42 @@ public:
 		return get_entry (key_of (type, detail, dir))->counter.value;
 	}
 
+	/**
+	 * Defines the bins of a histogram for the given type, detail and direction combination.
+	 * This must be called before values are added, values added to a histogram that isn't defined are dropped.
+	 */
+	inline void define_histogram (stat::type type, stat::detail detail, stat::dir dir, std::initializer_list<uint64_t> bounds)
+	{
+		std::unique_lock<std::mutex> lock (stat_mutex);
+		histograms.erase (key_of (type, detail, dir));
+		histograms.emplace (key_of (type, detail, dir), rai::stat_histogram (bounds));
+	}
+
+	/** Adds \p value to the histogram it falls in to */
+	inline void update_histogram (stat::type type, stat::detail detail, stat::dir dir, uint64_t value)
+	{
+		std::unique_lock<std::mutex> lock (stat_mutex);
+		auto existing (histograms.find (key_of (type, detail, dir)));
+		if (existing != histograms.end ())
+		{
+			existing->second.add (value);
+		}
+	}
+
+	/** Returns a copy of the histogram, or a histogram with a single empty bin if it isn't defined */
+	inline rai::stat_histogram histogram (stat::type type, stat::detail detail, stat::dir dir)
+	{
+		std::unique_lock<std::mutex> lock (stat_mutex);
+		auto existing (histograms.find (key_of (type, detail, dir)));
+		return existing != histograms.end () ? existing->second : rai::stat_histogram ({});
+	}
+
 	/** Log counters to the given log link */
 	void log_counters (stat_log_sink & sink);
 
+	/** Log every histogram bin to the given log sink */
+	void log_histograms (stat_log_sink & sink);
+
 	/** Log samples to the given log sink */
 	void log_samples (stat_log_sink & sink);
 
@@ -404,6 +496,9 @@ private:
 
 	/** Stat entries are sorted by key to simplify processing of log output */
 	std::map<uint32_t, std::shared_ptr<rai::stat_entry>> entries;
+
+	/** Histograms by the same key as entries */
+	std::map<uint32_t, rai::stat_histogram> histograms;
 	std::chrono::steady_clock::time_point log_last_count_writeout{ std::chrono::steady_clock::now () };
 	std::chrono::steady_clock::time_point log_last_sample_writeout{ std::chrono::steady_clock::now () };
 
@@ -4,6 +4,31 @@
 #include <badem/node/common.hpp>
 #include <badem/node/testing.hpp>
 
+#include <deque>
+#include <random>
+
+namespace
+{
+std::array<uint8_t, 8> const benchmark_magic = { { 'b', 'a', 'd', 'e', 'm', 'b', 'n', 'c' } };
+
+class benchmark_account
+{
+public:
+	benchmark_account (std::shared_ptr<rai::keypair> key_a) :
+	key (key_a),
+	head (0),
+	balance (0),
+	state (false)
+	{
+	}
+	std::shared_ptr<rai::keypair> key;
+	rai::block_hash head;
+	rai::uint128_t balance;
+	bool state;
+	std::deque<std::pair<rai::block_hash, rai::uint128_t>> pending;
+};
+}
+
 rai::system::system (uint16_t port_a, size_t count_a) :
 alarm (service),
 work (1, nullptr)
@@ -494,3 +519,158 @@ void rai::landing::distribute_ongoing ()
 
 std::chrono::seconds constexpr rai::landing::distribution_interval;
 std::chrono::seconds constexpr rai::landing::sleep_seconds;
+
+rai::benchmark_ledger::benchmark_ledger (uint64_t seed_a, size_t accounts_a, size_t length_a, unsigned receive_percent_a, unsigned state_percent_a) :
+seed (seed_a),
+accounts (accounts_a),
+length (length_a),
+receive_percent (receive_percent_a),
+state_percent (state_percent_a)
+{
+}
+
+bool rai::benchmark_ledger::generate (rai::work_pool & work_a)
+{
+	// Funding comes from the genesis account, whose key is only known on the test network
+	// Chains grow by sending between generated accounts so extending them needs at least two
+	auto result (rai::badem_network != rai::badem_networks::badem_test_network || accounts == 0 || (accounts < 2 && length > 0));
+	if (!result)
+	{
+		blocks.clear ();
+		std::mt19937_64 random (seed);
+		rai::uint256_union seed_l (seed);
+		std::vector<benchmark_account> chains;
+		chains.push_back (benchmark_account (std::make_shared<rai::keypair> (rai::test_genesis_key.prv.data.to_string ())));
+		chains[0].head = rai::genesis ().hash ();
+		chains[0].balance = rai::genesis_amount;
+		for (size_t i (0); i < accounts; ++i)
+		{
+			rai::uint256_union prv;
+			rai::deterministic_key (seed_l, i, prv);
+			chains.push_back (benchmark_account (std::make_shared<rai::keypair> (prv.to_string ())));
+			chains.back ().state = random () % 100 < state_percent;
+		}
+		auto send ([this, &work_a, &chains](benchmark_account & source_a, size_t destination_a, rai::uint128_t const & amount_a) {
+			auto & destination (chains[destination_a]);
+			assert (source_a.balance >= amount_a);
+			std::shared_ptr<rai::block> block;
+			if (source_a.state)
+			{
+				block = std::make_shared<rai::state_block> (source_a.key->pub, source_a.head, source_a.key->pub, source_a.balance - amount_a, destination.key->pub, source_a.key->prv, source_a.key->pub, work_a.generate (source_a.head));
+			}
+			else
+			{
+				block = std::make_shared<rai::send_block> (source_a.head, destination.key->pub, source_a.balance - amount_a, source_a.key->prv, source_a.key->pub, work_a.generate (source_a.head));
+			}
+			source_a.head = block->hash ();
+			source_a.balance -= amount_a;
+			destination.pending.push_back (std::make_pair (source_a.head, amount_a));
+			blocks.push_back (block);
+		});
+		auto receive ([this, &work_a](benchmark_account & account_a) {
+			assert (!account_a.pending.empty ());
+			auto source (account_a.pending.front ());
+			account_a.pending.pop_front ();
+			// Open and state blocks take the account as their root
+			rai::block_hash root (account_a.head.is_zero () ? rai::block_hash (account_a.key->pub) : account_a.head);
+			std::shared_ptr<rai::block> block;
+			if (account_a.state)
+			{
+				block = std::make_shared<rai::state_block> (account_a.key->pub, account_a.head, account_a.key->pub, account_a.balance + source.second, source.first, account_a.key->prv, account_a.key->pub, work_a.generate (root));
+			}
+			else if (account_a.head.is_zero ())
+			{
+				block = std::make_shared<rai::open_block> (source.first, account_a.key->pub, account_a.key->pub, account_a.key->prv, account_a.key->pub, work_a.generate (root));
+			}
+			else
+			{
+				block = std::make_shared<rai::receive_block> (account_a.head, source.first, account_a.key->prv, account_a.key->pub, work_a.generate (root));
+			}
+			account_a.head = block->hash ();
+			account_a.balance += source.second;
+			blocks.push_back (block);
+		});
+		rai::uint128_t funding (rai::kBDM_ratio * 1000);
+		for (size_t i (1); i < chains.size (); ++i)
+		{
+			send (chains[0], i, funding);
+		}
+		for (size_t i (1); i < chains.size (); ++i)
+		{
+			receive (chains[i]);
+		}
+		auto target (blocks.size () + accounts * length);
+		while (blocks.size () < target)
+		{
+			auto & account (chains[1 + random () % accounts]);
+			if (!account.pending.empty () && (account.balance.is_zero () || random () % 100 < receive_percent))
+			{
+				receive (account);
+			}
+			else if (!account.balance.is_zero () && accounts > 1)
+			{
+				auto destination (1 + random () % accounts);
+				if (&chains[destination] == &account)
+				{
+					destination = 1 + destination % accounts;
+				}
+				rai::uint128_t amount (1 + random () % 1000);
+				send (account, destination, std::min (amount, account.balance));
+			}
+		}
+	}
+	return result;
+}
+
+void rai::benchmark_ledger::serialize (std::ostream & stream_a) const
+{
+	std::vector<uint8_t> buffer;
+	{
+		rai::vectorstream stream (buffer);
+		rai::write (stream, benchmark_magic);
+		rai::write (stream, version);
+		rai::write (stream, static_cast<uint8_t> (rai::badem_network));
+		rai::write (stream, seed);
+		rai::write (stream, static_cast<uint64_t> (accounts));
+		rai::write (stream, static_cast<uint64_t> (length));
+		rai::write (stream, receive_percent);
+		rai::write (stream, state_percent);
+		rai::write (stream, static_cast<uint64_t> (blocks.size ()));
+		for (auto & i : blocks)
+		{
+			rai::serialize_block (stream, *i);
+		}
+	}
+	stream_a.write (reinterpret_cast<char const *> (buffer.data ()), buffer.size ());
+}
+
+bool rai::benchmark_ledger::deserialize (std::istream & stream_a)
+{
+	std::vector<uint8_t> buffer ((std::istreambuf_iterator<char> (stream_a)), std::istreambuf_iterator<char> ());
+	rai::bufferstream stream (buffer.data (), buffer.size ());
+	std::array<uint8_t, 8> magic;
+	uint32_t version_l;
+	uint8_t network;
+	uint64_t accounts_l;
+	uint64_t length_l;
+	uint64_t count;
+	auto result (rai::read (stream, magic) || magic != benchmark_magic || rai::read (stream, version_l) || version_l != version || rai::read (stream, network) || network != static_cast<uint8_t> (rai::badem_network));
+	result = result || rai::read (stream, seed) || rai::read (stream, accounts_l) || rai::read (stream, length_l) || rai::read (stream, receive_percent) || rai::read (stream, state_percent) || rai::read (stream, count);
+	if (!result)
+	{
+		accounts = accounts_l;
+		length = length_l;
+		blocks.clear ();
+		blocks.reserve (count);
+		for (uint64_t i (0); i < count && !result; ++i)
+		{
+			std::shared_ptr<rai::block> block (rai::deserialize_block (stream));
+			result = block == nullptr;
+			if (!result)
+			{
+				blocks.push_back (block);
+			}
+		}
+	}
+	return result;
+}
@@ -31,6 +31,29 @@ public:
 	rai::logging logging;
 	rai::work_pool work;
 };
+/**
+ * Synthetic ledger for benchmarking ledger writes on the test network.
+ * Keys and every choice are derived from the seed so the same parameters always produce the same blocks, in an order the ledger accepts.
+ * Genesis funds each account, each account opens and then sends to or receives from the others until it holds about length blocks.
+ */
+class benchmark_ledger
+{
+public:
+	benchmark_ledger (uint64_t = 0, size_t = 0, size_t = 0, unsigned = 50, unsigned = 50);
+	bool generate (rai::work_pool &);
+	void serialize (std::ostream &) const;
+	bool deserialize (std::istream &);
+	static uint32_t const version = 1;
+	uint64_t seed;
+	size_t accounts;
+	// Blocks created per account after its open block, on average
+	size_t length;
+	// Percent chance an account with something pending receives instead of sending
+	unsigned receive_percent;
+	// Percent of accounts using state blocks, the rest use legacy blocks
+	unsigned state_percent;
+	std::vector<std::shared_ptr<rai::block>> blocks;
+};
 class landing_store
 {
 public:
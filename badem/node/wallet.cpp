@@ -900,8 +900,8 @@ std::shared_ptr<rai::block> rai::wallet::receive_action (rai::block const & send
 		{
 			node.work_generate_blocking (*block);
 		}
-		node.process_active (block);
-		node.block_processor.flush ();
+		node.process_active (block, rai::block_origin::local);
+		node.block_processor.flush_local ();
 		if (generate_work_a)
 		{
 			work_ensure (account, block->hash ());
@@ -938,8 +938,8 @@ std::shared_ptr<rai::block> rai::wallet::change_action (rai::account const & sou
 		{
 			node.work_generate_blocking (*block);
 		}
-		node.process_active (block);
-		node.block_processor.flush ();
+		node.process_active (block, rai::block_origin::local);
+		node.block_processor.flush_local ();
 		if (generate_work_a)
 		{
 			work_ensure (source_a, block->hash ());
@@ -1020,8 +1020,8 @@ std::shared_ptr<rai::block> rai::wallet::send_action (rai::account const & sourc
 		{
 			node.work_generate_blocking (*block);
 		}
-		node.process_active (block);
-		node.block_processor.flush ();
+		node.process_active (block, rai::block_origin::local);
+		node.block_processor.flush_local ();
 		if (generate_work_a)
 		{
 			work_ensure (source_a, block->hash ());
@@ -1120,24 +1120,18 @@ bool rai::wallet::search_pending ()
 		for (auto i (store.begin (transaction)), n (store.end ()); i != n; ++i)
 		{
 			rai::account account (i->first.uint256 ());
-			// Don't search pending for watch-only accounts
-			if (!rai::wallet_value (i->second).key.is_zero ())
+			// Don't search pending for watch-only accounts or accounts with nothing worth receiving
+			if (!rai::wallet_value (i->second).key.is_zero () && node.store.pending_totals_get (transaction, account).sum.number () >= node.config.receive_minimum.number ())
 			{
-				for (auto j (node.store.pending_begin (transaction, rai::pending_key (account, 0))), m (node.store.pending_begin (transaction, rai::pending_key (account.number () + 1, 0))); j != m; ++j)
+				for (rai::pending_iterator j (transaction, node.store, account, node.config.receive_minimum.number ()); !j.done (); ++j)
 				{
-					rai::pending_key key (j->first);
-					auto hash (key.hash);
-					rai::pending_info pending (j->second);
-					auto amount (pending.amount.number ());
-					if (node.config.receive_minimum.number () <= amount)
-					{
-						BOOST_LOG (node.log) << boost::str (boost::format ("Found a pending block %1% for account %2%") % hash.to_string () % pending.source.to_account ());
-						auto this_l (shared_from_this ());
-						rai::account_info info;
-						auto error (node.store.account_get (transaction, pending.source, info));
-						assert (!error);
-						node.block_confirm (node.store.block_get (transaction, info.head));
-					}
+					auto hash (j.key ().hash);
+					auto pending (j.info ());
+					BOOST_LOG (node.log) << boost::str (boost::format ("Found a pending block %1% for account %2%") % hash.to_string () % pending.source.to_account ());
+					rai::account_info info;
+					auto error (node.store.account_get (transaction, pending.source, info));
+					assert (!error);
+					node.block_confirm (node.store.block_get (transaction, info.head));
 				}
 			}
 		}
@@ -371,6 +371,79 @@ TEST (peer_container, random_set)
 	auto new_ms (std::chrono::duration_cast<std::chrono::milliseconds> (end - current));
 }
 
+// Pooled allocate_shared against make_shared, with every thread allocating and releasing at once
+TEST (object_pool, contention)
+{
+	using object = std::array<uint8_t, 256>;
+	auto threads_count (std::max (2u, std::thread::hardware_concurrency ()));
+	auto run ([threads_count](std::function<std::shared_ptr<object> ()> const & make_a) {
+		std::vector<std::thread> threads;
+		auto begin (std::chrono::steady_clock::now ());
+		for (auto i (0u); i < threads_count; ++i)
+		{
+			threads.push_back (std::thread ([&make_a]() {
+				// Keep some objects alive so releases interleave with allocations
+				std::vector<std::shared_ptr<object>> live (128);
+				for (auto j (0); j < 1000000; ++j)
+				{
+					live[j % live.size ()] = make_a ();
+				}
+			}));
+		}
+		for (auto & i : threads)
+		{
+			i.join ();
+		}
+		return std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::steady_clock::now () - begin);
+	});
+	auto heap_ms (run ([]() { return std::make_shared<object> (); }));
+	auto reused (rai::pool_counters::reused.load ());
+	auto pool_ms (run ([]() { return std::allocate_shared<object> (rai::pool_allocator<object> ()); }));
+	ASSERT_LT (reused, rai::pool_counters::reused.load ());
+	std::cerr << threads_count << " threads, make_shared: " << heap_ms.count () << "ms pooled: " << pool_ms.count () << "ms" << std::endl;
+}
+
+TEST (votes, tally_1000_reps)
+{
+	rai::system system (24000, 1);
+	auto & node (*system.nodes[0]);
+	rai::genesis genesis;
+	rai::keypair key1;
+	auto send1 (std::make_shared<rai::send_block> (genesis.hash (), key1.pub, 0, rai::test_genesis_key.prv, rai::test_genesis_key.pub, 0));
+	auto send2 (std::make_shared<rai::send_block> (genesis.hash (), key1.pub, 1, rai::test_genesis_key.prv, rai::test_genesis_key.pub, 0));
+	std::vector<std::pair<std::shared_ptr<rai::vote>, rai::uint128_t>> votes_l;
+	{
+		rai::transaction transaction (node.store.environment, nullptr, true);
+		for (auto i (0); i < 1000; ++i)
+		{
+			rai::keypair key;
+			rai::uint128_t weight (1000 + i);
+			node.store.representation_put (transaction, key.pub, weight);
+			votes_l.push_back (std::make_pair (std::make_shared<rai::vote> (key.pub, key.prv, 1, i % 2 ? send1 : send2), weight));
+		}
+	}
+	rai::transaction transaction (node.store.environment, nullptr, false);
+	rai::votes recount (send1);
+	rai::votes incremental (send1);
+	auto old (std::chrono::steady_clock::now ());
+	for (auto & i : votes_l)
+	{
+		recount.vote (i.first, i.second);
+		auto tally (node.ledger.tally (transaction, recount));
+	}
+	auto current (std::chrono::steady_clock::now ());
+	for (auto & i : votes_l)
+	{
+		incremental.vote (i.first, i.second);
+		auto tally (incremental.tally ());
+	}
+	auto end (std::chrono::steady_clock::now ());
+	ASSERT_EQ (node.ledger.tally (transaction, recount), incremental.tally ());
+	auto old_us (std::chrono::duration_cast<std::chrono::microseconds> (current - old));
+	auto new_us (std::chrono::duration_cast<std::chrono::microseconds> (end - current));
+	std::cerr << "Per vote, recount: " << old_us.count () / votes_l.size () << "us incremental: " << new_us.count () / votes_l.size () << "us" << std::endl;
+}
+
 TEST (store, unchecked_load)
 {
 	rai::system system (24000, 1);
@@ -0,0 +1,559 @@
+#include <badem/blockstore.hpp>
+#include <badem/ledger.hpp>
+#include <badem/ledger_validator.hpp>
+#include <badem/lib/work.hpp>
+#include <badem/snapshot.hpp>
+
+#include <boost/endian/conversion.hpp>
+
+#include <atomic>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <thread>
+
+namespace
+{
+std::array<uint8_t, 8> const snapshot_magic = { { 'b', 'a', 'd', 'e', 'm', 's', 'n', 'p' } };
+
+rai::uint256_union payload_hash (std::vector<uint8_t> const & payload_a)
+{
+	rai::uint256_union result;
+	blake2b_state hash;
+	auto status (blake2b_init (&hash, sizeof (result.bytes)));
+	assert (status == 0);
+	status = blake2b_update (&hash, payload_a.data (), payload_a.size ());
+	assert (status == 0);
+	status = blake2b_final (&hash, result.bytes.data (), sizeof (result.bytes));
+	assert (status == 0);
+	return result;
+}
+
+bool at_end (rai::stream & stream_a)
+{
+	return stream_a.sgetc () == rai::stream::traits_type::eof ();
+}
+}
+
+rai::snapshot::snapshot (rai::ledger & ledger_a, unsigned threads_a) :
+ledger (ledger_a),
+threads (threads_a != 0 ? threads_a : std::max (1u, std::thread::hardware_concurrency ())),
+accounts (0),
+blocks (0),
+pending (0),
+chunk_size (chunk_size_default),
+checksum (0),
+chain_account (0),
+chain_remaining (0),
+chain_expected (0),
+chain_successor (0),
+chain_representative (0),
+chain_representative_found (false)
+{
+}
+
+/**
+ * Stream the ledger out, each account is followed by its whole chain so an import can check chains as they arrive.
+ * Chunks are cut between blocks so a chain of any length fits.
+ */
+bool rai::snapshot::write (MDB_txn * transaction_a, std::ostream & stream_a)
+{
+	auto & store (ledger.store);
+	accounts = 0;
+	blocks = 0;
+	pending = 0;
+	std::vector<uint8_t> header;
+	{
+		rai::vectorstream stream (header);
+		rai::write (stream, snapshot_magic);
+		rai::write (stream, boost::endian::native_to_big (version));
+		rai::write (stream, static_cast<uint8_t> (rai::badem_network));
+		rai::write (stream, rai::genesis ().hash ().bytes);
+	}
+	stream_a.write (reinterpret_cast<char const *> (header.data ()), header.size ());
+	auto error (false);
+	// The stored checksum is reset whenever the store is opened, the snapshot carries one derived from the heads it contains
+	checksum.clear ();
+	std::vector<uint8_t> payload;
+	for (auto i (store.latest_begin (transaction_a)), n (store.latest_end ()); i != n && !error; ++i)
+	{
+		rai::account account (i->first.uint256 ());
+		rai::account_info info (i->second);
+		{
+			rai::vectorstream stream (payload);
+			rai::write (stream, account.bytes);
+			info.serialize (stream);
+		}
+		auto hash (info.head);
+		for (uint64_t count (0); count < info.block_count && !error; ++count)
+		{
+			auto block (store.block_get (transaction_a, hash));
+			error = block == nullptr;
+			if (!error)
+			{
+				{
+					rai::vectorstream stream (payload);
+					rai::serialize_block (stream, *block);
+				}
+				hash = block->previous ();
+				if (payload.size () >= chunk_size)
+				{
+					error = write_chunk (stream_a, rai::snapshot_chunk::accounts, payload);
+					payload.clear ();
+				}
+			}
+		}
+		++accounts;
+		blocks += info.block_count;
+		checksum ^= info.head;
+	}
+	if (!payload.empty () && !error)
+	{
+		error = write_chunk (stream_a, rai::snapshot_chunk::accounts, payload);
+		payload.clear ();
+	}
+	for (auto i (store.pending_begin (transaction_a)), n (store.pending_end ()); i != n && !error; ++i)
+	{
+		{
+			rai::vectorstream stream (payload);
+			rai::pending_key (i->first).serialize (stream);
+			rai::pending_info (i->second).serialize (stream);
+		}
+		++pending;
+		if (payload.size () >= chunk_size)
+		{
+			error = write_chunk (stream_a, rai::snapshot_chunk::pending, payload);
+			payload.clear ();
+		}
+	}
+	if (!payload.empty () && !error)
+	{
+		error = write_chunk (stream_a, rai::snapshot_chunk::pending, payload);
+		payload.clear ();
+	}
+	for (auto i (store.block_info_begin (transaction_a)), n (store.block_info_end ()); i != n && !error; ++i)
+	{
+		{
+			rai::vectorstream stream (payload);
+			rai::write (stream, i->first.uint256 ().bytes);
+			rai::block_info (i->second).serialize (stream);
+		}
+		if (payload.size () >= chunk_size)
+		{
+			error = write_chunk (stream_a, rai::snapshot_chunk::blocks_info, payload);
+			payload.clear ();
+		}
+	}
+	if (!payload.empty () && !error)
+	{
+		error = write_chunk (stream_a, rai::snapshot_chunk::blocks_info, payload);
+		payload.clear ();
+	}
+	if (!error)
+	{
+		{
+			rai::vectorstream stream (payload);
+			rai::write (stream, boost::endian::native_to_big (accounts));
+			rai::write (stream, boost::endian::native_to_big (blocks));
+			rai::write (stream, boost::endian::native_to_big (pending));
+			rai::write (stream, checksum.bytes);
+		}
+		error = write_chunk (stream_a, rai::snapshot_chunk::end, payload);
+	}
+	stream_a.flush ();
+	return error || stream_a.fail ();
+}
+
+/**
+ * Load a snapshot in to a ledger holding nothing but genesis.
+ * The whole file is verified before the first write so a damaged or foreign snapshot leaves the ledger untouched. The tables are then
+ * written in a nested transaction and only committed if they agree with the blocks.
+ */
+bool rai::snapshot::read (MDB_txn * transaction_a, std::istream & stream_a)
+{
+	auto & store (ledger.store);
+	auto error (store.block_count (transaction_a).sum () > 1);
+	if (!error)
+	{
+		auto start (stream_a.tellg ());
+		error = process (nullptr, stream_a);
+		if (!error)
+		{
+			stream_a.clear ();
+			stream_a.seekg (start);
+			MDB_txn * import;
+			error = mdb_txn_begin (store.environment, transaction_a, 0, &import) != 0;
+			if (!error)
+			{
+				error = process (import, stream_a) || check (import);
+				if (!error)
+				{
+					error = mdb_txn_commit (import) != 0;
+				}
+				else
+				{
+					mdb_txn_abort (import);
+				}
+			}
+			if (error)
+			{
+				// Counters and the weight cache followed the writes that were just dropped
+				store.counters_load (transaction_a);
+				store.representation_load (transaction_a);
+			}
+		}
+	}
+	return error;
+}
+
+/**
+ * Walk the snapshot, verifying only when there's no transaction and writing the ledger tables when there is
+ */
+bool rai::snapshot::process (MDB_txn * transaction_a, std::istream & stream_a)
+{
+	accounts = 0;
+	blocks = 0;
+	pending = 0;
+	checksum.clear ();
+	weights.clear ();
+	chain_remaining = 0;
+	if (transaction_a != nullptr)
+	{
+		// Genesis weight is replaced along with everything else
+		for (auto i (ledger.store.representation_begin (transaction_a)), n (ledger.store.representation_end ()); i != n; ++i)
+		{
+			weights[i->first.uint256 ()] = 0;
+		}
+	}
+	std::array<uint8_t, sizeof (snapshot_magic) + sizeof (uint32_t) + sizeof (uint8_t) + sizeof (rai::block_hash)> header;
+	stream_a.read (reinterpret_cast<char *> (header.data ()), header.size ());
+	auto error (static_cast<size_t> (stream_a.gcount ()) != header.size ());
+	if (!error)
+	{
+		rai::bufferstream stream (header.data (), header.size ());
+		std::array<uint8_t, 8> magic;
+		uint32_t version_l;
+		uint8_t network;
+		rai::block_hash genesis_l;
+		error = rai::read (stream, magic) || rai::read (stream, version_l) || rai::read (stream, network) || rai::read (stream, genesis_l.bytes);
+		error = error || magic != snapshot_magic || boost::endian::big_to_native (version_l) != version || network != static_cast<uint8_t> (rai::badem_network) || genesis_l != rai::genesis ().hash ();
+	}
+	auto done (false);
+	while (!error && !done)
+	{
+		rai::snapshot_chunk type;
+		std::vector<uint8_t> payload;
+		error = read_chunk (stream_a, type, payload);
+		// Only an accounts chunk can carry on a chain left unfinished
+		error = error || (chain_remaining != 0 && type != rai::snapshot_chunk::accounts);
+		if (!error)
+		{
+			switch (type)
+			{
+				case rai::snapshot_chunk::accounts:
+					error = process_accounts (transaction_a, payload);
+					break;
+				case rai::snapshot_chunk::pending:
+					error = process_pending (transaction_a, payload);
+					break;
+				case rai::snapshot_chunk::blocks_info:
+					error = process_blocks_info (transaction_a, payload);
+					break;
+				case rai::snapshot_chunk::end:
+					error = process_end (transaction_a, payload);
+					done = true;
+					break;
+				default:
+					error = true;
+					break;
+			}
+		}
+	}
+	return error;
+}
+
+bool rai::snapshot::process_accounts (MDB_txn * transaction_a, std::vector<uint8_t> const & payload_a)
+{
+	rai::bufferstream stream (payload_a.data (), payload_a.size ());
+	std::vector<std::pair<rai::account, std::shared_ptr<rai::block>>> signed_blocks;
+	auto error (false);
+	while (!error && !at_end (stream))
+	{
+		if (chain_remaining == 0)
+		{
+			error = process_account (transaction_a, stream);
+		}
+		else
+		{
+			std::shared_ptr<rai::block> block (rai::deserialize_block (stream));
+			error = block == nullptr;
+			if (!error)
+			{
+				if (transaction_a == nullptr)
+				{
+					signed_blocks.push_back (std::make_pair (chain_account, block));
+				}
+				error = process_chain (transaction_a, block);
+			}
+		}
+	}
+	if (!error && transaction_a == nullptr)
+	{
+		error = verify (signed_blocks);
+	}
+	return error;
+}
+
+/**
+ * Start reading an account's chain, the blocks follow from head down to the open block
+ */
+bool rai::snapshot::process_account (MDB_txn * transaction_a, rai::stream & stream_a)
+{
+	auto & store (ledger.store);
+	auto error (rai::read (stream_a, chain_account.bytes) || chain_info.deserialize (stream_a) || chain_info.block_count == 0);
+	if (!error)
+	{
+		chain_remaining = chain_info.block_count;
+		chain_expected = chain_info.head;
+		chain_successor.clear ();
+		chain_representative.clear ();
+		chain_representative_found = false;
+		if (transaction_a != nullptr)
+		{
+			rai::account_info existing;
+			if (!store.account_get (transaction_a, chain_account, existing))
+			{
+				store.frontier_del (transaction_a, existing.head);
+				store.balance_del (transaction_a, chain_account, existing.balance.number ());
+			}
+			store.account_put (transaction_a, chain_account, chain_info);
+			store.balance_put (transaction_a, chain_account, chain_info.balance.number ());
+		}
+	}
+	return error;
+}
+
+/**
+ * Take the next block of the current chain, it's written straight away as its successor is already known
+ */
+bool rai::snapshot::process_chain (MDB_txn * transaction_a, std::shared_ptr<rai::block> block_a)
+{
+	auto & store (ledger.store);
+	auto hash (block_a->hash ());
+	auto error (hash != chain_expected);
+	switch (block_a->type ())
+	{
+		case rai::block_type::open:
+			error = error || static_cast<rai::open_block const &> (*block_a).hashables.account != chain_account;
+			break;
+		case rai::block_type::state:
+			error = error || static_cast<rai::state_block const &> (*block_a).hashables.account != chain_account;
+			break;
+		default:
+			break;
+	}
+	if (!error)
+	{
+		if (hash == chain_info.rep_block)
+		{
+			chain_representative = block_a->representative ();
+			chain_representative_found = true;
+		}
+		if (transaction_a != nullptr)
+		{
+			store.block_put (transaction_a, hash, *block_a, chain_successor);
+			if (chain_successor.is_zero () && block_a->type () != rai::block_type::state)
+			{
+				store.frontier_put (transaction_a, hash, chain_account);
+			}
+		}
+		++blocks;
+		chain_successor = hash;
+		chain_expected = block_a->previous ();
+		--chain_remaining;
+		if (chain_remaining == 0)
+		{
+			// The chain has to end at the account's open block and contain its representative block
+			error = !chain_expected.is_zero () || hash != chain_info.open_block || !chain_representative_found;
+			if (!error)
+			{
+				++accounts;
+				checksum ^= chain_info.head;
+				weights[chain_representative] += chain_info.balance.number ();
+			}
+		}
+	}
+	return error;
+}
+
+bool rai::snapshot::process_pending (MDB_txn * transaction_a, std::vector<uint8_t> const & payload_a)
+{
+	rai::bufferstream stream (payload_a.data (), payload_a.size ());
+	auto error (false);
+	while (!error && !at_end (stream))
+	{
+		rai::pending_key key (0, 0);
+		rai::pending_info info;
+		error = key.deserialize (stream) || info.deserialize (stream);
+		if (!error)
+		{
+			++pending;
+			if (transaction_a != nullptr)
+			{
+				ledger.store.pending_put (transaction_a, key, info);
+			}
+		}
+	}
+	return error;
+}
+
+bool rai::snapshot::process_blocks_info (MDB_txn * transaction_a, std::vector<uint8_t> const & payload_a)
+{
+	rai::bufferstream stream (payload_a.data (), payload_a.size ());
+	auto error (false);
+	while (!error && !at_end (stream))
+	{
+		rai::block_hash hash;
+		rai::block_info info;
+		error = rai::read (stream, hash.bytes) || info.deserialize (stream);
+		if (!error && transaction_a != nullptr)
+		{
+			ledger.store.block_info_put (transaction_a, hash, info);
+		}
+	}
+	return error;
+}
+
+bool rai::snapshot::process_end (MDB_txn * transaction_a, std::vector<uint8_t> const & payload_a)
+{
+	rai::bufferstream stream (payload_a.data (), payload_a.size ());
+	uint64_t accounts_l;
+	uint64_t blocks_l;
+	uint64_t pending_l;
+	rai::checksum checksum_l;
+	auto error (chain_remaining != 0 || rai::read (stream, accounts_l) || rai::read (stream, blocks_l) || rai::read (stream, pending_l) || rai::read (stream, checksum_l.bytes));
+	error = error || boost::endian::big_to_native (accounts_l) != accounts || boost::endian::big_to_native (blocks_l) != blocks || boost::endian::big_to_native (pending_l) != pending || checksum_l != checksum;
+	if (!error && transaction_a != nullptr)
+	{
+		ledger.store.checksum_put (transaction_a, 0, 0, checksum);
+		for (auto & i : weights)
+		{
+			ledger.store.representation_put (transaction_a, i.first, i.second);
+		}
+	}
+	return error;
+}
+
+/**
+ * Nothing but the blocks is taken on trust: balances, blocks_info, frontiers and weights are replayed from the chains, every pending
+ * entry has to match an unreceived send and the weights together with what's pending have to add up to the genesis supply
+ */
+bool rai::snapshot::check (MDB_txn * transaction_a)
+{
+	auto & store (ledger.store);
+	rai::ledger_validator validator (ledger);
+	auto error (validator.validate (transaction_a));
+	// Wide enough that no number of forged entries can wrap around to the supply
+	rai::uint256_t supply (0);
+	for (auto i (store.pending_begin (transaction_a)), n (store.pending_end ()); i != n && !error; ++i)
+	{
+		rai::pending_key key (i->first);
+		rai::pending_info info (i->second);
+		auto block (store.block_get (transaction_a, key.hash));
+		error = block == nullptr;
+		if (!error)
+		{
+			auto send (block->type () == rai::block_type::send || (block->type () == rai::block_type::state && ledger.is_send (transaction_a, static_cast<rai::state_block const &> (*block))));
+			error = !send || ledger.block_destination (transaction_a, *block) != key.account || ledger.account (transaction_a, key.hash) != info.source || ledger.amount (transaction_a, key.hash) != info.amount.number ();
+			supply += info.amount.number ();
+		}
+	}
+	for (auto i (store.block_info_begin (transaction_a)), n (store.block_info_end ()); i != n && !error; ++i)
+	{
+		error = !store.block_exists (transaction_a, i->first.uint256 ());
+	}
+	for (auto i (store.representation_begin (transaction_a)), n (store.representation_end ()); i != n && !error; ++i)
+	{
+		rai::uint128_union weight;
+		rai::bufferstream stream (reinterpret_cast<uint8_t const *> (i->second.data ()), i->second.size ());
+		error = rai::read (stream, weight);
+		supply += weight.number ();
+	}
+	// A pending entry that was already received counts its amount twice, one that's missing leaves it out
+	error = error || supply != rai::genesis_amount;
+	return error;
+}
+
+/**
+ * Check work and signatures of a chunk's blocks, split evenly across the worker threads
+ */
+bool rai::snapshot::verify (std::vector<std::pair<rai::account, std::shared_ptr<rai::block>>> const & blocks_a)
+{
+	std::atomic<bool> error (false);
+	std::vector<std::thread> workers;
+	auto slice ((blocks_a.size () + threads - 1) / threads);
+	for (size_t begin (0); begin < blocks_a.size (); begin += slice)
+	{
+		auto end (std::min (blocks_a.size (), begin + slice));
+		workers.push_back (std::thread ([&blocks_a, &error, begin, end]() {
+			for (auto i (begin); i < end && !error; ++i)
+			{
+				auto & block (*blocks_a[i].second);
+				if (rai::work_validate (block) || rai::validate_message (blocks_a[i].first, block.hash (), block.block_signature ()))
+				{
+					error = true;
+				}
+			}
+		}));
+	}
+	for (auto & i : workers)
+	{
+		i.join ();
+	}
+	return error;
+}
+
+bool rai::snapshot::write_chunk (std::ostream & stream_a, rai::snapshot_chunk type_a, std::vector<uint8_t> const & payload_a)
+{
+	auto max (chunk_max);
+	auto error (payload_a.size () > max);
+	if (!error)
+	{
+		std::vector<uint8_t> header;
+		{
+			rai::vectorstream stream (header);
+			rai::write (stream, type_a);
+			rai::write (stream, boost::endian::native_to_big (static_cast<uint32_t> (payload_a.size ())));
+		}
+		auto hash (payload_hash (payload_a));
+		stream_a.write (reinterpret_cast<char const *> (header.data ()), header.size ());
+		stream_a.write (reinterpret_cast<char const *> (payload_a.data ()), payload_a.size ());
+		stream_a.write (reinterpret_cast<char const *> (hash.bytes.data ()), hash.bytes.size ());
+	}
+	return error;
+}
+
+bool rai::snapshot::read_chunk (std::istream & stream_a, rai::snapshot_chunk & type_a, std::vector<uint8_t> & payload_a)
+{
+	std::array<uint8_t, sizeof (rai::snapshot_chunk) + sizeof (uint32_t)> header;
+	stream_a.read (reinterpret_cast<char *> (header.data ()), header.size ());
+	auto error (static_cast<size_t> (stream_a.gcount ()) != header.size ());
+	if (!error)
+	{
+		rai::bufferstream stream (header.data (), header.size ());
+		uint32_t size;
+		error = rai::read (stream, type_a) || rai::read (stream, size);
+		auto max (chunk_max);
+		error = error || boost::endian::big_to_native (size) > max;
+		if (!error)
+		{
+			payload_a.resize (boost::endian::big_to_native (size));
+			rai::uint256_union hash;
+			stream_a.read (reinterpret_cast<char *> (payload_a.data ()), payload_a.size ());
+			error = static_cast<size_t> (stream_a.gcount ()) != payload_a.size ();
+			stream_a.read (reinterpret_cast<char *> (hash.bytes.data ()), hash.bytes.size ());
+			error = error || static_cast<size_t> (stream_a.gcount ()) != hash.bytes.size () || hash != payload_hash (payload_a);
+		}
+	}
+	return error;
+}
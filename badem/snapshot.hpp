@@ -0,0 +1,66 @@
+#pragma once
+
+#include <badem/common.hpp>
+
+#include <iosfwd>
+
+namespace rai
+{
+class ledger;
+enum class snapshot_chunk : uint8_t
+{
+	end = 0,
+	accounts = 1,
+	pending = 2,
+	blocks_info = 3
+};
+/**
+ * Portable, versioned ledger snapshot.
+ * A header naming the format version, network and genesis is followed by chunks, each a type, a big endian payload length,
+ * the payload and the blake2b hash of the payload. Account chunks hold every account's info followed by its chain from head
+ * down to the open block, a chain too long for one chunk carries on in the next. Pending and blocks_info chunks hold table
+ * entries and the end chunk holds totals and the ledger checksum.
+ */
+class snapshot
+{
+public:
+	snapshot (rai::ledger &, unsigned = 0);
+	bool write (MDB_txn *, std::ostream &);
+	bool read (MDB_txn *, std::istream &);
+	static uint32_t const version = 2;
+	// Chunks are cut as soon as their payload reaches chunk_size so they're at most one entry longer
+	static size_t const chunk_size_default = 1024 * 1024;
+	// Longest payload read_chunk accepts, it bounds what a damaged or hostile file can make the reader allocate
+	static size_t const chunk_max = 2 * chunk_size_default;
+	rai::ledger & ledger;
+	unsigned threads;
+	size_t chunk_size;
+	uint64_t accounts;
+	uint64_t blocks;
+	uint64_t pending;
+
+private:
+	bool process (MDB_txn *, std::istream &);
+	bool process_accounts (MDB_txn *, std::vector<uint8_t> const &);
+	bool process_account (MDB_txn *, rai::stream &);
+	bool process_chain (MDB_txn *, std::shared_ptr<rai::block>);
+	bool process_pending (MDB_txn *, std::vector<uint8_t> const &);
+	bool process_blocks_info (MDB_txn *, std::vector<uint8_t> const &);
+	bool process_end (MDB_txn *, std::vector<uint8_t> const &);
+	bool check (MDB_txn *);
+	bool verify (std::vector<std::pair<rai::account, std::shared_ptr<rai::block>>> const &);
+	// Fails without writing anything if the payload is longer than chunk_max
+	bool write_chunk (std::ostream &, rai::snapshot_chunk, std::vector<uint8_t> const &);
+	bool read_chunk (std::istream &, rai::snapshot_chunk &, std::vector<uint8_t> &);
+	rai::checksum checksum;
+	std::unordered_map<rai::account, rai::uint128_t> weights;
+	// Account whose chain is being read, it may continue in the next accounts chunk
+	rai::account chain_account;
+	rai::account_info chain_info;
+	uint64_t chain_remaining;
+	rai::block_hash chain_expected;
+	rai::block_hash chain_successor;
+	rai::account chain_representative;
+	bool chain_representative_found;
+};
+}